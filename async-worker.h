@@ -231,6 +231,7 @@ class AsyncWorker {
 };
 
 AsyncWorker* create_worker(napi_env, napi_value, napi_value, napi_value, napi_value);
+void before_exit_now(); // releases process wide resources that std::_Exit would leave behind
 
 class AsyncWorkerWrapper {
   AsyncWorker* m_worker;
@@ -324,6 +325,7 @@ class AsyncWorkerWrapper {
     int32_t code = 0;
     check(env, napi_get_cb_info(env, info, &argc, args, nullptr, nullptr));
     if (argc > 0) check(env, napi_get_value_int32(env, args[0], &code));
+    before_exit_now();
     std::fflush(nullptr);
     std::_Exit(code);
   }
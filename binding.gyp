@@ -6,6 +6,7 @@
         "mominer-core.cpp",
         "mominer-xmrig-compat.cpp",
         "mominer-job.cpp",
+        "mominer-rx-shared.cpp",
 
         "xmrig/crypto/common/VirtualMemory.cpp",
         "xmrig/crypto/common/HugePagesInfo.cpp",
@@ -93,6 +94,7 @@
             "xmrig/crypto/randomx/jit_compiler_x86.cpp",
             "xmrig/crypto/randomx/jit_compiler_x86_static.asm",
             "xmrig/crypto/cn/r/CryptonightR_gen.cpp",
+            "xmrig/crypto/cn/CryptoNight_x86_vaes.cpp",
             "xmrig/crypto/cn/asm/win64/cn_main_loop.asm",
             "xmrig/crypto/cn/asm/win64/CryptonightR_template.asm",
             "xmrig/3rdparty/argon2/arch/generic/lib/argon2-arch.c"
@@ -100,7 +102,8 @@
           "defines": [
             "NOMINMAX",
             "WIN32_LEAN_AND_MEAN",
-            "XMRIG_FEATURE_ASM"
+            "XMRIG_FEATURE_ASM",
+            "XMRIG_VAES"
           ],
           "configurations": {
             "Release": {
@@ -144,6 +147,7 @@
           "sources": [
             "xmrig/crypto/common/VirtualMemory_unix.cpp",
             "xmrig/crypto/cn/r/CryptonightR_gen.cpp",
+            "<!@(./cpu-feature.sh vaes && echo \"xmrig/crypto/cn/CryptoNight_x86_vaes.cpp\" || echo)",
             "<!@(./cpu-feature.sh x86_64 && ("
             "     echo \"xmrig/backend/cpu/platform/BasicCpuInfo.cpp\""
             "     echo \"xmrig/hw/msr/Msr.cpp\""
@@ -177,7 +181,7 @@
             "<!@(./cpu-feature.sh ssse3   && echo \"-DHAVE_SSSE3\" || echo)",
             "<!@(./cpu-feature.sh sse2    && echo \"-DHAVE_SSE2\" || echo)",
             "<!@(./cpu-feature.sh msr     && echo \"-DXMRIG_FEATURE_MSR\" || echo)",
-            "<!@(./cpu-feature.sh vaes    && echo \"-DHAVE_VAES\" || echo)",
+            "<!@(./cpu-feature.sh vaes    && echo \"-DHAVE_VAES -DXMRIG_VAES\" || echo)",
             "-DXMRIG_FEATURE_ASM -O3 -ffast-math -flto -funroll-loops -fmerge-all-constants"
           ],
           "cflags_cc+": [ "-std=c++20" ],
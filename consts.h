@@ -2,5 +2,6 @@
 
 #pragma once
 
-const constexpr unsigned HASH_LEN = 32;
+const constexpr unsigned HASH_LEN     = 32;
+const constexpr unsigned MAX_BLOB_LEN = 512;
 
@@ -17,6 +17,7 @@ const use_subprocess_workers = is_windows_process ||
 const thread_id = is_worker_process ? parseInt(process.env["thread_id"]) : "master";
 let worker_ids = []; // active worker ids (cluster.workers can contain not yet closed workers)
 let worker_procs = {};
+let worker_cores = {}; // compute cores of in-process threads
 let core_module_for_exit = null;
 const worker_message_prefix = "MOMINER_WORKER_MESSAGE ";
 
@@ -164,6 +165,7 @@ module.exports.cluster_process = function() {
   compute_core.from.on("result",      function(v) { send_msg("result", v); });
   compute_core.from.on("hashrate",    function(v) { send_msg("hashrate", v); });
   compute_core.from.on("algo_params", function(v) { send_msg("algo_params", v); });
+  compute_core.from.on("stats",       function(v) { send_msg("stats", v); });
   compute_core.from.on("error",       function(v) { send_msg("error", v); });
   compute_core.from.on("close",       function()  {
     process.exitCode = 0;
@@ -184,18 +186,7 @@ module.exports.cluster_process = function() {
   else process.on("SIGHUP", close_worker_process);
 
   function handle_msg(msg) {
-    switch (msg.type) {
-      case "job": case "bench": case "test":
-        // find dev for this specific thread from msg.job.dev list
-        msg.job.dev = module.exports.get_thread_dev(thread_id, msg.job.dev);
-        msg.job.thread_id = thread_id;
-        compute_core.emit_to(msg.type, msg.job);
-        break;
-      case "pause": case "close":
-        compute_core.emit_to(msg.type);
-        break;
-      default: module.exports.log_err("Unknown thread message");
-    }
+    module.exports.handle_thread_msg(compute_core, thread_id, msg);
   }
 
   // process messages from the master thread
@@ -217,13 +208,32 @@ module.exports.cluster_process = function() {
   return true;
 };
 
-// get thread dev stripping ^thread specification from it
+// passes master thread message to thread_id compute core
+module.exports.handle_thread_msg = function(compute_core, thread_id, msg) {
+  switch (msg.type) {
+    case "job": case "bench": case "test":
+      // find dev and affinity for this specific thread from msg.job.dev list and affinity plan
+      compute_core.emit_to(msg.type, {
+        ...msg.job,
+        dev: module.exports.get_thread_dev(thread_id, msg.job.dev),
+        affinity: msg.job.affinity_plan ? msg.job.affinity_plan.split(",")[thread_id] : "",
+        thread_id: thread_id
+      });
+      break;
+    case "pause": case "close":
+      compute_core.emit_to(msg.type);
+      break;
+    default: module.exports.log_err("Unknown thread message");
+  }
+};
+
+// get thread dev stripping ^thread and @cpu list specification from it
 module.exports.get_thread_dev = function(thread_id, devs) {
   const dev_parts = devs.split(",");
   let thread_count = 0;
   for (const dev_part of dev_parts) {
-    const m = dev_part.match(/^([^\^]+)\^(\d+)$/);
-    thread_count += m ? parseInt(m[2]) : 1;
+    const m = dev_part.replace(/@[\d:-]*$/, "").match(/^([^\^]+)(?:\^(\d+))?$/);
+    thread_count += m && m[2] ? parseInt(m[2]) : 1;
     if (thread_id < thread_count) return m ? m[1] : dev_part;
   }
   this.log_err("Can't find " + thread_id + " thread device in " + devs + " specification");
@@ -235,21 +245,143 @@ module.exports.get_dev_threads = function(dev) {
   const dev_parts = dev.split(",");
   let thread_count = 0;
   for (const dev_part of dev_parts) {
-    const m = dev_part.match(/\^(\d+)$/);
+    const m = dev_part.match(/\^(\d+)(@[\d:-]*)?$/);
     thread_count += m ? parseInt(m[1]) : 1;
   }
   return thread_count;
 };
 
+// return array of CPUs from "@<cpu>[-<cpu>][:...]" dev part suffix or null if there is none
+module.exports.get_dev_cpus = function(dev_part) {
+  const m = dev_part.match(/@([\d:-]*)$/);
+  if (!m) return null;
+  let cpus = [];
+  for (const range of m[1].split(":")) {
+    const r = range.match(/^(\d+)(?:-(\d+))?$/);
+    if (!r) {
+      this.log_err("Bad " + range + " CPU range in " + dev_part + " device specification");
+      continue;
+    }
+    for (let cpu = parseInt(r[1]); cpu <= parseInt(r[2] ? r[2] : r[1]); ++ cpu) cpus.push(cpu);
+  }
+  return cpus;
+};
+
+// returns [ [<cpu>, ...], ... ] list of sockets with their CPUs ordered for hashing threads: one
+// CPU of each physical core first (round robin between L3 caches of the socket), then SMT siblings.
+// returns null if CPU topology is not known
+module.exports.detect_cpu_topology = function() {
+  const cpu_dir = "/sys/devices/system/cpu";
+  if (process.platform === "win32" || !fs.existsSync(cpu_dir)) return null;
+  let sockets = {}; // socket id -> L3 cache id -> core id -> [cpu, ...]
+  for (const name of fs.readdirSync(cpu_dir).filter((name) => /^cpu\d+$/.test(name))) {
+    const cpu = parseInt(name.substr(3));
+    const read = (file) => fs.readFileSync(`${cpu_dir}/${name}/${file}`, "utf8").trim();
+    try {
+      const socket = read("topology/physical_package_id");
+      const core   = read("topology/core_id");
+      let l3 = "";
+      for (const entry of fs.existsSync(`${cpu_dir}/${name}/cache`) ? fs.readdirSync(`${cpu_dir}/${name}/cache`) : []) {
+        if (/^index\d+$/.test(entry) && read(`cache/${entry}/level`) === "3") l3 = read(`cache/${entry}/shared_cpu_list`);
+      }
+      if (!(socket in sockets)) sockets[socket] = {};
+      if (!(l3 in sockets[socket])) sockets[socket][l3] = {};
+      if (!(core in sockets[socket][l3])) sockets[socket][l3][core] = [];
+      sockets[socket][l3][core].push(cpu);
+    } catch (_) {} // offline CPU
+  }
+  let result = [];
+  for (const socket of Object.keys(sockets).sort((a, b) => a - b)) {
+    const l3s = Object.values(sockets[socket]).map((cores) =>
+      Object.values(cores).map((cpus) => cpus.sort((a, b) => a - b)).sort((a, b) => a[0] - b[0])
+    );
+    let cpus = [];
+    for (let smt = 0; l3s.some((cores) => cores.some((core) => smt < core.length)); ++ smt) {
+      for (let core = 0; l3s.some((cores) => core < cores.length); ++ core) {
+        for (const cores of l3s) if (core < cores.length && smt < cores[core].length) cpus.push(cores[core][smt]);
+      }
+    }
+    result.push(cpus);
+  }
+  return result.length ? result : null;
+};
+
+// returns "<cpu>[:<cpu>...],..." list of CPUs to pin hashing threads of each ^thread from dev to
+// (empty for not pinned ones): rx threads have *batch hashing threads (half of it for interleaved "cpui" dev),
+// other ones have only one.
+// CPUs from dev @cpu list are used as is, otherwise each thread takes the next CPUs from
+// the socket with the most unused CPUs in cpu_topology order
+module.exports.get_affinity_plan = function(dev, is_rx, cpu_topology) {
+  let plan = [];
+  let used = cpu_topology ? cpu_topology.map(() => 0) : [];
+  for (const dev_part of dev.split(",")) {
+    const dev_cpus = this.get_dev_cpus(dev_part);
+    const dev_part2 = dev_part.replace(/@[\d:-]*$/, "");
+    const m = dev_part2.match(/\^(\d+)$/);
+    const thread_count = m ? parseInt(m[1]) : 1;
+    const is_cpu = this.is_cpu_dev(dev_part2);
+    const batch = this.get_dev_batch(dev_part2.replace(/\^\d+$/, ""));
+    const hash_threads = is_rx ? (dev_part2.startsWith("cpui") ? Math.ceil(batch / 2) : batch) : 1;
+    for (let i = 0; i < thread_count; ++ i) {
+      let cpus = [];
+      if (is_cpu && dev_cpus && dev_cpus.length) {
+        for (let j = 0; j < hash_threads; ++ j) cpus.push(dev_cpus[(i * hash_threads + j) % dev_cpus.length]);
+      } else if (is_cpu && cpu_topology && !dev_cpus) {
+        let socket = 0;
+        for (let s = 1; s < cpu_topology.length; ++ s) {
+          if (cpu_topology[s].length - used[s] > cpu_topology[socket].length - used[socket]) socket = s;
+        }
+        const socket_cpus = cpu_topology[socket];
+        for (let j = 0; j < hash_threads; ++ j) cpus.push(socket_cpus[used[socket]++ % socket_cpus.length]);
+      }
+      plan.push(cpus.join(":"));
+    }
+  }
+  return plan.join(",");
+};
+
 // return dev *batch value
 module.exports.get_dev_batch = function(dev) {
   const m = dev.match(/\*(\d+)$/);
   return m ? parseInt(m[1]) : 1;
 };
 
+// returns true if dev only uses in-process CPU compute (no SYCL devices)
+module.exports.is_cpu_dev = function(dev) {
+  return dev.split(",").every((dev_part) => /^cpui?(\*\d+)?(\^\d+)?(@[\d:-]*)?$/.test(dev_part));
+};
+
+// returns true if algo dev threads run as compute core threads of the main process (rx ones
+// always use separate processes since RandomX code keeps process global state)
+module.exports.is_in_process = function(algo, dev) {
+  return !!global.opt.job.in_process_threads && !algo.startsWith("rx/") && this.is_cpu_dev(dev);
+};
+
+// return "<algo>*<max batch>,..." list of CPU algos from algo_params to size compute core
+// scratchpad arena once for all algos it can be switched to (only ones with dev that reuses
+// the same threads as algo dev, other devs recreate threads with their own arenas)
+module.exports.get_arena_plan = function(algo_params, algo, dev) {
+  let plan = [];
+  for (const [algo2, params] of Object.entries(algo_params)) {
+    if (!params.dev || !this.is_same_threads(algo, dev, algo2, params.dev)) continue;
+    let batch = 0;
+    for (const dev_part of params.dev.split(",")) batch = Math.max(batch, this.get_dev_batch(dev_part.replace(/(\^\d+)?(@[\d:-]*)?$/, "")));
+    plan.push(algo2 + "*" + batch);
+  }
+  return plan.join(",");
+};
+
 module.exports.messageWorkers = function(msg) {
   const targets = [];
   for (const worker_id of worker_ids) {
+    const worker_core = worker_cores[worker_id];
+    if (worker_core) {
+      if (msg.type === "close") worker_core.expectedClose = true;
+      worker_core.handle_msg(msg);
+      targets.push({ type: "core", id: worker_id, worker: worker_core });
+      continue;
+    }
+
     const worker = worker_procs[worker_id];
     if (worker && worker.stdin && worker.stdin.writable) {
       if (msg.type === "close") worker.expectedClose = true;
@@ -279,7 +411,7 @@ module.exports.messageWorkers = function(msg) {
 
 function forceCloseWorker(target) {
   const worker = target.worker;
-  if (!worker) return;
+  if (!worker || target.type === "core") return; // in-process threads can only be closed
   if (target.type === "subprocess") {
     if (worker.exitCode !== null || worker.signalCode !== null || worker.killed) return;
     if (is_windows_process && worker.pid) {
@@ -308,15 +440,48 @@ module.exports.closeWorkers = function(forceAfterMs) {
 };
 
 // map 0..N-1 thread IDs into worker.id (that might be not sequential)
-// need to recreate threads from 0 for every algo change since huge memory reallocations
-// can have issues
-module.exports.recreate_threads = function(dev, messageHandler) {
+// CPU only threads can be reused between algos since compute core keeps its scratchpad arena,
+// otherwise threads need to be recreated from 0 for every algo change
+module.exports.is_same_threads = function(prev_algo, prev_dev, algo, dev) {
+  return this.is_cpu_dev(prev_dev) && this.is_cpu_dev(dev) &&
+         this.get_dev_threads(prev_dev) === this.get_dev_threads(dev) &&
+         this.is_in_process(prev_algo, prev_dev) === this.is_in_process(algo, dev);
+};
+
+module.exports.recreate_threads = function(algo, dev, messageHandler) {
   module.exports.closeWorkers(5000);
   //for (const thread of Object.values(thread_id_map)) cluster.workers[thread].kill();
   worker_ids = [];
   worker_procs = {};
+  worker_cores = {};
   const curr_thread_count = this.get_dev_threads(dev);
+  // CPU only threads do not need separate processes since compute core does not share its state
+  const is_in_process = this.is_in_process(algo, dev);
   for (let i = 0; i < curr_thread_count; ++ i) {
+    if (is_in_process) {
+      const compute_core = this.create_core();
+      for (const name of ["test", "last_nonce", "result", "hashrate", "algo_params", "stats", "error"]) {
+        compute_core.from.on(name, function(v) { messageHandler({type: name, value: v, thread_id: i}); });
+      }
+      compute_core.from.on("close", function() {
+        if (worker_cores[i] !== worker_core) return;
+        delete worker_cores[i];
+        worker_ids = worker_ids.filter((worker_id) => worker_id !== i);
+        if (worker_core.expectedClose) return;
+        messageHandler({
+          type: "error",
+          value: { message: "Worker " + i + " closed unexpectedly" },
+          thread_id: i
+        });
+      });
+      const worker_core = {
+        expectedClose: false,
+        handle_msg: function(msg) { module.exports.handle_thread_msg(compute_core, i, msg); }
+      };
+      worker_ids.push(i);
+      worker_cores[i] = worker_core;
+      continue;
+    }
     const env = childEnv({thread_id: i, log_level: global.opt.log_level});
     if (use_subprocess_workers) {
       const thread = childProcess.spawn(process.execPath, process.argv.slice(1), {
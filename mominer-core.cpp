@@ -128,7 +128,7 @@ void Core::send_error(const std::string& str) {
 void Core::send_result(
   const uint64_t nonce, const unsigned noncebytes, const uint8_t* const output,
   const uint32_t* const edges, const unsigned c29_proof_size,
-  const uint8_t* const commitment
+  const uint8_t* const commitment, const RxJob* const rx_job
 ) {
   MessageValues values;
 
@@ -162,9 +162,9 @@ void Core::send_result(
     values["edges"] = edges_hex;
   }
 
-  values["pool_id"]   = m_pool_id;
-  values["worker_id"] = m_worker_id;
-  values["job_id"]    = m_job_id;
+  values["pool_id"]   = rx_job ? rx_job->pool_id   : m_pool_id;
+  values["worker_id"] = rx_job ? rx_job->worker_id : m_worker_id;
+  values["job_id"]    = rx_job ? rx_job->job_id    : m_job_id;
   send_msg("result", values);
 }
 
@@ -183,40 +183,110 @@ void Core::send_last_nonce(const uint64_t nonce, const unsigned noncebytes, cons
 
 static void free_mem(void* const mem) { _mm_free(mem); }
 
+void Core::send_stats(const std::string& name, MessageValues values) {
+  values["name"] = name;
+  send_msg("stats", values);
+}
+
+// reports time from the last algo/batch switch to the first computed hash
+void Core::send_first_hash_stats(const std::string& algo) {
+  if (!m_switch_timestamp.load(std::memory_order_relaxed)) return;
+  const uint64_t switch_timestamp = m_switch_timestamp.exchange(0);
+  if (!switch_timestamp) return;
+  MessageValues values;
+  values["algo"]          = algo;
+  values["first_hash_ms"] = std::to_string(get_timestamp_ms() - switch_timestamp);
+  send_stats("switch", values);
+}
+
+// accounts time from the last rx job set to its first computed hash
+void Core::add_job_switch_stats() {
+  if (!m_job_timestamp.load(std::memory_order_relaxed)) return;
+  const uint64_t job_timestamp = m_job_timestamp.exchange(0);
+  if (!job_timestamp) return;
+  const uint64_t latency = get_timestamp_us() - job_timestamp;
+  SimpleLock lock(m_mutex_hashrate);
+  ++ m_job_switch_count;
+  m_job_switch_sum_us += latency;
+  if (m_job_switch_max_us < latency) m_job_switch_max_us = latency;
+}
+
+// reports rx job switch latency stats accounted since the last call
+void Core::send_job_switch_stats() {
+  m_mutex_hashrate.lock();
+  const uint64_t count = m_job_switch_count, sum_us = m_job_switch_sum_us, max_us = m_job_switch_max_us;
+  m_job_switch_count = m_job_switch_sum_us = m_job_switch_max_us = 0;
+  m_mutex_hashrate.unlock();
+  if (!count) return;
+  char avg_ms[32], max_ms[32];
+  snprintf(avg_ms, sizeof(avg_ms), "%.3f", sum_us / 1000.0 / count);
+  snprintf(max_ms, sizeof(max_ms), "%.3f", max_us / 1000.0);
+  MessageValues values;
+  values["jobs"]   = std::to_string(count);
+  values["avg_ms"] = avg_ms;
+  values["max_ms"] = max_ms;
+  send_stats("job_switch", values);
+}
+
 void Core::free_memory(
   const bool is_batch_changed,
-  const bool is_mem_size_changed,
+  const bool is_layout_changed,
   const bool is_free_cn,
-  const bool is_free_rx
+  const bool is_free_rx,
+  const bool is_free_arena
 ) {
   // m_thread_pool need to be deleted first if anything rx related is deleted
-  if (is_batch_changed || is_free_rx) {
-    // ++ m_job_ref is to stop rx threads if any
-    if (m_thread_pool) { ++ m_job_ref; delete m_thread_pool; m_thread_pool = nullptr; }
+  if (is_batch_changed || is_layout_changed || is_free_rx) {
+    stop_rx_threads();
     if (m_vm) {
       for (unsigned i = 0; i != m_batch; ++ i) randomx_destroy_vm(m_vm[i]);
       delete [] m_vm; m_vm = nullptr;
     }
   }
-  if (is_batch_changed || is_mem_size_changed) {
-    if (m_lpads) { delete m_lpads; m_lpads = nullptr; }
-  }
   if (is_batch_changed) {
     if (m_input)  { free_mem(m_input);  m_input  = nullptr; }
     if (m_output) { free_mem(m_output); m_output = nullptr; }
   }
-  if (is_batch_changed || is_mem_size_changed || is_free_cn) {
-    if (m_ctx) { xmrig::CnCtx::release(m_ctx, m_batch); delete [] m_ctx; m_ctx = nullptr; }
-  }
   if (is_batch_changed || is_free_cn) {
     if (m_spads) { free_mem(m_spads); m_spads = nullptr; }
   }
+  if (is_free_cn) {
+    stop_cn_r_programs();
+    stop_gr_helper();
+  }
   if (is_free_rx) {
-    if (m_rx_dataset)     { randomx_release_dataset(m_rx_dataset); m_rx_dataset = nullptr; }
-    if (m_rx_cache)       { randomx_release_cache(m_rx_cache); m_rx_cache = nullptr; }
-    if (m_rx_dataset_mem) { delete m_rx_dataset_mem; m_rx_dataset_mem = nullptr; }
-    if (m_rx_cache_mem)   { delete m_rx_cache_mem; m_rx_cache_mem = nullptr; }
+    stop_rx_build();
+    stop_rx_precompute();
+    for (RxDataset* const rx : m_rx_datasets) delete rx;
+    m_rx_datasets.clear();
+    m_rx = nullptr;
   }
+  // cn contexts only point into the arena so they live as long as it does
+  if (is_free_arena) {
+    if (m_ctx)   { xmrig::CnCtx::release(m_ctx, m_ctx_count); delete [] m_ctx; m_ctx = nullptr; }
+    if (m_lpads) { delete m_lpads; m_lpads = nullptr; }
+    m_ctx_count = 0;
+  }
+}
+
+void Core::stop_rx_threads() {
+  if (m_thread_pool) {
+    m_is_rx_stop = true;
+    m_rx_job_seq.fetch_add(1, std::memory_order_release); // to wake up idle rx threads
+    m_rx_job_seq.notify_all();
+    delete m_thread_pool; m_thread_pool = nullptr;
+    m_is_rx_stop = false;
+  }
+  m_rx_thread_count = 0;
+  free_rx_light_vms();
+  m_is_rx_light = false;
+}
+
+// should be called only when no rx thread uses light mode vms
+void Core::free_rx_light_vms() {
+  if (m_rx_light_vm == nullptr) return;
+  for (unsigned i = 0; i != m_rx_light_count; ++ i) randomx_destroy_vm(m_rx_light_vm[i]);
+  delete [] m_rx_light_vm; m_rx_light_vm = nullptr;
 }
 
 void Core::set_fn(cn_any_hash_fun fn) {
@@ -264,20 +334,19 @@ bool Core::process_message(const std::string& type, const MessageValues& v) {
 
   } else if (type == "bench") {
     debug_startup("process bench start");
-    set_job(true, false, v);
+    set_job(true, false, v, [&]() { m_target = 0; });
     debug_startup("process bench done");
-    m_target = 0;
 
   } else if (type == "test") {
     debug_startup("process test start");
-    set_job(false, false, v);
+    set_job(false, false, v, [&]() { m_target = 0; });
     debug_startup("process test done");
     m_nonce32 = 0;
     m_nonce64 = 0;
-    m_target  = 0;
 
   } else if (type == "pause") {
-    ++ m_job_ref; // to stop rx threads if any
+    ++ m_job_ref;
+    publish_rx_job(nullptr); // rx threads (if any) become idle
     set_fn(nullptr);
 
   } else if (type == "read_msr" || type == "write_msr") {
@@ -354,10 +423,14 @@ bool Core::process_message(const std::string& type, const MessageValues& v) {
     const uint64_t last_nonce = m_nonce_bytes == 4 ? m_nonce32 : m_nonce64;
     if (last_nonce) send_last_nonce(last_nonce, m_nonce_bytes, m_pool_id);
     free_memory();
+    reap_gr_tunes(true);
     return false; // stop processing messages
 
   } else if (type == "algo_params") {
     get_algo_params(v);
+
+  } else if (type == "kernel_bench") {
+    bench_kernel(v);
   }
 
   return true; // continue processing messages
@@ -366,7 +439,8 @@ bool Core::process_message(const std::string& type, const MessageValues& v) {
 void Core::Execute() {
   debug_startup("Core::Execute entered");
   bool runtime_initialized = false;
-  auto init_runtime = [&]() {
+  // v are job keys of the first message that needs runtime
+  auto init_runtime = [&](const MessageValues& v) {
     if (runtime_initialized) return;
     runtime_initialized = true;
     debug_startup("runtime init start");
@@ -401,6 +475,8 @@ void Core::Execute() {
     if (ci.hasAVX2())                        rx_blake2b          = blake2b_avx2;
 #endif
 
+    select_kernel_modes(v);
+
     randomx_set_scratchpad_prefetch_mode(0);
 #if defined(_WIN32)
     randomx_set_huge_pages_jit(false);
@@ -415,41 +491,60 @@ void Core::Execute() {
   while (true) {
     std::deque<Message> messages;
     fromNode.readAll(messages);
+    // only the last queued job needs to be set up since it replaces all previous ones
+    const Message* last_job = nullptr;
+    for (const auto& message : messages) if (message.name == "job") last_job = &message;
     for (const auto& message : messages) {
+      if (message.name == "job" && &message != last_job) continue;
       try {
         debug_startup(("message " + message.name).c_str());
-        if (message.name == "job" || message.name == "bench" || message.name == "test")
-          init_runtime();
+        if (message.name == "job" || message.name == "bench" || message.name == "test" ||
+            message.name == "kernel_bench")
+          init_runtime(message.values);
         if (!process_message(message.name, message.values)) return;
       } catch(const std::string& err) {
         send_error(std::string("Message processing exception: ") + err);
       }
     }
 
+    if (m_rx_build) try {
+      if (m_rx_build->is_done()) finish_rx_build();
+      else if (m_rx_light_threads && m_rx_job.load() && m_rx_light_vm == nullptr && m_rx_build->is_cache_ready)
+        start_rx_light();
+    } catch(const std::string& err) {
+      send_error(std::string("RandomX dataset build exception: ") + err);
+    }
+    // light mode vms are not used anymore once all light mode threads switched to full mode vms
+    if (m_rx_light_vm && !m_is_rx_light && m_rx_light_released.load(std::memory_order_acquire) >= m_rx_light_count)
+      free_rx_light_vms();
+
     // we skip first hash function run using m_hash_count check to exclude GPU compile time
     // that effectively skips it in test mode too
-    static unsigned hashrate_check_counter = HASHRATE_COUNTER_INTERVAL;
     if (m_dev == DEV::RX_CPU) m_mutex_hashrate.lock();
     const unsigned hash_count = m_hash_count;
     if (m_dev == DEV::RX_CPU) m_mutex_hashrate.unlock();
-    if (hash_count && --hashrate_check_counter == 0) {
-      hashrate_check_counter = HASHRATE_COUNTER_INTERVAL;
-      const uint64_t new_timestamp = std::chrono::time_point_cast<std::chrono::milliseconds>(
-        std::chrono::high_resolution_clock::now()
-      ).time_since_epoch().count();
+    if (hash_count && --m_hashrate_check_counter == 0) {
+      m_hashrate_check_counter = HASHRATE_COUNTER_INTERVAL;
+      // rx threads touched their scratchpads by now
+      if (m_is_numa_report && m_rx) { m_is_numa_report = false; send_numa_stats(); }
+      const uint64_t new_timestamp = get_timestamp_ms();
       if (!m_timestamp || new_timestamp - m_timestamp > 60*1000) {
         if (m_timestamp) send_msg("hashrate", "hashrate", std::to_string(
           static_cast<float>(hash_count) / (new_timestamp - m_timestamp) * 1000.0f
         ));
         m_timestamp = new_timestamp;
+        if (m_dev == DEV::RX_CPU) send_job_switch_stats();
         if (m_dev == DEV::RX_CPU) m_mutex_hashrate.lock();
         m_hash_count = 0;
         if (m_dev == DEV::RX_CPU) m_mutex_hashrate.unlock();
       }
     }
 
-    if (m_fn.any) {
-      init_runtime();
+    // ghostrider hashing waits for tune of its cpu (it is not run in parallel with tune passes on the same cpu)
+    if (m_gr_tune_build && m_gr_tune_build->is_done) finish_gr_tune();
+    if (!m_gr_tunes_stopped.empty()) reap_gr_tunes(false);
+
+    if (m_fn.any && !m_gr_tune_build) {
       int c29_sols;
       uint64_t c29_nonce;
       try {
@@ -479,6 +574,7 @@ void Core::Execute() {
         set_fn(nullptr);
         continue;
       }
+      send_first_hash_stats(m_algo_str);
 
       if (!m_nonce32 && !m_nonce64) { // test job
 	m_input_len = 0; // do not produce any more test jobs for async GPU code like in c29
@@ -571,4 +667,8 @@ AsyncWorker* create_worker(
   return new Core(env, data, complete, error_callback, options);
 }
 
+void before_exit_now() {
+  RxSharedDataset::release_all();
+}
+
 NAPI_MODULE(NODE_GYP_MODULE_NAME, AsyncWorkerWrapper::Init)
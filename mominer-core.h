@@ -2,10 +2,13 @@
 
 #pragma once
 
+#include <list>
+#include <memory>
 #include "async-worker.h"
 #include "ctpl-stl.h" // used for randomx threads
 #include "crypto/common/VirtualMemory.h"
 #include "crypto/cn/CnHash.h"
+#include "crypto/ghostrider/ghostrider.h"
 #include "crypto/randomx/randomx.h"
 #include "consts.h"
 
@@ -33,25 +36,213 @@ union FN {
 };
 enum DEV { CPU, RX_CPU, GPU, C29_GPU };
 
+static inline uint64_t get_timestamp_ms() {
+  return std::chrono::time_point_cast<std::chrono::milliseconds>(
+    std::chrono::high_resolution_clock::now()
+  ).time_since_epoch().count();
+}
+
+static inline uint64_t get_timestamp_us() {
+  return std::chrono::time_point_cast<std::chrono::microseconds>(
+    std::chrono::high_resolution_clock::now()
+  ).time_since_epoch().count();
+}
+
+// rx dataset memory in named hugetlbfs or /dev/shm segment shared by processes of this host
+// (process that publishes the segment builds the dataset, others map it read only and wait
+// until it is marked ready or take the build over if that process exits or aborts it)
+struct RxSharedDataset {
+  std::string path;
+  int fd;                      // keeps shared lock while the segment is used by this process
+  uint8_t* mem;                // header followed by dataset
+  size_t mem_size;
+  bool is_huge_pages;          // segment is in hugetlbfs
+  std::atomic<bool> is_owner;  // this process builds the dataset
+
+  // returns segment for name (published by this or another process) or nullptr if it fails
+  static RxSharedDataset* open(const std::string& name, size_t dataset_size);
+  // releases segments of this process that exits without deleting them
+  static void release_all();
+  RxSharedDataset(const std::string& path, int fd, uint8_t* mem, size_t mem_size, bool is_huge_pages, bool is_owner)
+    : path(path), fd(fd), mem(mem), mem_size(mem_size), is_huge_pages(is_huge_pages), is_owner(is_owner) {}
+  ~RxSharedDataset();
+  uint8_t* dataset() const;
+  bool is_ready() const;
+  void set_ready();
+  bool take_over();
+};
+
+// rx cache and dataset initialized for specific algo and seed
+struct RxDataset {
+  std::string key; // "<algo>/<seed_hex>" or empty if not initialized yet
+  xmrig::VirtualMemory *cache_mem, *dataset_mem;
+  RxSharedDataset* shared; // used instead of dataset_mem if dataset is shared between processes
+  randomx_cache*   cache;
+  randomx_dataset* dataset;
+  std::string cache_init;  // rx_dataset_init option cache was created with
+
+  RxDataset() : cache_mem(nullptr), dataset_mem(nullptr), shared(nullptr), cache(nullptr), dataset(nullptr) {}
+  ~RxDataset() {
+    if (dataset)     randomx_release_dataset(dataset);
+    if (cache)       randomx_release_cache(cache);
+    if (shared)      delete shared;
+    if (dataset_mem) delete dataset_mem;
+    if (cache_mem)   delete cache_mem;
+  }
+  size_t size() const {
+    return (cache_mem ? cache_mem->size() : 0) + (dataset_mem ? dataset_mem->size() : 0) +
+           (shared ? shared->mem_size : 0);
+  }
+  // frees shared dataset segment (and dataset object that points to it)
+  void drop_shared() {
+    if (shared == nullptr) return;
+    if (dataset) randomx_release_dataset(dataset);
+    dataset = nullptr;
+    delete shared;
+    shared = nullptr;
+  }
+  // light mode rx dataset only has cache (dataset_raw() is nullptr then)
+  uint8_t* dataset_raw() const {
+    return shared ? shared->dataset() : dataset_mem ? dataset_mem->raw() : nullptr;
+  }
+  bool is_huge_pages() const {
+    return shared ? shared->is_huge_pages : dataset_mem ? dataset_mem->isHugePages() : cache_mem->isHugePages();
+  }
+};
+
+// asynchronous rx dataset build split in item chunks so several threads can work on it
+// (including ones added later) and it can be aborted between chunks
+struct RxDatasetBuild {
+  RxDataset* rx;
+  std::string algo, key;
+  uint8_t seed[HASH_LEN];
+  std::atomic<unsigned> next_item, done_items;
+  std::atomic<bool> is_cache_started, is_cache_ready, is_abort;
+  std::list<std::thread> threads;
+  uint64_t timestamp;       // build start time
+  uint64_t light_timestamp; // time when job started light mode hashing or 0
+  uint64_t wait_timestamp;  // time when job started to wait for this build
+  unsigned wait_items;      // items that were done when job started to wait for this build
+  std::vector<int> cpus;    // numa node cpus to run build threads on (empty if they are not pinned)
+  uint64_t items_timestamp; // time when cache was ready and dataset items build started
+  bool is_digest;           // blake2b digest of the built dataset is reported in rx_build stats
+
+  RxDatasetBuild(
+    RxDataset* rx, const std::string& algo, const std::string& key, const uint8_t* seed,
+    const std::vector<int>& cpus, const bool is_digest
+  ) : rx(rx), algo(algo), key(key), next_item(0), done_items(0),
+      is_cache_started(false), is_cache_ready(false), is_abort(false),
+      timestamp(get_timestamp_ms()), light_timestamp(0), wait_timestamp(timestamp), wait_items(0),
+      cpus(cpus), items_timestamp(0), is_digest(is_digest)
+  {
+    memcpy(this->seed, seed, HASH_LEN);
+  }
+  bool is_done() const { return done_items == randomx_dataset_item_count(); }
+};
+
+// immutable rx job description published to persistent rx threads
+struct RxJob {
+  uint8_t  input[MAX_BLOB_LEN];
+  unsigned input_len, nonce_offset, nonce_step;
+  uint32_t nonce;         // first nonce of batch_id 0 rx thread
+  uint32_t nicehash_mask;
+  uint64_t target;        // 0 for bench and test jobs
+  bool     is_set_nonce;  // false for test jobs that only need the first hash of input
+  bool     is_rx_v2;
+  std::string algo, pool_id, worker_id, job_id;
+};
+
+// cn/r program of specific height compiled by background thread into executable memory
+// that cn contexts of this process share read only (see Core::set_cn_r_program)
+struct CnRProgram {
+  uint64_t height;
+  xmrig::CnHash::AlgoVariant av;
+  uint8_t* code;             // CN_R_CODE_SIZE bytes laid out like generated_code block of cn contexts
+  std::atomic<bool> is_done; // compile thread is finished
+  bool is_used;              // code is used by cn/r hash fn of av (false if it only interprets program)
+  uint64_t compile_us;
+  std::thread thread;
+
+  CnRProgram(uint64_t height, xmrig::CnHash::AlgoVariant av);
+  ~CnRProgram();
+  void wait() { if (thread.joinable()) thread.join(); }
+};
+
+// ghostrider cn step tune of the hashing cpu run by background thread so set_job does not wait for it
+// (hashing thread adopts its cached result before the first ghostrider hash, see Core::finish_gr_tune,
+// tune stopped by a job switch keeps running until it is done, see Core::reap_gr_tunes)
+struct GrTune {
+  int64_t cpu, helper_cpu;
+  std::vector<int64_t> plan_cpus; // hashing cpus of affinity plan that helper thread must not use
+  std::atomic<bool> is_done;      // tune thread is finished
+  uint64_t tune_us;
+  std::thread thread;
+
+  GrTune(int64_t cpu, int64_t helper_cpu, const std::vector<int64_t>& plan_cpus);
+  ~GrTune() { if (thread.joinable()) thread.join(); }
+};
+
 class Core: public AsyncWorker {
   const unsigned HASHRATE_COUNTER_INTERVAL = 10; // iterations to skip to update/check hashrate
   FN m_fn;
   DEV m_dev;
-  xmrig::VirtualMemory *m_lpads, *m_rx_cache_mem, *m_rx_dataset_mem;
+  // m_lpads is the scratchpad arena: it is only grown and is kept between jobs
+  // so algo switches carve cn contexts and rx vm scratchpads out of it
+  xmrig::VirtualMemory *m_lpads;
   void* m_spads;
   struct cryptonight_ctx** m_ctx;
   uint8_t *m_input, *m_output;
   unsigned m_job_ref, m_height, m_batch, m_mem_size, m_input_len, m_nonce_step,
-	   m_nonce_bytes, m_nonce_offset, m_c29_proof_size;
+	   m_nonce_bytes, m_nonce_offset, m_c29_proof_size, m_ctx_count;
   uint32_t m_nonce32; // next nonce that will be used in an input
   uint64_t m_nonce64, m_nicehash_mask, m_target, m_timestamp, m_hash_count;
+  unsigned m_hashrate_check_counter;
   std::string m_algo_str, m_dev_str, m_seed_hex, m_input_hex, m_pool_id, m_worker_id, m_job_id;
   bool m_is_rx_jit;
-  randomx_cache*   m_rx_cache;
-  randomx_dataset* m_rx_dataset;
+  std::vector<int> m_affinity; // cpus to pin hashing threads to (empty if they are not pinned)
+  uint32_t m_numa_node;        // numa node of m_affinity cpus that rx memory is allocated on
+  std::vector<int> m_numa_cpus; // all cpus of m_numa_node (empty if threads are not pinned)
+  bool m_is_numa_report;        // numa stats should be sent once rx threads hash new dataset
+  // lru list of rx datasets (most recently used first) limited by m_rx_dataset_budget bytes
+  std::list<RxDataset*> m_rx_datasets;
+  RxDataset* m_rx; // dataset used by current m_vm
+  size_t m_rx_dataset_budget;
+  bool m_is_rx_1gb_pages; // new rx datasets are allocated on 1GB huge pages if they are available
+  bool m_is_rx_shared;    // new rx datasets are shared with other processes (see RxSharedDataset)
+  std::string m_rx_mode;  // "full", "light" or "auto" mode of new rx datasets
+  std::string m_rx_dataset_init; // "auto", "avx2" or "scalar" dataset init code of new rx caches
+  bool m_is_rx_dataset_digest;   // rx_build stats report blake2b digest of built rx datasets
+  size_t m_memory_cap;    // memory (in bytes) this process can use (0 if it is not capped)
+  bool m_is_rx_vm_light;  // m_vm are light mode vms for rx dataset without dataset memory
+  uint64_t m_rx_dataset_hits, m_rx_dataset_misses;
+  RxDatasetBuild* m_rx_build; // build of the dataset current rx job waits for
+  RxDatasetBuild* m_rx_next;  // background build of the next seed rx dataset
+  // current rx job (nullptr if paused) picked up by rx threads once m_rx_job_seq is changed
+  std::atomic<std::shared_ptr<const RxJob>> m_rx_job;
+  std::atomic<unsigned> m_rx_job_seq;
+  std::atomic<bool> m_is_rx_stop;
+  unsigned m_rx_thread_count; // rx threads for [0, m_rx_thread_count) batch range are started
+  unsigned m_rx_thread_vms;   // vms driven by each rx thread (2 for interleaved "cpui" dev)
+  // light mode vms used by first m_rx_light_count rx threads until m_rx_build is done
+  randomx_vm** m_rx_light_vm;
+  unsigned m_rx_light_threads, m_rx_light_count;
+  std::atomic<unsigned> m_rx_light_released; // light mode vms of rx threads that switched to full mode ones
+  std::atomic<bool> m_is_rx_light;
   ctpl::thread_pool* m_thread_pool;
   randomx_vm** m_vm;
   SimpleMutex m_mutex_hashrate;
+  std::atomic<uint64_t> m_switch_timestamp; // algo/batch switch time until its first hash
+  std::atomic<uint64_t> m_job_timestamp;    // rx job set time (in us) until its first hash
+  // rx job switch latency stats since the last hashrate report (guarded by m_mutex_hashrate)
+  uint64_t m_job_switch_count, m_job_switch_sum_us, m_job_switch_max_us;
+  // cn/r program used by m_ctx and one compiled in background for the next height
+  CnRProgram *m_cn_r, *m_cn_r_next;
+  uint64_t m_cn_r_waits; // cn/r jobs that waited for their program compile
+  // ghostrider helper thread that hashes half of ways on free SMT sibling of the hashing cpu
+  xmrig::ghostrider::HelperThread* m_gr_helper;
+  std::string m_gr_tune; // "<cpu>/<helper cpu>" of the current ghostrider tune reported in gr_tune stats
+  GrTune* m_gr_tune_build; // ghostrider tune hashing waits for until finish_gr_tune
+  std::list<GrTune*> m_gr_tunes_stopped; // tunes of previous jobs that are deleted by reap_gr_tunes once done
 
   inline uint32_t* get_nonce32(uint8_t* const input, const unsigned batch) {
     return reinterpret_cast<uint32_t*>(input + (batch * m_input_len) + m_nonce_offset);
@@ -84,21 +275,56 @@ class Core: public AsyncWorker {
   void send_result(
     uint64_t nonce, unsigned noncebytes, const uint8_t* output,
     const uint32_t* edges = nullptr, unsigned c29_proof_size = 32,
-    const uint8_t* commitment = nullptr
+    const uint8_t* commitment = nullptr, const RxJob* rx_job = nullptr
   );
   void send_last_nonce(uint64_t nonce, unsigned noncebytes, const std::string& pool_id);
+  void send_stats(const std::string& name, MessageValues values);
+  void send_first_hash_stats(const std::string& algo);
+  void add_job_switch_stats();
+  void send_job_switch_stats();
   void free_memory(
     const bool is_batch_changed    = true,
-    const bool is_mem_size_changed = true,
+    const bool is_layout_changed   = true,
     const bool is_free_cn          = true,
-    const bool is_free_rx          = true
+    const bool is_free_rx          = true,
+    const bool is_free_arena       = true
   );
+  xmrig::VirtualMemory* alloc_huge_mem(const std::string& usage, size_t size, bool is_one_gb_pages = false);
+  void reserve_arena(size_t size);
+  void setup_ctx(unsigned batch, unsigned mem_size);
+  void rx_thread(unsigned batch_id, unsigned vm_count);
+  void start_rx_threads(unsigned batch_end);
+  void publish_rx_job(std::shared_ptr<const RxJob> job);
+  void stop_rx_threads();
+  void free_rx_light_vms();
+  RxDataset* evict_rx_datasets(size_t extra_size);
+  bool is_rx_light_mode(const RxDataset* rx, const std::string& key);
+  void alloc_rx_dataset(RxDataset* rx, const std::string& key);
+  void build_rx_dataset(RxDatasetBuild* build, bool is_low_priority);
+  void add_rx_build_threads(RxDatasetBuild* build, unsigned thread_count, bool is_low_priority);
+  RxDataset* select_rx_dataset(const std::string& algo, const std::string& key, const uint8_t* seed);
+  void setup_rx_vms(unsigned batch, unsigned mem_size);
+  void start_rx_light();
+  void finish_rx_build();
+  void stop_rx_build();
+  void send_numa_stats();
+  void trim_rx_datasets();
+  void start_rx_precompute(const std::string& algo, const std::string& key, const uint8_t* seed, unsigned thread_count);
+  void stop_rx_precompute();
+  void set_cn_r_program(uint64_t height, xmrig::CnHash::AlgoVariant av);
+  void stop_cn_r_programs();
+  void set_gr_helper(const std::string& mode, const std::vector<int64_t>& plan_cpus);
+  void finish_gr_tune();
+  void stop_gr_helper();
+  void reap_gr_tunes(bool is_wait);
   void set_fn(cn_any_hash_fun fn);
   void set_job(
     const bool is_set_nonce, const bool is_no_same_input, const MessageValues& v,
     std::function<void(void)> fn_extra_setup = [](){}
   );
   void get_algo_params(const MessageValues& v);
+  void select_kernel_modes(const MessageValues& v);
+  void bench_kernel(const MessageValues& v);
   bool process_message(const std::string& type, const MessageValues& v);
 
   static bool hex2bin(const char* in, unsigned int len, unsigned char* out);
@@ -110,13 +336,22 @@ class Core: public AsyncWorker {
     napi_env env, napi_value data, napi_value complete,
     napi_value error_callback, napi_value options
   ) : AsyncWorker(env, data, complete, error_callback),
-      m_dev(CPU), m_lpads(nullptr), m_rx_cache_mem(nullptr), m_rx_dataset_mem(nullptr),
+      m_dev(CPU), m_lpads(nullptr),
       m_spads(nullptr), m_ctx(nullptr), m_input(nullptr), m_output(nullptr),
       m_job_ref(0), m_height(0), m_batch(0), m_mem_size(0), m_input_len(0),
-      m_nonce_step(1), m_nonce_bytes(4), m_nonce_offset(39), m_c29_proof_size(32),
+      m_nonce_step(1), m_nonce_bytes(4), m_nonce_offset(39), m_c29_proof_size(32), m_ctx_count(0),
       m_nonce32(0), m_nonce64(0), m_nicehash_mask(0), m_target(0), m_timestamp(0),
-      m_hash_count(0), m_is_rx_jit(true),m_rx_cache(nullptr), m_rx_dataset(nullptr),
-      m_thread_pool(nullptr), m_vm(nullptr)
+      m_hash_count(0), m_hashrate_check_counter(HASHRATE_COUNTER_INTERVAL), m_is_rx_jit(true),
+      m_numa_node(0), m_is_numa_report(false), m_rx(nullptr), m_rx_dataset_budget(0),
+      m_is_rx_1gb_pages(false), m_is_rx_shared(false), m_rx_mode("auto"),
+      m_rx_dataset_init("auto"), m_is_rx_dataset_digest(false), m_memory_cap(0), m_is_rx_vm_light(false),
+      m_rx_dataset_hits(0), m_rx_dataset_misses(0),
+      m_rx_build(nullptr), m_rx_next(nullptr), m_rx_job_seq(0), m_is_rx_stop(false), m_rx_thread_count(0),
+      m_rx_thread_vms(1), m_rx_light_vm(nullptr), m_rx_light_threads(0), m_rx_light_count(0), m_rx_light_released(0),
+      m_is_rx_light(false),
+      m_thread_pool(nullptr), m_vm(nullptr), m_switch_timestamp(0),
+      m_job_timestamp(0), m_job_switch_count(0), m_job_switch_sum_us(0), m_job_switch_max_us(0),
+      m_cn_r(nullptr), m_cn_r_next(nullptr), m_cn_r_waits(0), m_gr_helper(nullptr), m_gr_tune_build(nullptr)
   {
     m_fn.any = nullptr;
   }
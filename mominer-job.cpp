@@ -6,21 +6,44 @@
 #include "backend/cpu/Cpu.h"
 #include "crypto/cn/CnCtx.h"
 #include "crypto/cn/CryptoNight.h"
+#include "crypto/cn/CryptoNight_monero.h"
 #include "crypto/ghostrider/ghostrider.h"
 #include "crypto/randomx/configuration.h"
 #include "crypto/randomx/aes_hash.hpp"
+#include "crypto/randomx/blake2/blake2.h"
+#include "base/crypto/keccak.h"
 #include "base/tools/bswap_64.h"
 
+extern "C" {
+#include "crypto/cn/c_blake256.h"
+#include "crypto/cn/c_groestl.h"
+#include "crypto/cn/c_jh.h"
+#include "crypto/cn/c_skein.h"
+}
+
 #include <algorithm>
+#include <limits>
 #include <ranges>
 #include <list>
+#include <mutex>
 #include <set>
 #include <thread>
 #include <cstdlib>
+#include <fstream>
+#if defined(_WIN32)
+#include <windows.h>
+#else
+#include <pthread.h>
+#include <sched.h>
+#include <sys/resource.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
 
-const constexpr unsigned MAX_BLOB_LEN    = 512;
 const constexpr unsigned SPAD_LEN        = 200;
-const constexpr unsigned MAX_CN_CPU_WAYS = 5;
+const constexpr unsigned MAX_CN_CPU_WAYS = 8;
+const constexpr unsigned MAX_CN_CPU_WAYS_ALL_ALGOS = 5; // more ways are only supported by small scratchpad algos
+const constexpr unsigned MAX_RX_THREAD_VMS = 2;
 
 static const xmrig::ICpuInfo& cpu_info() { return *xmrig::Cpu::info(); }
 #define ci cpu_info()
@@ -74,7 +97,10 @@ static const xmrig::CnHash::AlgoVariant cpu_params2variant[MAX_CN_CPU_WAYS][2] =
   { xmrig::CnHash::AV_DOUBLE, xmrig::CnHash::AV_DOUBLE_SOFT },
   { xmrig::CnHash::AV_TRIPLE, xmrig::CnHash::AV_TRIPLE_SOFT },
   { xmrig::CnHash::AV_QUAD,   xmrig::CnHash::AV_QUAD_SOFT   },
-  { xmrig::CnHash::AV_PENTA,  xmrig::CnHash::AV_PENTA_SOFT  }
+  { xmrig::CnHash::AV_PENTA,  xmrig::CnHash::AV_PENTA_SOFT  },
+  { xmrig::CnHash::AV_HEXA,   xmrig::CnHash::AV_HEXA_SOFT   },
+  { xmrig::CnHash::AV_HEPTA,  xmrig::CnHash::AV_HEPTA_SOFT  },
+  { xmrig::CnHash::AV_OCTA,   xmrig::CnHash::AV_OCTA_SOFT   }
 };
 
 static const std::map<std::string, gpu_cn_hash_fun> gpu_cn_algo2fn = {
@@ -94,10 +120,20 @@ static const std::map<std::string, unsigned> algo2mem = [](){
   return result;
 }();
 
-static xmrig::VirtualMemory* alloc_huge_mem(const unsigned size) {
-  xmrig::VirtualMemory* const mem = new xmrig::VirtualMemory(size, true, false, false);
-  if (mem->raw()) return mem;
-  throw std::string("Can't allocate " + std::to_string(size) + " bytes of memory");
+// returns max scratchpad memory needed by "<algo>*<batch>,..." list of planned cpu algos
+static size_t arena_plan_size(const std::string& arena_plan) {
+  size_t result = 0;
+  size_t start, end = 0;
+  while ((start = arena_plan.find_first_not_of(',', end)) != std::string::npos) {
+    end = arena_plan.find(',', start);
+    const std::string part = arena_plan.substr(start, end - start);
+    const size_t batch_pos = part.rfind('*');
+    const auto pi = algo2mem.find(part.substr(0, batch_pos));
+    if (pi == algo2mem.end() || !cpu_name2algo.contains(pi->first)) continue;
+    const unsigned batch = batch_pos == std::string::npos ? 1 : atoi(part.c_str() + batch_pos + 1);
+    result = std::max(result, static_cast<size_t>(batch) * pi->second);
+  }
+  return result;
 }
 
 static void* alloc_mem(const unsigned size) {
@@ -106,31 +142,165 @@ static void* alloc_mem(const unsigned size) {
   throw std::string("Can't allocate " + std::to_string(size) + " bytes of memory");
 }
 
-void ghostrider(
+// helper thread of ghostrider hashes in this thread (see Core::set_gr_helper)
+static thread_local xmrig::ghostrider::HelperThread* gr_thread_helper = nullptr;
+// core hash and cn algo rotation of ghostrider job hashed in this thread (selected once per job by set_job)
+static thread_local xmrig::ghostrider::Rotation gr_thread_rotation;
+
+template<size_t LANES> void ghostrider(
   const uint8_t* input, const size_t input_size, uint8_t* const output,
   cryptonight_ctx** const ctx, const uint64_t height
 ) {
-  xmrig::ghostrider::hash_octa(input, input_size, output, ctx, nullptr);
+  xmrig::ghostrider::hash_lanes(input, input_size, output, ctx, LANES, gr_thread_rotation, gr_thread_helper);
 }
 
 static void init_rx_dataset_thread(
   randomx_dataset* const dataset, randomx_cache* const cache,
   const unsigned start, const unsigned count
 ) {
-  if (ci.hasAVX2() && (count % 5)) {
+  // avx2 code builds 5 items per pass (avx512 one handles any count)
+  if ((count % 5) && strcmp(randomx_cache_dataset_init_name(cache), "avx2") == 0) {
     randomx_init_dataset(dataset, cache, start, count - (count % 5));
     randomx_init_dataset(dataset, cache, start + count - 5, 5);
   } else randomx_init_dataset(dataset, cache, start, count);
 }
 
+// selects VAES code of CryptoNight scratchpad explode/implode and RandomX scratchpad hash/fill
+// for vaes job option ("auto" uses the widest one CPU supports)
+static void set_vaes_mode(const std::string& vaes) {
+  const int mode = vaes == "off" ? 0 : vaes == "256" ? 1 : vaes == "512" ? 2 : -1;
+  randomx_set_vaes_mode(mode);
+  cn_vaes_enabled    = ci.hasVAES() && mode != 0;
+  cn_vaes512_enabled = ci.hasVAES() && ci.has(xmrig::ICpuInfo::FLAG_AVX512F) && (mode < 0 || mode == 2);
+}
+
+// selects multi-buffer keccak code of CryptoNight hash ways for keccak job option ("auto" uses
+// the widest one CPU supports) and returns its name
+static const char* set_keccak_mode(const std::string& keccak) {
+  int lanes = 1;
+  if (keccak != "scalar" && ci.hasAVX2()) lanes = 4;
+  if ((keccak == "auto" || keccak == "avx512") && ci.has(xmrig::ICpuInfo::FLAG_AVX512F)) lanes = 8;
+  lanes = xmrig::keccak_set_multi_lanes(lanes);
+  return lanes == 8 ? "avx512" : lanes == 4 ? "avx2" : "scalar";
+}
+
+// ns per state of keccakf over 8 states with the current multi-buffer keccak code
+static double bench_keccak() {
+  constexpr unsigned PASSES = 2000;
+  alignas(64) uint64_t states[8][25];
+  uint64_t* st[8];
+  for (unsigned i = 0; i != 8; ++ i) {
+    for (unsigned j = 0; j != 25; ++ j) states[i][j] = i * 25 + j;
+    st[i] = states[i];
+  }
+  const uint64_t timestamp = get_timestamp_us();
+  for (unsigned i = 0; i != PASSES; ++ i) xmrig::keccakf_multi(st, 8, 24);
+  return static_cast<double>(get_timestamp_us() - timestamp) * 1000.0 / (PASSES * 8);
+}
+
+// selects multi-buffer code of CryptoNight hash way finalizers for cn_final job option ("auto" uses
+// AVX2 code if CPU supports it) and returns its name
+static const char* set_cn_final_mode(const std::string& cn_final) {
+#if defined(HAVE_AVX2)
+  cn_final_multi_enabled = cn_final != "scalar" && ci.hasAVX2();
+#else
+  cn_final_multi_enabled = false;
+#endif
+  return cn_final_multi_enabled ? "avx2" : "scalar";
+}
+
+// ns per hash of each CryptoNight finalizer over 8 cn states with the current finalizer code
+static MessageValues bench_cn_final() {
+  constexpr unsigned PASSES = 100;
+  uint8_t states[8][200], hashes[8][32];
+  const uint8_t* in[8];
+  uint8_t* out[8];
+  for (unsigned i = 0; i != 8; ++ i) {
+    for (unsigned j = 0; j != 200; ++ j) states[i][j] = i * 200 + j;
+    in[i]  = states[i];
+    out[i] = hashes[i];
+  }
+  const std::pair<const char*, std::function<void()>> finalizers[] = {
+    { "blake", [&]() {
+      if (cn_final_multi_enabled) blake256_hash_multi(out, in, 200, 8);
+      else for (unsigned i = 0; i != 8; ++ i) blake256_hash(out[i], in[i], 200);
+    } },
+    { "groestl", [&]() { for (unsigned i = 0; i != 8; ++ i) groestl(in[i], 200 * 8, out[i]); } },
+    { "jh", [&]() {
+      if (cn_final_multi_enabled) jh256_hash_multi(out, in, 200, 8);
+      else for (unsigned i = 0; i != 8; ++ i) jh_hash(256, in[i], 200 * 8, out[i]);
+    } },
+    { "skein", [&]() {
+      if (cn_final_multi_enabled) xmr_skein_multi(in, out, 8);
+      else for (unsigned i = 0; i != 8; ++ i) xmr_skein(in[i], out[i]);
+    } },
+  };
+  MessageValues values;
+  for (const auto& finalizer : finalizers) {
+    const uint64_t timestamp = get_timestamp_us();
+    for (unsigned i = 0; i != PASSES; ++ i) finalizer.second();
+    char ns_per_hash[32];
+    snprintf(ns_per_hash, sizeof(ns_per_hash), "%.1f", (get_timestamp_us() - timestamp) * 1000.0 / (PASSES * 8));
+    values[finalizer.first] = ns_per_hash;
+  }
+  return values;
+}
+
+// selects multi-buffer code of GhostRider core hashes for gr_core job option ("auto" uses it if CPU supports AVX2)
+// and returns its name
+static const char* set_gr_core_mode(const std::string& gr_core) {
+#if defined(HAVE_AVX2)
+  xmrig::ghostrider::core_multi_enabled = gr_core != "scalar" && ci.hasAVX2();
+#else
+  xmrig::ghostrider::core_multi_enabled = false;
+#endif
+  return xmrig::ghostrider::core_multi_enabled ? "multi" : "scalar";
+}
+
+// ns per hash of each GhostRider core hash with multi-buffer code over 8 lanes of 64 byte inputs with the
+// current core hash code
+static MessageValues bench_gr_core() {
+  constexpr unsigned PASSES = 100;
+  alignas(64) uint8_t lanes[8 * 64];
+  for (unsigned i = 0; i != sizeof(lanes); ++ i) lanes[i] = i;
+  const std::pair<const char*, uint32_t> core_hashes[] = {
+    { "groestl", 2 }, { "shavite", 8 }, { "simd", 9 }, { "echo", 10 }, { "hamsi", 11 }, { "whirlpool", 14 }
+  };
+  MessageValues values;
+  for (const auto& core_hash : core_hashes) {
+    const uint64_t timestamp = get_timestamp_us();
+    for (unsigned i = 0; i != PASSES; ++ i) xmrig::ghostrider::core_hash_lanes(core_hash.second, lanes, 64, lanes, 8);
+    char ns_per_hash[32];
+    snprintf(ns_per_hash, sizeof(ns_per_hash), "%.1f", (get_timestamp_us() - timestamp) * 1000.0 / (PASSES * 8));
+    values[core_hash.first] = ns_per_hash;
+  }
+  return values;
+}
+
+// kernel code job keys the process selected its kernel code globals for and names of the selected code
+// (guarded by kernel_modes_mutex since they are shared by all compute cores of the process)
+static std::mutex kernel_modes_mutex;
+static MessageValues kernel_modes, kernel_codes;
+
+// randomx_set_optimized_dataset_init value for rx_dataset_init job option ("auto" uses the
+// widest of avx512/avx2 code that CPU supports)
+static int get_rx_dataset_init_mode(const std::string& rx_dataset_init) {
+  if (rx_dataset_init == "scalar") return 0;
+  if (rx_dataset_init == "avx2")   return 2;
+#if defined(_WIN32)
+  return 0;
+#else
+  return 1;
+#endif
+}
+
 static randomx_flags get_rx_vm_flags(
-  const bool is_rx_jit, const randomx_dataset* const m_rx_dataset,
-  const xmrig::VirtualMemory* const m_rx_dataset_mem
+  const bool is_rx_jit, const RxDataset* const rx, const bool is_light = false
 ) {
   unsigned rx_flags = RANDOMX_FLAG_DEFAULT;
-  if (m_rx_dataset_mem->isHugePages()) rx_flags |= RANDOMX_FLAG_LARGE_PAGES;
+  if (rx->is_huge_pages()) rx_flags |= RANDOMX_FLAG_LARGE_PAGES;
   if (ci.hasAES()) rx_flags |= RANDOMX_FLAG_HARD_AES;
-  if (m_rx_dataset) rx_flags |= RANDOMX_FLAG_FULL_MEM;
+  if (rx->dataset && !is_light) rx_flags |= RANDOMX_FLAG_FULL_MEM;
   if (is_rx_jit) rx_flags |= RANDOMX_FLAG_JIT;
   const auto assembly = ci.assembly();
   if (assembly == xmrig::Assembly::RYZEN || assembly == xmrig::Assembly::BULLDOZER)
@@ -138,6 +308,826 @@ static randomx_flags get_rx_vm_flags(
   return static_cast<randomx_flags>(rx_flags);
 }
 
+static const unsigned RX_DATASET_CHUNK = 1 << 16; // dataset items built in one go by one thread
+
+// lowers priority of the current thread so background work does not steal hashing time
+static void set_low_thread_priority() {
+#if defined(_WIN32)
+  SetThreadPriority(GetCurrentThread(), THREAD_PRIORITY_IDLE);
+#else
+  setpriority(PRIO_PROCESS, static_cast<id_t>(syscall(SYS_gettid)), 19);
+#endif
+}
+
+// pins the current thread to cpus (or allows it to run on any process cpu if cpus are empty)
+static bool set_thread_affinity(const std::vector<int>& cpus) {
+#if defined(_WIN32)
+  DWORD_PTR process_mask, system_mask, mask = 0;
+  if (!GetProcessAffinityMask(GetCurrentProcess(), &process_mask, &system_mask)) return false;
+  for (const int cpu : cpus) {
+    if (cpu >= static_cast<int>(sizeof(DWORD_PTR) * 8)) return false;
+    mask |= static_cast<DWORD_PTR>(1) << cpu;
+  }
+  return SetThreadAffinityMask(GetCurrentThread(), cpus.empty() ? process_mask : mask) != 0;
+#else
+  cpu_set_t set;
+  CPU_ZERO(&set);
+  if (cpus.empty()) { // main process thread is never pinned
+    if (sched_getaffinity(getpid(), sizeof(set), &set) != 0) return false;
+  } else for (const int cpu : cpus) {
+    if (cpu >= CPU_SETSIZE) return false;
+    CPU_SET(cpu, &set);
+  }
+  return pthread_setaffinity_np(pthread_self(), sizeof(set), &set) == 0;
+#endif
+}
+
+// returns all cpus of numa node from its sysfs cpulist like "0-3,8-11" (empty if unknown)
+static std::vector<int> get_numa_node_cpus(const uint32_t node) {
+  std::vector<int> cpus;
+#if defined(__linux__)
+  std::ifstream file("/sys/devices/system/node/node" + std::to_string(node) + "/cpulist");
+  std::string list;
+  if (!std::getline(file, list)) return cpus;
+  for (const char* p = list.c_str(); *p; ) {
+    char* end;
+    const long first = strtol(p, &end, 10);
+    const long last  = *end == '-' ? strtol(end + 1, &end, 10) : first;
+    if (end == p) break;
+    for (long cpu = first; cpu <= last; ++ cpu) cpus.push_back(cpu);
+    p = *end == ',' ? end + 1 : end;
+  }
+#else
+  (void)node;
+#endif
+  return cpus;
+}
+
+// returns numa node distribution of size bytes at mem sampled by pages like "0=75%,1=25%"
+// (pages that were not touched yet are counted as "none", "?" if it is not supported)
+static std::string get_numa_report(const void* const mem, const size_t size) {
+#if defined(__linux__)
+  const size_t PAGE_LEN = 4096, SAMPLES = 256;
+  const size_t pages = std::max<size_t>(size / PAGE_LEN, 1), step = std::max<size_t>(pages / SAMPLES, 1);
+  std::vector<void*> addrs;
+  for (size_t page = 0; page < pages; page += step)
+    addrs.push_back(static_cast<uint8_t*>(const_cast<void*>(mem)) + page * PAGE_LEN);
+  std::vector<int> status(addrs.size());
+  if (syscall(SYS_move_pages, 0, addrs.size(), addrs.data(), nullptr, status.data(), 0) != 0) return "?";
+  std::map<int, unsigned> counts;
+  for (const int node : status) ++ counts[node < 0 ? -1 : node];
+  std::string result;
+  for (const auto& [node, count] : counts) {
+    if (!result.empty()) result += ",";
+    result += (node < 0 ? std::string("none") : std::to_string(node)) + "=" +
+              std::to_string(count * 100 / addrs.size()) + "%";
+  }
+  return result;
+#else
+  (void)mem; (void)size;
+  return "?";
+#endif
+}
+
+static const size_t RX_MEMORY_RESERVE = 128 << 20; // memory that is left free by full mode rx dataset
+
+// reads memory limit and usage (in bytes) of memory cgroup (v2 or v1) of this process
+static bool get_cgroup_memory(size_t& limit, size_t& usage) {
+#if defined(__linux__)
+  static const std::string V2_ROOT = "/sys/fs/cgroup/memory.", V1_ROOT = "/sys/fs/cgroup/memory/memory.";
+  std::ifstream cgroup("/proc/self/cgroup");
+  std::vector<std::string> dirs;
+  for (std::string line; std::getline(cgroup, line); ) {
+    if (line.starts_with("0::")) {
+      dirs.push_back("/sys/fs/cgroup" + line.substr(3) + "/memory.");
+      dirs.push_back(V2_ROOT); // cgroup namespace root
+    } else if (line.find(":memory:") != std::string::npos) {
+      dirs.push_back("/sys/fs/cgroup/memory" + line.substr(line.find(":memory:") + 8) + "/memory.");
+      dirs.push_back(V1_ROOT);
+    }
+  }
+  for (const std::string& dir : dirs) {
+    const bool is_v1 = dir.find("/memory/") != std::string::npos;
+    std::ifstream limit_file(dir + (is_v1 ? "limit_in_bytes" : "max")),
+                  usage_file(dir + (is_v1 ? "usage_in_bytes" : "current"));
+    std::string limit_str, usage_str;
+    if (!(limit_file >> limit_str) || !(usage_file >> usage_str)) continue;
+    if (limit_str == "max") return false;
+    limit = strtoull(limit_str.c_str(), NULL, 10);
+    usage = strtoull(usage_str.c_str(), NULL, 10);
+    return limit < (1ULL << 60); // v1 uses huge number for no limit
+  }
+#else
+  (void)limit; (void)usage;
+#endif
+  return false;
+}
+
+// returns memory (in bytes) that can be allocated now by MemAvailable of /proc/meminfo and
+// cgroup memory limit (both increased by free hugetlb pages that are not accounted there)
+// and sets source to the one that limits it ("" if there is no limit)
+static size_t get_available_memory(std::string& source) {
+  size_t result = std::numeric_limits<size_t>::max();
+  source.clear();
+#if defined(__linux__)
+  std::ifstream meminfo("/proc/meminfo");
+  unsigned long long mem_available = 0, huge_free = 0, huge_size = 0;
+  bool is_mem_available = false;
+  for (std::string line; std::getline(meminfo, line); ) {
+    if (sscanf(line.c_str(), "MemAvailable: %llu kB", &mem_available) == 1) is_mem_available = true;
+    sscanf(line.c_str(), "HugePages_Free: %llu", &huge_free);
+    sscanf(line.c_str(), "Hugepagesize: %llu kB", &huge_size);
+  }
+  const size_t huge_free_mem = huge_free * huge_size << 10;
+  if (is_mem_available) {
+    result = (mem_available << 10) + huge_free_mem;
+    source = "meminfo";
+  }
+  size_t limit, usage;
+  if (get_cgroup_memory(limit, usage) && (limit > usage ? limit - usage : 0) + huge_free_mem < result) {
+    result = (limit > usage ? limit - usage : 0) + huge_free_mem;
+    source = "cgroup";
+  }
+#endif
+  return result;
+}
+
+// decides if new rx dataset for key should be light one (only cache that is used by slower light
+// mode vms) if there is no memory for the full one and reports this decision as rx_mode stats
+bool Core::is_rx_light_mode(const RxDataset* const rx, const std::string& key) {
+  bool is_light = false;
+  std::string reason;
+  if (m_rx_mode == "full" || m_rx_mode == "light") {
+    is_light = m_rx_mode == "light";
+    reason   = "rx_mode option";
+  } else {
+    // dataset memory of reused rx is available for the new dataset too
+    const size_t reused = rx->dataset_mem ? rx->dataset_mem->size() : 0;
+    std::string source;
+    size_t available = get_available_memory(source);
+    if (!source.empty()) available += reused;
+    if (m_memory_cap) {
+      size_t used = (m_lpads ? m_lpads->size() : 0) + rx->size() - reused;
+      for (const RxDataset* const rx2 : m_rx_datasets) used += rx2->size();
+      if (m_rx_next) used += m_rx_next->rx->size();
+      const size_t cap_available = m_memory_cap > used ? m_memory_cap - used : 0;
+      if (cap_available <= available) { available = cap_available; source = "memory_cap_mb"; }
+    }
+    const size_t needed = RANDOMX_DATASET_MAX_SIZE + RX_MEMORY_RESERVE;
+    is_light = available < needed;
+    reason = source.empty() ? std::string("no memory limit") :
+             std::to_string(needed >> 20) + " MB needed, " + std::to_string(available >> 20) +
+             " MB available by " + source;
+  }
+  MessageValues values;
+  values["key"]    = key;
+  values["mode"]   = is_light ? "light" : "full";
+  values["reason"] = reason;
+  send_stats("rx_mode", values);
+  return is_light;
+}
+
+// removes least recently used rx datasets (except one used by m_vm) until they fit into
+// m_rx_dataset_budget together with extra_size and returns the last removed one for reuse
+RxDataset* Core::evict_rx_datasets(const size_t extra_size) {
+  size_t used = 0;
+  for (const RxDataset* const rx : m_rx_datasets) used += rx->size();
+  RxDataset* result = nullptr;
+  auto pi = m_rx_datasets.end();
+  while (pi != m_rx_datasets.begin() && used + extra_size > m_rx_dataset_budget) {
+    RxDataset* const rx = *--pi;
+    if (rx == m_rx) continue;
+    used -= rx->size();
+    pi = m_rx_datasets.erase(pi);
+    if (result) delete result;
+    result = rx;
+  }
+  return result;
+}
+
+// allocates size bytes on 2MB (or 1GB if is_one_gb_pages) huge pages falling back to 2MB aligned
+// memory advised for transparent huge pages and reports pages it actually got as "memory" stats
+xmrig::VirtualMemory* Core::alloc_huge_mem(
+  const std::string& usage, const size_t size, const bool is_one_gb_pages
+) {
+  xmrig::VirtualMemory* const mem = new xmrig::VirtualMemory(
+    size, true, is_one_gb_pages, false, m_numa_node, xmrig::VirtualMemory::kDefaultHugePageSize
+  );
+  if (mem->raw() == nullptr) {
+    delete mem;
+    throw std::string("Can't allocate " + std::to_string(size) + " bytes of memory");
+  }
+  const xmrig::HugePagesInfo huge_pages = mem->hugePages();
+  MessageValues values;
+  values["usage"]      = usage;
+  values["size"]       = std::to_string(mem->size());
+  values["pages"]      = mem->isOneGbPages() ? "1GB" : mem->isHugePages() ? "2MB" :
+                         xmrig::VirtualMemory::adviseLargePages(mem->raw(), mem->size()) ? "THP" : "4KB";
+  values["huge_pages"] = std::to_string(huge_pages.allocated) + "/" + std::to_string(huge_pages.total);
+  send_stats("memory", values);
+  return mem;
+}
+
+// allocates missing rx cache and dataset memory and objects
+void Core::alloc_rx_dataset(RxDataset* const rx, const std::string& key) {
+  rx->drop_shared(); // shared segment can only be used for its key
+  const bool is_light = is_rx_light_mode(rx, key);
+  if (is_light && rx->dataset_mem) { // memory of reused full mode dataset
+    if (rx->dataset) { randomx_release_dataset(rx->dataset); rx->dataset = nullptr; }
+    delete rx->dataset_mem;
+    rx->dataset_mem = nullptr;
+  }
+  if (rx->cache_mem == nullptr)   rx->cache_mem   = alloc_huge_mem("rx_cache", RANDOMX_CACHE_MAX_SIZE);
+  if (m_is_rx_shared && !is_light) {
+    // processes pinned to different numa nodes share datasets only inside their node
+    std::string name = key + (m_affinity.empty() ? "" : "-node" + std::to_string(m_numa_node));
+    std::replace(name.begin(), name.end(), '/', '-');
+    rx->shared = RxSharedDataset::open(name, RANDOMX_DATASET_MAX_SIZE);
+    if (rx->shared) {
+      if (rx->dataset)     { randomx_release_dataset(rx->dataset); rx->dataset = nullptr; }
+      if (rx->dataset_mem) { delete rx->dataset_mem; rx->dataset_mem = nullptr; }
+      MessageValues values;
+      values["usage"]  = "rx_dataset";
+      values["size"]   = std::to_string(rx->shared->mem_size);
+      values["pages"]  = rx->shared->is_huge_pages ? "2MB" : "shm";
+      values["shared"] = rx->shared->path + (rx->shared->is_owner ? " (build)" : " (map)");
+      send_stats("memory", values);
+    }
+  }
+  if (!is_light && rx->shared == nullptr && rx->dataset_mem == nullptr)
+    rx->dataset_mem = alloc_huge_mem("rx_dataset", RANDOMX_DATASET_MAX_SIZE, m_is_rx_1gb_pages);
+  if (rx->cache && rx->cache_init != m_rx_dataset_init) { // dataset init code is set up with cache
+    randomx_release_cache(rx->cache);
+    rx->cache = nullptr;
+  }
+  rx->cache_init = m_rx_dataset_init;
+  if (rx->cache == nullptr && m_is_rx_jit) {
+    randomx_set_optimized_dataset_init(get_rx_dataset_init_mode(m_rx_dataset_init));
+    rx->cache = randomx_create_cache(RANDOMX_FLAG_JIT, rx->cache_mem->raw());
+    if (rx->cache == nullptr) m_is_rx_jit = false;
+  }
+  if (rx->cache == nullptr)
+    rx->cache = randomx_create_cache(RANDOMX_FLAG_DEFAULT, rx->cache_mem->raw());
+  if (rx->dataset == nullptr && !is_light) rx->dataset = randomx_create_dataset(rx->dataset_raw());
+}
+
+// build thread: the first one inits cache, then all build dataset chunks until there are no more
+void Core::build_rx_dataset(RxDatasetBuild* const build, const bool is_low_priority) {
+  if (is_low_priority) set_low_thread_priority();
+  // build on the numa node of hashing threads so cache and dataset pages are touched there first
+  if (!build->cpus.empty()) {
+    set_thread_affinity(build->cpus);
+    xmrig::VirtualMemory::bindToNUMANode(build->cpus[0]);
+  }
+  const unsigned item_count = randomx_dataset_item_count();
+  if (!build->is_cache_started.exchange(true)) {
+    randomx_init_cache(build->rx->cache, build->seed, HASH_LEN);
+    if (build->rx->dataset == nullptr) build->done_items = item_count; // light mode only needs cache
+    build->items_timestamp = get_timestamp_ms();
+    build->is_cache_ready = true;
+  } else while (!build->is_cache_ready) {
+    if (build->is_abort) return;
+    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+  }
+  if (build->rx->dataset == nullptr) return;
+  // shared dataset is built by another process: wait for it or take its build over
+  RxSharedDataset* const shared = build->rx->shared;
+  while (shared && !shared->is_owner) {
+    if (build->is_abort) return;
+    if (shared->is_ready()) { build->done_items = item_count; return; }
+    if (shared->take_over()) break;
+    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+  }
+  while (!build->is_abort) {
+    const unsigned start = build->next_item.fetch_add(RX_DATASET_CHUNK);
+    if (start >= item_count) break;
+    const unsigned count = std::min(RX_DATASET_CHUNK, item_count - start);
+    init_rx_dataset_thread(build->rx->dataset, build->rx->cache, start, count);
+    const unsigned done = build->done_items += count;
+    if (done == item_count && shared) shared->set_ready();
+    if (done * 10ULL / item_count != (done - count) * 10ULL / item_count) {
+      MessageValues values;
+      values["key"]      = build->key;
+      values["progress"] = std::to_string(done * 100ULL / item_count) + "%";
+      values["time_ms"]  = std::to_string(get_timestamp_ms() - build->timestamp);
+      if (done == item_count) {
+        const uint64_t items_ms = std::max<uint64_t>(get_timestamp_ms() - build->items_timestamp, 1);
+        values["dataset_init"]  = randomx_cache_dataset_init_name(build->rx->cache);
+        values["items_per_sec"] = std::to_string(item_count * 1000ULL / items_ms);
+        if (build->is_digest) {
+          // to compare datasets built by different dataset init code
+          blake2b_state state;
+          uint8_t digest[HASH_LEN];
+          char digest_hex[HASH_LEN * 2 + 1];
+          rx_blake2b_init(&state, HASH_LEN);
+          rx_blake2b_update(&state, randomx_get_dataset_memory(build->rx->dataset),
+                            static_cast<size_t>(item_count) * RANDOMX_DATASET_ITEM_SIZE);
+          rx_blake2b_final(&state, digest, HASH_LEN);
+          values["digest"] = hash_bin2hex(digest, digest_hex);
+        }
+      }
+      send_stats(is_low_priority ? "rx_precompute" : "rx_build", values);
+    }
+  }
+}
+
+void Core::add_rx_build_threads(
+  RxDatasetBuild* const build, const unsigned thread_count, const bool is_low_priority
+) {
+  for (unsigned i = 0; i < thread_count; ++i)
+    build->threads.emplace_back(&Core::build_rx_dataset, this, build, is_low_priority);
+}
+
+// returns rx dataset for "<algo>/<seed_hex>" key from m_rx_datasets or nullptr if the job needs
+// to wait for m_rx_build (finished from the background m_rx_next build or initialized in place
+// of least recently used datasets that do not fit into m_rx_dataset_budget together with it)
+// (rx config should be already applied and rx threads stopped)
+RxDataset* Core::select_rx_dataset(
+  const std::string& algo, const std::string& key, const uint8_t* const seed
+) {
+  m_rx = nullptr; // m_vm will be switched to the new dataset
+  if (m_rx_build) {
+    if (m_rx_build->key == key) return nullptr;
+    stop_rx_build();
+  }
+  // light mode hashing threads (if any) take their part of cpu threads from the build
+  const unsigned cpu_count    = m_numa_cpus.empty() ? std::thread::hardware_concurrency() : m_numa_cpus.size(),
+                 thread_count = std::max(cpu_count, m_rx_light_threads + 1) - m_rx_light_threads;
+  const auto pi = std::find_if(m_rx_datasets.begin(), m_rx_datasets.end(),
+    [&key](const RxDataset* const rx) { return rx->key == key; }
+  );
+  if (pi != m_rx_datasets.end()) {
+    RxDataset* const rx = *pi;
+    m_rx_datasets.erase(pi);
+    m_rx_datasets.push_front(m_rx = rx);
+    ++ m_rx_dataset_hits;
+    return rx;
+  }
+
+  if (m_rx_next && m_rx_next->key == key) {
+    // help to finish background build with all threads at normal priority
+    m_rx_build = m_rx_next;
+    m_rx_next  = nullptr;
+    m_rx_build->wait_timestamp = get_timestamp_ms();
+    m_rx_build->wait_items     = m_rx_build->done_items;
+    if (!m_rx_build->is_done()) add_rx_build_threads(m_rx_build, thread_count, false);
+    ++ m_rx_dataset_hits;
+    return nullptr;
+  }
+
+  ++ m_rx_dataset_misses;
+  RxDataset* rx = evict_rx_datasets(RANDOMX_CACHE_MAX_SIZE + RANDOMX_DATASET_MAX_SIZE);
+  if (rx == nullptr) rx = new RxDataset();
+  rx->key.clear();
+  try {
+    alloc_rx_dataset(rx, key);
+  } catch (const std::string&) {
+    // fallback to reuse of the least recently used dataset if we are out of memory
+    // (that has its own dataset memory)
+    if (m_rx_datasets.empty() || m_rx_datasets.back()->dataset_mem == nullptr) { delete rx; throw; }
+    delete rx;
+    rx = m_rx_datasets.back();
+    m_rx_datasets.pop_back();
+    rx->key.clear();
+  }
+  m_rx_build = new RxDatasetBuild(rx, algo, key, seed, m_numa_cpus, m_is_rx_dataset_digest);
+  add_rx_build_threads(m_rx_build, thread_count, false);
+  return nullptr;
+}
+
+// creates rx vms for m_rx dataset or switches existing ones to it
+void Core::setup_rx_vms(const unsigned batch, const unsigned mem_size) {
+  // vms can only be switched to dataset of the same (full or light) mode
+  if (m_vm && m_is_rx_vm_light != (m_rx->dataset == nullptr)) {
+    for (unsigned i = 0; i != batch; ++ i) randomx_destroy_vm(m_vm[i]);
+    delete [] m_vm; m_vm = nullptr;
+  }
+  if (m_vm) {
+    for (unsigned i = 0; i != batch; ++ i) {
+      randomx_vm_set_cache(m_vm[i], m_rx->cache);
+      if (m_rx->dataset) randomx_vm_set_dataset(m_vm[i], m_rx->dataset);
+    }
+    return;
+  }
+  m_is_rx_vm_light = m_rx->dataset == nullptr;
+  m_vm = new randomx_vm*[batch];
+  for (unsigned i = 0; i != batch; ++ i) {
+    m_vm[i] = randomx_create_vm(
+      get_rx_vm_flags(m_is_rx_jit, m_rx), m_rx->cache, m_rx->dataset,
+      m_lpads->scratchpad() + i * mem_size, m_numa_node
+    );
+  }
+}
+
+// persistent rx thread that computes hashes of the published m_rx_job using vm_count vms from batch_id one
+// (new job is picked up between hashes without stopping this thread)
+void Core::rx_thread(const unsigned batch_id, const unsigned vm_count) {
+  // per vm hashing state (two vms of interleaved rx thread alternate their programs)
+  struct Lane {
+    alignas(16) uint8_t  input[MAX_BLOB_LEN];
+    alignas(16) uint8_t  output[HASH_LEN];
+    alignas(16) uint8_t  raw_hash[HASH_LEN];
+    alignas(16) uint64_t temp_hash[8];
+    randomx_vm* vm;
+    uint32_t nonce;
+  } lanes[MAX_RX_THREAD_VMS];
+  std::shared_ptr<const RxJob> job;
+  unsigned job_seq = m_rx_job_seq.load() - 1, hashrate_update_counter = HASHRATE_COUNTER_INTERVAL;
+  bool is_hashing = false, is_first_hash = false;
+  // light mode vms are switched to full mode ones in place once dataset is ready
+  bool is_light = m_is_rx_light;
+  for (unsigned i = 0; i != vm_count; ++ i) {
+    lanes[i].vm = is_light ? m_rx_light_vm[batch_id + i] : m_vm[batch_id + i];
+    lanes[i].nonce = 0;
+  }
+  // thread started after dataset is ready never uses its light mode vms
+  if (!is_light && batch_id < m_rx_light_count) m_rx_light_released.fetch_add(vm_count, std::memory_order_release);
+  // rx/2 commitment of input is kept in vm along with its hash state
+  const auto hash_first = [&](Lane& lane) {
+    if (job->is_rx_v2) randomx_calculate_hash_first_commitment(lane.vm, lane.temp_hash, lane.input, job->input_len);
+    else randomx_calculate_hash_first(lane.vm, lane.temp_hash, lane.input, job->input_len);
+  };
+  if (!m_affinity.empty()) {
+    const int cpu = m_affinity[batch_id / m_rx_thread_vms % m_affinity.size()];
+    if (!set_thread_affinity({ cpu })) send_error("Can't pin rx thread to CPU " + std::to_string(cpu));
+    xmrig::VirtualMemory::bindToNUMANode(cpu); // for scratchpad pages touched by this thread
+  }
+  try {
+    while (true) {
+      const unsigned seq = m_rx_job_seq.load(std::memory_order_acquire);
+      if (m_is_rx_stop) break;
+      if (is_light && !m_is_rx_light) {
+        is_light = false;
+        for (unsigned i = 0; i != vm_count; ++ i) {
+          lanes[i].vm = m_vm[batch_id + i];
+          // full mode vm shares scratchpad but not rx/2 commitment state so it is restarted from input
+          if (is_hashing && job->is_rx_v2) hash_first(lanes[i]);
+        }
+        m_rx_light_released.fetch_add(vm_count, std::memory_order_release);
+      }
+      if (seq != job_seq) { // new job (or pause) was published
+        job_seq = seq;
+        std::shared_ptr<const RxJob> new_job = m_rx_job.load();
+        if (new_job != job) {
+          // only send for mine jobs
+          if (job && job->target) for (unsigned i = 0; i != vm_count; ++ i)
+            send_last_nonce(lanes[i].nonce, 4, job->pool_id);
+          job = std::move(new_job);
+          if ((is_hashing = job != nullptr)) for (unsigned i = 0; i != vm_count; ++ i) {
+            Lane& lane = lanes[i];
+            uint32_t* const pnonce = reinterpret_cast<uint32_t*>(lane.input + job->nonce_offset);
+            memcpy(lane.input, job->input, job->input_len);
+            lane.nonce = job->nonce + batch_id + i;
+            if (job->nicehash_mask) lane.nonce |= bswap_32(*pnonce) & job->nicehash_mask;
+            if (job->is_set_nonce) *pnonce = bswap_32(lane.nonce);
+            hash_first(lane);
+            is_first_hash = true;
+          }
+        }
+      }
+      if (!is_hashing) { m_rx_job_seq.wait(seq, std::memory_order_acquire); continue; }
+
+      // input nonce is the one after the nonce of the hash computed below
+      uint32_t prev_nonces[MAX_RX_THREAD_VMS];
+      for (unsigned i = 0; i != vm_count; ++ i) {
+        Lane& lane = lanes[i];
+        prev_nonces[i] = lane.nonce;
+        lane.nonce += job->nonce_step;
+        // check that current nonce is greater than previous one and nince hash protected nonce part is not changed
+        if (job->target && ( job->nicehash_mask ? (prev_nonces[i] & job->nicehash_mask) != (lane.nonce & job->nicehash_mask) :
+                             prev_nonces[i] > lane.nonce )
+        ) is_hashing = false;
+        *reinterpret_cast<uint32_t*>(lane.input + job->nonce_offset) = bswap_32(lane.nonce);
+      }
+      if (!is_hashing) {
+        send_error("Nonce overflow");
+        continue; // wait for the next job
+      }
+      // rx/2 output is commitment while raw hash is sent along with it
+      if (vm_count == 2) {
+        randomx_vm* const vms[2] = { lanes[0].vm, lanes[1].vm };
+        uint64_t (* const temp_hashes[2])[8] = { &lanes[0].temp_hash, &lanes[1].temp_hash };
+        const void* const inputs[2] = { lanes[0].input, lanes[1].input };
+        void* const outputs[2]      = { lanes[0].output, lanes[1].output };
+        void* const raw_hashes[2]   = { lanes[0].raw_hash, lanes[1].raw_hash };
+        if (job->is_rx_v2) randomx_calculate_hash_next_x2(vms, temp_hashes, inputs, job->input_len, raw_hashes, outputs);
+        else randomx_calculate_hash_next_x2(vms, temp_hashes, inputs, job->input_len, outputs, nullptr);
+      } else {
+        Lane& lane = lanes[0];
+        if (job->is_rx_v2)
+          randomx_calculate_hash_next_commitment(lane.vm, lane.temp_hash, lane.input, job->input_len, lane.raw_hash, lane.output);
+        else randomx_calculate_hash_next(lane.vm, lane.temp_hash, lane.input, job->input_len, lane.output);
+      }
+      send_first_hash_stats(job->algo);
+      if (is_first_hash) { add_job_switch_stats(); is_first_hash = false; }
+      if (!job->is_set_nonce) { // test job
+        for (unsigned i = 0; i != vm_count; ++ i) {
+          char hash[HASH_LEN*2+1];
+          send_msg("test", "result", hash_bin2hex(lanes[i].output, hash));
+        }
+        is_hashing = false;
+        continue;
+      }
+      if (--hashrate_update_counter == 0) {
+        hashrate_update_counter = HASHRATE_COUNTER_INTERVAL;
+        m_mutex_hashrate.lock();
+        m_hash_count += HASHRATE_COUNTER_INTERVAL * vm_count;
+        m_mutex_hashrate.unlock();
+      }
+      if (job->target) for (unsigned i = 0; i != vm_count; ++ i) {
+        const Lane& lane = lanes[i];
+        if (*get_result(lane.output, 0) < job->target)
+          send_result(prev_nonces[i], 4, lane.output, nullptr, 32, job->is_rx_v2 ? lane.raw_hash : nullptr, job.get());
+      }
+    }
+    if (job && job->target) for (unsigned i = 0; i != vm_count; ++ i)
+      send_last_nonce(lanes[i].nonce, 4, job->pool_id);
+  } catch(const std::string& err) {
+    send_error(std::string("Compute function thread exception: ") + err);
+  } catch(...) {
+    send_error("Compute function thread exception");
+  }
+}
+
+// starts not yet started rx threads up to batch_end
+void Core::start_rx_threads(const unsigned batch_end) {
+  if (m_thread_pool == nullptr) {
+    const unsigned thread_count = (m_batch + m_rx_thread_vms - 1) / m_rx_thread_vms;
+    m_thread_pool = new ctpl::thread_pool(thread_count);
+    if (!ci.hasAES()) SelectSoftAESImpl(thread_count);
+  }
+  while (m_rx_thread_count < batch_end) {
+    const unsigned batch_id = m_rx_thread_count, vm_count = std::min(m_rx_thread_vms, batch_end - batch_id);
+    m_thread_pool->push([this, batch_id, vm_count](int) { rx_thread(batch_id, vm_count); });
+    m_rx_thread_count += vm_count;
+  }
+}
+
+// makes rx threads switch to the new job (or become idle if it is nullptr) after their current hash
+void Core::publish_rx_job(std::shared_ptr<const RxJob> job) {
+  m_rx_job.store(std::move(job));
+  m_rx_job_seq.fetch_add(1, std::memory_order_release);
+  m_rx_job_seq.notify_all();
+}
+
+// starts first m_rx_light_threads rx threads with light mode vms that use m_rx_build cache
+// while the rest of threads still build its dataset
+void Core::start_rx_light() {
+  RxDataset* const rx = m_rx_build->rx;
+  m_rx_light_count = m_rx_light_threads;
+  m_rx_light_released = 0;
+  m_rx_light_vm = new randomx_vm*[m_rx_light_count];
+  for (unsigned i = 0; i != m_rx_light_count; ++ i) {
+    m_rx_light_vm[i] = randomx_create_vm(
+      get_rx_vm_flags(m_is_rx_jit, rx, true), rx->cache, nullptr,
+      m_lpads->scratchpad() + i * m_mem_size, m_numa_node
+    );
+  }
+  if (!m_rx_build->light_timestamp) m_rx_build->light_timestamp = get_timestamp_ms();
+  m_is_rx_light = true;
+  start_rx_threads(m_rx_light_count);
+}
+
+// switches rx vms to the done m_rx_build dataset and starts the rest of rx threads
+void Core::finish_rx_build() {
+  for (auto& thread : m_rx_build->threads) thread.join();
+  RxDataset* const rx = m_rx_build->rx;
+  rx->key = m_rx_build->key;
+  MessageValues values;
+  values["key"]         = m_rx_build->key;
+  values["precomputed"] = std::to_string(m_rx_build->wait_items * 100ULL / randomx_dataset_item_count()) + "%";
+  const uint64_t timestamp = get_timestamp_ms(),
+                 light_timestamp = m_rx_build->light_timestamp ? m_rx_build->light_timestamp : timestamp;
+  values["wait_ms"]     = std::to_string(timestamp - m_rx_build->wait_timestamp);
+  values["idle_ms"]     = std::to_string(light_timestamp - m_rx_build->wait_timestamp);
+  values["light_ms"]    = std::to_string(timestamp - light_timestamp);
+  send_stats("rx_build", values);
+  delete m_rx_build;
+  m_rx_build = nullptr;
+  m_rx_datasets.push_front(m_rx = rx);
+  setup_rx_vms(m_batch, m_mem_size);
+  // light mode threads (if any) now switch to full mode vms by themselves (idle ones are woken up for that)
+  // and their light mode vms are freed by free_rx_light_vms() once all of them switched
+  m_is_rx_light = false;
+  m_rx_job_seq.fetch_add(1, std::memory_order_release);
+  m_rx_job_seq.notify_all();
+  start_rx_threads(m_batch);
+  m_is_numa_report = true;
+  trim_rx_datasets();
+}
+
+// aborts m_rx_build keeping its memory in m_rx_datasets for reuse
+void Core::stop_rx_build() {
+  if (m_rx_build == nullptr) return;
+  if (m_is_rx_light) stop_rx_threads(); // light mode vms use m_rx_build cache
+  m_rx_build->is_abort = true;
+  for (auto& thread : m_rx_build->threads) thread.join();
+  m_rx_build->rx->drop_shared(); // so other processes can take its build over
+  m_rx_datasets.push_back(m_rx_build->rx); // with empty key so it is evicted first
+  delete m_rx_build;
+  m_rx_build = nullptr;
+}
+
+// reports numa nodes that memory of m_rx dataset and rx scratchpads is placed on
+void Core::send_numa_stats() {
+  MessageValues values;
+  values["node"]        = m_affinity.empty() ? std::string("any") : std::to_string(m_numa_node);
+  values["cache"]       = get_numa_report(m_rx->cache_mem->raw(), m_rx->cache_mem->size());
+  values["dataset"]     = m_rx->dataset ? get_numa_report(m_rx->dataset_raw(), RANDOMX_DATASET_MAX_SIZE) : "none";
+  values["scratchpads"] = get_numa_report(m_lpads->scratchpad(), static_cast<size_t>(m_batch) * m_mem_size);
+  send_stats("numa", values);
+}
+
+// frees rx datasets over the budget (after precomputed dataset was added) and reports their stats
+void Core::trim_rx_datasets() {
+  delete evict_rx_datasets(0);
+  size_t used = 0;
+  for (const RxDataset* const rx : m_rx_datasets) used += rx->size();
+  MessageValues values;
+  values["hits"]     = std::to_string(m_rx_dataset_hits);
+  values["misses"]   = std::to_string(m_rx_dataset_misses);
+  values["datasets"] = std::to_string(m_rx_datasets.size());
+  values["memory"]   = std::to_string(used);
+  send_stats("rx_dataset", values);
+}
+
+// starts background build of the next seed rx dataset with low priority threads
+// (rx config for its algo should be already applied)
+void Core::start_rx_precompute(
+  const std::string& algo, const std::string& key, const uint8_t* const seed,
+  const unsigned thread_count
+) {
+  if (m_rx_next && m_rx_next->key == key) return;
+  stop_rx_precompute();
+  if ((m_rx_build && m_rx_build->key == key) ||
+      std::find_if(m_rx_datasets.begin(), m_rx_datasets.end(),
+        [&key](const RxDataset* const rx) { return rx->key == key; }
+      ) != m_rx_datasets.end()) return;
+  RxDataset* rx = evict_rx_datasets(RANDOMX_CACHE_MAX_SIZE + RANDOMX_DATASET_MAX_SIZE);
+  if (rx == nullptr) rx = new RxDataset();
+  rx->key.clear();
+  try {
+    alloc_rx_dataset(rx, key);
+  } catch (const std::string& err) {
+    delete rx;
+    throw std::string("Can't precompute next rx dataset: ") + err;
+  }
+  m_rx_next = new RxDatasetBuild(rx, algo, key, seed, m_numa_cpus, m_is_rx_dataset_digest);
+  add_rx_build_threads(m_rx_next, thread_count, true);
+}
+
+// aborts background build of the next seed rx dataset and frees its memory
+void Core::stop_rx_precompute() {
+  if (m_rx_next == nullptr) return;
+  m_rx_next->is_abort = true;
+  for (auto& thread : m_rx_next->threads) thread.join();
+  delete m_rx_next->rx;
+  delete m_rx_next;
+  m_rx_next = nullptr;
+}
+
+// (re)allocates scratchpad arena only if it can't fit requested size
+void Core::reserve_arena(const size_t size) {
+  if (m_lpads && m_lpads->size() >= size) return;
+  free_memory(false, true, false, false, true); // drop everything that points into the old arena
+  m_lpads = alloc_huge_mem("arena", size);
+}
+
+// points first batch cn contexts to the arena creating missing ones
+void Core::setup_ctx(const unsigned batch, const unsigned mem_size) {
+  if (m_ctx_count < batch) {
+    cryptonight_ctx** const ctx = new cryptonight_ctx*[batch];
+    if (m_ctx) { std::copy(m_ctx, m_ctx + m_ctx_count, ctx); delete [] m_ctx; }
+    xmrig::CnCtx::create(ctx + m_ctx_count, m_lpads->scratchpad(), mem_size, batch - m_ctx_count);
+    m_ctx = ctx;
+    m_ctx_count = batch;
+  }
+  for (unsigned i = 0; i != batch; ++ i) {
+    m_ctx[i]->memory = m_lpads->scratchpad() + i * mem_size;
+    // force CnR code regeneration since memory layout could change
+    m_ctx[i]->generated_code_data.algo   = xmrig::Algorithm::INVALID;
+    m_ctx[i]->generated_code_data.height = std::numeric_limits<uint64_t>::max();
+  }
+}
+
+CnRProgram::CnRProgram(const uint64_t height, const xmrig::CnHash::AlgoVariant av)
+  : height(height), av(av), is_done(false), is_used(false), compile_us(0) {
+  code = static_cast<uint8_t*>(xmrig::VirtualMemory::allocateExecutableMemory(CN_R_CODE_SIZE, false));
+  if (code == nullptr) throw std::string("Can't allocate cn/r program memory");
+  thread = std::thread([this]() {
+    const uint64_t timestamp = get_timestamp_us();
+    is_used = xmrig::CnHash::compileR(this->height, this->av, xmrig::Assembly::AUTO, code);
+    xmrig::VirtualMemory::protectRX(code, CN_R_CODE_SIZE);
+    compile_us = get_timestamp_us() - timestamp;
+    is_done = true;
+  });
+}
+
+CnRProgram::~CnRProgram() {
+  wait();
+  xmrig::VirtualMemory::freeLargePagesMemory(code, CN_R_CODE_SIZE);
+}
+
+// points cn contexts to cn/r program of height (taking one compiled in background if it was
+// looked ahead) and starts background compile of the next height program
+void Core::set_cn_r_program(const uint64_t height, const xmrig::CnHash::AlgoVariant av) {
+  if (m_cn_r == nullptr || m_cn_r->height != height || m_cn_r->av != av) {
+    const char* lookahead = "miss";
+    delete m_cn_r;
+    if (m_cn_r_next && m_cn_r_next->height == height && m_cn_r_next->av == av) {
+      lookahead = m_cn_r_next->is_done ? "ready" : "wait";
+      m_cn_r = m_cn_r_next;
+      m_cn_r_next = nullptr;
+    } else m_cn_r = new CnRProgram(height, av);
+    if (strcmp(lookahead, "ready") != 0) ++ m_cn_r_waits;
+    m_cn_r->wait();
+    char compile_ms[32];
+    snprintf(compile_ms, sizeof(compile_ms), "%.3f", m_cn_r->compile_us / 1000.0);
+    MessageValues values;
+    values["height"]     = std::to_string(height);
+    values["lookahead"]  = lookahead;
+    values["compile_ms"] = compile_ms;
+    values["waits"]      = std::to_string(m_cn_r_waits);
+    send_stats("cn_r", values);
+  }
+  // hash fns that do not use generated code never touch these pointers
+  if (m_cn_r->is_used) for (unsigned i = 0; i != m_ctx_count; ++ i) {
+    m_ctx[i]->generated_code      = reinterpret_cast<cn_mainloop_fun_ms_abi>(m_cn_r->code);
+    m_ctx[i]->generated_math      = reinterpret_cast<cn_r_math_fun_ms_abi>(m_cn_r->code + CN_R_MATH_OFFSET);
+    m_ctx[i]->generated_code_data = { xmrig::Algorithm::CN_R, height };
+    m_ctx[i]->generated_math_data = { xmrig::Algorithm::CN_R, height };
+  }
+  if (m_cn_r_next == nullptr || m_cn_r_next->height != height + 1 || m_cn_r_next->av != av) {
+    delete m_cn_r_next;
+    m_cn_r_next = new CnRProgram(height + 1, av);
+  }
+}
+
+void Core::stop_cn_r_programs() {
+  delete m_cn_r;      m_cn_r      = nullptr;
+  delete m_cn_r_next; m_cn_r_next = nullptr;
+}
+
+GrTune::GrTune(const int64_t cpu, const int64_t helper_cpu, const std::vector<int64_t>& plan_cpus)
+  : cpu(cpu), helper_cpu(helper_cpu), plan_cpus(plan_cpus), is_done(false), tune_us(0) {
+  thread = std::thread([this]() {
+    const uint64_t timestamp = get_timestamp_us();
+    xmrig::ghostrider::benchmark(this->cpu, this->helper_cpu);
+    tune_us = get_timestamp_us() - timestamp;
+    is_done = true;
+  });
+}
+
+// starts background tune of ghostrider cn steps for the hashing cpu (once per cpu in a process) that hashing
+// waits for, helper thread on free SMT sibling of that cpu (not used by hashing threads of affinity plan) is
+// started by finish_gr_tune if gr_helper mode is "auto"
+void Core::set_gr_helper(const std::string& mode, const std::vector<int64_t>& plan_cpus) {
+  const int64_t cpu        = m_affinity.empty() ? -1 : m_affinity[0],
+                helper_cpu = mode == "auto" ? xmrig::ghostrider::find_helper_cpu(cpu, plan_cpus) : -1;
+  const std::string tune = std::to_string(cpu) + "/" + std::to_string(helper_cpu);
+  if (m_gr_tune == tune) return;
+  stop_gr_helper();
+  m_gr_tune_build = new GrTune(cpu, helper_cpu, plan_cpus);
+  m_gr_tune = tune;
+}
+
+// selects cached result of finished m_gr_tune_build for this thread and starts its helper thread
+void Core::finish_gr_tune() {
+  GrTune* const tune = m_gr_tune_build;
+  tune->thread.join();
+  xmrig::ghostrider::benchmark(tune->cpu, tune->helper_cpu);
+  if (tune->helper_cpu >= 0) m_gr_helper = xmrig::ghostrider::create_helper_thread(tune->cpu, -1, tune->plan_cpus);
+  gr_thread_helper = m_gr_helper;
+  char tune_ms[32];
+  snprintf(tune_ms, sizeof(tune_ms), "%.1f", tune->tune_us / 1000.0);
+  MessageValues values;
+  values["cpu"]     = tune->cpu < 0 ? std::string("any") : std::to_string(tune->cpu);
+  values["helper"]  = m_gr_helper ? std::to_string(tune->helper_cpu) : std::string("none");
+  values["steps"]   = xmrig::ghostrider::tune_info();
+  values["tune_ms"] = tune_ms;
+  send_stats("gr_tune", values);
+  delete tune;
+  m_gr_tune_build = nullptr;
+}
+
+void Core::stop_gr_helper() {
+  // tune can not be aborted (its result is still cached for later ghostrider jobs) so it is not waited for here
+  if (m_gr_tune_build) m_gr_tunes_stopped.push_back(m_gr_tune_build);
+  m_gr_tune_build = nullptr;
+  xmrig::ghostrider::destroy_helper_thread(m_gr_helper);
+  m_gr_helper = gr_thread_helper = nullptr;
+  m_gr_tune.clear();
+}
+
+// deletes stopped ghostrider tunes that are done (or all of them waiting for their tune threads if is_wait)
+void Core::reap_gr_tunes(const bool is_wait) {
+  for (auto i = m_gr_tunes_stopped.begin(); i != m_gr_tunes_stopped.end(); ) {
+    if (!is_wait && !(*i)->is_done) { ++ i; continue; }
+    delete *i;
+    i = m_gr_tunes_stopped.erase(i);
+  }
+}
+
 void Core::set_job(
   const bool is_set_nonce, const bool is_no_same_input, const MessageValues& v,
   std::function<void(void)> fn_extra_setup
@@ -145,11 +1135,13 @@ void Core::set_job(
   if (!v.contains("dev"))      throw std::string("Missing dev job key");
   if (!v.contains("algo"))     throw std::string("Missing algo job key");
   if (!v.contains("blob_hex")) throw std::string("Missing blob_hex job key");
+  select_kernel_modes(v); // only checks that job asks for kernel code selected for the process
 
   const std::string new_dev_str        = v.at("dev"),
                     new_algo_str       = v.at("algo"),
                     new_input_hex      = v.at("blob_hex"),
-                    new_seed_hex       = v.contains("seed_hex") ? v.at("seed_hex") : std::string();
+                    new_seed_hex       = v.contains("seed_hex") ? v.at("seed_hex") : std::string(),
+                    new_next_seed_hex  = v.contains("next_seed_hex") ? v.at("next_seed_hex") : std::string();
   const unsigned    new_height         = v.contains("height") ? atoi(v.at("height").c_str()) : 0,
                     new_thread_id      = v.contains("thread_id") ?
                                          atoi(v.at("thread_id").c_str()) : 0,
@@ -160,43 +1152,84 @@ void Core::set_job(
 		    new_nonce_offset   = v.contains("nonceoffset") ?
                                          atoi(v.at("nonceoffset").c_str()) : 39,
 		    new_c29_proof_size = v.contains("proofsize") ?
-                                         atoi(v.at("proofsize").c_str()) : 32;
+                                         atoi(v.at("proofsize").c_str()) : 32,
+                    new_precompute_threads = v.contains("rx_precompute_threads") ?
+                                         atoi(v.at("rx_precompute_threads").c_str()) : 0,
+                    new_light_threads  = v.contains("rx_light_threads") ?
+                                         atoi(v.at("rx_light_threads").c_str()) : 0;
   const uint64_t    new_nonce          = v.contains("nonce") ? strtoull(v.at("nonce").c_str(), NULL, 16) : 0,
                     new_nicehash_mask  = v.contains("nicehash_mask") ? strtoull(v.at("nicehash_mask").c_str(), NULL, 16) : 0;
 
   if (is_no_same_input && new_input_hex == m_input_hex) throw std::string("Ignore duplicate job");
+  std::vector<int> new_affinity; // cpus to pin hashing threads to
+  if (v.contains("affinity")) for (const auto& cpu : tokenize(v.at("affinity"), ':')) {
+    char* end;
+    const long n = strtol(cpu.c_str(), &end, 10);
+    if (*end || n < 0 || n > 0xFFFF) throw std::string("Bad affinity CPU");
+    new_affinity.push_back(n);
+  }
+  if (v.contains("rx_mode") && v.at("rx_mode") != "auto" && v.at("rx_mode") != "full" && v.at("rx_mode") != "light")
+    throw std::string("Bad rx_mode job key");
+  if (v.contains("rx_dataset_init") && v.at("rx_dataset_init") != "auto" &&
+      v.at("rx_dataset_init") != "avx2" && v.at("rx_dataset_init") != "scalar")
+    throw std::string("Bad rx_dataset_init job key");
+  if (v.contains("vaes") && v.at("vaes") != "auto" && v.at("vaes") != "off" &&
+      v.at("vaes") != "256" && v.at("vaes") != "512")
+    throw std::string("Bad vaes job key");
+  if (v.contains("keccak") && v.at("keccak") != "auto" && v.at("keccak") != "avx512" &&
+      v.at("keccak") != "avx2" && v.at("keccak") != "scalar")
+    throw std::string("Bad keccak job key");
+  if (v.contains("cn_final") && v.at("cn_final") != "auto" && v.at("cn_final") != "scalar")
+    throw std::string("Bad cn_final job key");
+  if (v.contains("gr_helper") && v.at("gr_helper") != "auto" && v.at("gr_helper") != "off")
+    throw std::string("Bad gr_helper job key");
+  if (v.contains("gr_core") && v.at("gr_core") != "auto" && v.at("gr_core") != "scalar")
+    throw std::string("Bad gr_core job key");
+  std::vector<int64_t> plan_cpus; // cpus of all hashing threads of this job
+  if (v.contains("affinity_plan")) for (const auto& cpus : tokenize(v.at("affinity_plan"), ','))
+    for (const auto& cpu : tokenize(cpus, ':')) plan_cpus.push_back(atoi(cpu.c_str()));
   auto batch_parts = tokenize(new_dev_str, '*');
   if (batch_parts.size() == 0 || batch_parts.size() > 2)
     throw std::string("Invalid dev specification");
   const std::string new_dev_str2 = batch_parts[0];
   const unsigned new_batch = batch_parts.size() == 2 ? atoi(batch_parts[1].c_str()) : 1;
-  const DEV new_dev = new_dev_str2 == "cpu" ?
+  // "cpui" rx threads interleave two vms each
+  const unsigned new_rx_thread_vms = new_dev_str2 == "cpui" ? 2 : 1;
+  const DEV new_dev = new_dev_str2 == "cpu" || new_dev_str2 == "cpui" ?
                       (new_algo_str.starts_with("rx/") ? DEV::RX_CPU : DEV::CPU) :
                       (new_algo_str.starts_with("c29") ? DEV::C29_GPU : DEV::GPU);
 
+  if (new_rx_thread_vms != 1 && new_dev != DEV::RX_CPU)
+    throw std::string("Interleaved cpui dev is only supported for rx algos");
+  if (new_batch % new_rx_thread_vms)
+    throw std::string("Invalid batch size for cpui dev. Should be even.");
+
   if (new_dev == DEV::C29_GPU && new_batch != 1)
     throw std::string("Invalid batch size for c29s algo. Should be 1.");
   if (new_nonce_bytes != 4 && new_nonce_bytes != 8)
     throw std::string("Only support 4 or 8 bytes long nonces");
 
+  const uint64_t switch_timestamp = get_timestamp_ms(), job_timestamp = get_timestamp_us();
   FN new_fn;
-  uint8_t new_seed[HASH_LEN];
+  xmrig::CnHash::AlgoVariant new_av = xmrig::CnHash::AV_AUTO;
+  uint8_t new_seed[HASH_LEN], new_next_seed[HASH_LEN];
   const RandomX_ConfigurationBase* new_rx_config;
   switch (new_dev) {
     case DEV::CPU: {
       const auto pi = cpu_name2algo.find(new_algo_str);
       if (pi == cpu_name2algo.end()) throw std::string("Unsupported algo");
       const auto new_algo = pi->second;
-      if (new_algo == xmrig::Algorithm::GHOSTRIDER_RTM) {
-        if (new_batch != 8) throw std::string("Bad CPU batch");
-        new_fn.cpu = ghostrider;
+      if (new_algo == xmrig::Algorithm::GHOSTRIDER_RTM) switch (new_batch) {
+        case 1: new_fn.cpu = ghostrider<1>; break;
+        case 2: new_fn.cpu = ghostrider<2>; break;
+        case 4: new_fn.cpu = ghostrider<4>; break;
+        case 8: new_fn.cpu = ghostrider<8>; break;
+        default: throw std::string("Bad CPU batch");
       } else {
         if (new_batch > MAX_CN_CPU_WAYS) throw std::string("Bad CPU batch");
-        new_fn.cpu = xmrig::CnHash::fn(
-          new_algo,
-          cpu_params2variant[new_batch - 1][ci.hasAES() ? 0 : 1],
-          xmrig::Assembly::AUTO
-        );
+        new_av = cpu_params2variant[new_batch - 1][ci.hasAES() ? 0 : 1];
+        new_fn.cpu = xmrig::CnHash::fn(new_algo, new_av, xmrig::Assembly::AUTO);
+        if (!new_fn.cpu) throw std::string("Bad CPU batch");
       }
       break;
     }
@@ -205,6 +1238,9 @@ void Core::set_job(
       if (new_seed_hex.empty()) throw std::string("No seed_hex job key");
       if (new_seed_hex.size() != HASH_LEN * 2) throw std::string("Bad seed length");
       if (!hex2bin(new_seed_hex.c_str(), HASH_LEN, new_seed)) throw std::string("Bad seed hex");
+      if (!new_next_seed_hex.empty() && (new_next_seed_hex.size() != HASH_LEN * 2 ||
+          !hex2bin(new_next_seed_hex.c_str(), HASH_LEN, new_next_seed)))
+        throw std::string("Bad next seed hex");
       const auto pi = rx_cpu_name2config.find(new_algo_str);
       if (pi == rx_cpu_name2config.end()) throw std::string("Unsupported algo");
       new_rx_config = pi->second;
@@ -235,76 +1271,76 @@ void Core::set_job(
     throw std::string("Bad input hex");
 
   // new hashing setup (all errors were checked above)
-  ++ m_job_ref; // used to stop old m_thread_pool jobs
+  ++ m_job_ref; // used to stop old c29 gpu jobs
+  // abort rx dataset build that is not needed anymore
+  if (m_rx_build && (new_dev != DEV::RX_CPU || m_rx_build->key != new_algo_str + "/" + new_seed_hex))
+    stop_rx_build();
+  if (m_affinity != new_affinity || m_dev != new_dev) {
+    if (m_affinity != new_affinity) stop_rx_threads(); // to restart them with the new affinity
+    m_affinity = new_affinity;
+    // cpu dev hashes in this thread, other devs only use it to process messages
+    const int cpu = new_dev == DEV::CPU && !m_affinity.empty() ? m_affinity[0] : -1;
+    if (!set_thread_affinity(cpu < 0 ? std::vector<int>() : std::vector<int>{ cpu }))
+      send_error("Can't pin compute thread to CPU " + std::to_string(cpu));
+    // memory allocated from this thread (rx datasets, scratchpad arena) prefers hashing cpus node
+    m_numa_node = xmrig::VirtualMemory::bindToNUMANode(m_affinity.empty() ? -1 : m_affinity[0]);
+    m_numa_cpus = m_affinity.empty() ? std::vector<int>() : get_numa_node_cpus(m_numa_node);
+  }
+  m_rx_dataset_budget = v.contains("rx_dataset_cache_mb") ?
+                        strtoull(v.at("rx_dataset_cache_mb").c_str(), NULL, 10) << 20 : 0;
+  if (m_rx_thread_vms != new_rx_thread_vms) {
+    stop_rx_threads(); // to restart them with the new vm split
+    m_rx_thread_vms = new_rx_thread_vms;
+  }
+  // light mode vms are given to whole rx threads
+  m_rx_light_threads  = std::min((new_light_threads + m_rx_thread_vms - 1) / m_rx_thread_vms * m_rx_thread_vms, new_batch);
+  m_is_rx_1gb_pages   = v.contains("rx_1gb_pages") && atoi(v.at("rx_1gb_pages").c_str()) != 0;
+  m_is_rx_shared      = v.contains("rx_shared_dataset") && atoi(v.at("rx_shared_dataset").c_str()) != 0;
+  m_rx_mode           = v.contains("rx_mode") ? v.at("rx_mode") : "auto";
+  m_rx_dataset_init   = v.contains("rx_dataset_init") ? v.at("rx_dataset_init") : "auto";
+  m_is_rx_dataset_digest = v.contains("rx_dataset_digest") && atoi(v.at("rx_dataset_digest").c_str()) != 0;
+  // memory cap is split between all processes of this dev
+  m_memory_cap        = v.contains("memory_cap_mb") ?
+                        (strtoull(v.at("memory_cap_mb").c_str(), NULL, 10) << 20) / std::max(new_thread_num, 1u) : 0;
   const unsigned new_mem_size = algo2mem.at(new_algo_str);
+  bool is_rx_switched = false;
   if (m_batch != new_batch || m_mem_size != new_mem_size ||
       m_seed_hex != new_seed_hex || m_algo_str != new_algo_str) {
-    // free previous memory
+    const bool is_layout_changed = m_mem_size != new_mem_size || m_algo_str != new_algo_str;
+    // free previous memory (except scratchpad arena that is reused)
     free_memory(
       m_batch != new_batch,
-      m_mem_size != new_mem_size,
+      is_layout_changed,
       m_seed_hex.empty() && !new_seed_hex.empty(),
-      !m_seed_hex.empty() && new_seed_hex.empty()
+      // rx datasets are kept for the next rx jobs if they have memory budget
+      !m_seed_hex.empty() && new_seed_hex.empty() && m_rx_dataset_budget == 0,
+      false
     );
+    // old rx threads are stopped by free_memory above in this case
+    if (m_batch != new_batch || is_layout_changed) m_switch_timestamp = switch_timestamp;
 
-    if (m_lpads == nullptr) m_lpads = alloc_huge_mem(new_batch * new_mem_size);
+    reserve_arena(std::max(
+      static_cast<size_t>(new_batch) * new_mem_size,
+      v.contains("arena_plan") ? arena_plan_size(v.at("arena_plan")) : 0
+    ));
 
     if (new_dev == DEV::RX_CPU) {
-      // setup rx cache, dataset and thread_pool
-      if (m_rx_cache_mem == nullptr)
-        m_rx_cache_mem = alloc_huge_mem(RANDOMX_CACHE_MAX_SIZE);
-      if (m_rx_dataset_mem == nullptr)
-        m_rx_dataset_mem = alloc_huge_mem(RANDOMX_DATASET_MAX_SIZE);
-      if (m_rx_cache == nullptr) {
-        m_rx_cache = randomx_create_cache(RANDOMX_FLAG_JIT, m_rx_cache_mem->raw());
-        if (m_rx_cache == nullptr) {
-          m_is_rx_jit = false;
-          m_rx_cache = randomx_create_cache(RANDOMX_FLAG_DEFAULT, m_rx_cache_mem->raw());
-        }
-      }
-      if (m_rx_dataset == nullptr)
-        m_rx_dataset = randomx_create_dataset(m_rx_dataset_mem->raw());
-      if (m_thread_pool == nullptr) {
-        m_thread_pool = new ctpl::thread_pool(new_batch);
-        if (!ci.hasAES()) SelectSoftAESImpl(new_batch);
-      }
-
-      // recompute cache, dataset for new seed
+      // switch to cached or newly computed rx cache, dataset for new seed
       if (m_seed_hex != new_seed_hex || m_algo_str != new_algo_str) {
-        randomx_apply_config(*new_rx_config);
-        randomx_init_cache(m_rx_cache, new_seed, HASH_LEN);
-        // init dataset in parallel threads
-        const unsigned rx_dataset_item_count = randomx_dataset_item_count(),
-                       thread_count          = std::thread::hardware_concurrency();
-        if (thread_count > 1) {
-          std::list<std::thread> threads;
-          for (unsigned i = 0; i < thread_count; ++i) {
-            const unsigned a = (rx_dataset_item_count * i) / thread_count,
-                           b = (rx_dataset_item_count * (i + 1)) / thread_count;
-            threads.emplace_back(init_rx_dataset_thread, m_rx_dataset, m_rx_cache, a, b - a);
-          }
-          for (auto& thread : threads) thread.join();
-        } else init_rx_dataset_thread(m_rx_dataset, m_rx_cache, 0, rx_dataset_item_count);
-      }
-
-      // recreate vms
-      if (m_vm == nullptr) {
-        m_vm = new randomx_vm*[new_batch];
-        for (unsigned i = 0; i != new_batch; ++ i) {
-          m_vm[i] = randomx_create_vm(
-            get_rx_vm_flags(m_is_rx_jit, m_rx_dataset, m_rx_dataset_mem), m_rx_cache, m_rx_dataset,
-            m_lpads->scratchpad() + i * new_mem_size, 0
-          );
-        }
+        stop_rx_threads(); // old rx threads can still use the current dataset
+        m_switch_timestamp = switch_timestamp;
+        // rx config is global so it can only be changed if next seed dataset is not computed
+        if (m_rx_next && m_rx_next->algo != new_algo_str) stop_rx_precompute();
+        if (m_rx_next == nullptr) randomx_apply_config(*new_rx_config);
+        // vms are switched to the new dataset here or once its m_rx_build is done
+        is_rx_switched = select_rx_dataset(new_algo_str, new_algo_str + "/" + new_seed_hex, new_seed);
       }
+      if (m_rx) setup_rx_vms(new_batch, new_mem_size);
     } else { // setup cn stuff
       if (m_input == nullptr) m_input = static_cast<uint8_t*>(alloc_mem(new_batch * MAX_BLOB_LEN));
       if (m_output == nullptr) m_output = static_cast<uint8_t*>(alloc_mem(new_batch * HASH_LEN));
       if (m_spads == nullptr) m_spads = alloc_mem(new_batch * SPAD_LEN);
-      if (m_ctx == nullptr) {
-        m_ctx = new cryptonight_ctx*[new_batch];
-        xmrig::CnCtx::create(m_ctx, m_lpads->scratchpad(), new_mem_size, new_batch);
-      }
+      setup_ctx(new_batch, new_mem_size);
     }
     if (m_algo_str != new_algo_str) set_fn(new_fn.any);
     m_batch    = new_batch;
@@ -322,74 +1358,45 @@ void Core::set_job(
   m_c29_proof_size = new_c29_proof_size;
   m_input_len      = new_input_len;
   m_nicehash_mask  = new_nicehash_mask;
+  if (new_dev == DEV::CPU && new_algo_str == "cn/r") set_cn_r_program(new_height, new_av);
+  if (new_dev == DEV::CPU && new_algo_str == "ghostrider") {
+    set_gr_helper(v.contains("gr_helper") ? v.at("gr_helper") : "auto", plan_cpus);
+    xmrig::ghostrider::select_rotation(new_input, gr_thread_rotation);
+  } else stop_gr_helper();
   fn_extra_setup();
 
-  // start rx job compute threads
-  if (new_dev == DEV::RX_CPU) {
-    // need static copy here so it will be alive in rx threads
-    static uint8_t new_input2[MAX_BLOB_LEN];
-    memcpy(new_input2, new_input, m_input_len);
-    const unsigned job_ref = m_job_ref;
-    const bool is_rx_v2 = new_algo_str == "rx/2";
-    for (unsigned batch_id = 0; batch_id != m_batch; ++batch_id) m_thread_pool->push(
-      [=, this, &m_job_ref = m_job_ref, &m_hash_count = m_hash_count](int) {
-        const unsigned thread_id = batch_id;
-        try {
-          alignas(16) uint8_t  input[MAX_BLOB_LEN];
-          alignas(16) uint8_t  output[HASH_LEN];
-          alignas(16) uint8_t  raw_hash[HASH_LEN];
-          alignas(16) uint8_t  prev_input[MAX_BLOB_LEN];
-          alignas(16) uint64_t temp_hash[8];
-          uint32_t nonce = new_nonce + new_thread_id * m_batch + batch_id;
-          if (m_nicehash_mask) nonce |= bswap_32(*get_nonce32(new_input2, 0)) & static_cast<uint32_t>(m_nicehash_mask);
-          const unsigned nonce_step = new_thread_num * m_batch;
-          unsigned hashrate_update_counter = HASHRATE_COUNTER_INTERVAL;
-          memcpy(input, new_input2, m_input_len);
-          if (is_set_nonce) { *get_nonce32(input, 0) = bswap_32(nonce); nonce += nonce_step; }
-          if (is_rx_v2) memcpy(prev_input, input, m_input_len);
-          randomx_calculate_hash_first(m_vm[thread_id], temp_hash, input, m_input_len);
-          while (job_ref == m_job_ref) { // continue until we get a new job
-            uint32_t* const pnonce = get_nonce32(input, 0);
-            const uint32_t prev_nonce = nonce;
-            *pnonce = bswap_32(nonce += nonce_step);
-	    // check that current nonce is greater than previous one and nince hash protected nonce part is not changed
-            if (m_target && ( m_nicehash_mask ? (prev_nonce & static_cast<uint32_t>(m_nicehash_mask)) != (nonce & static_cast<uint32_t>(m_nicehash_mask)) :
-                              prev_nonce > nonce )
-            ) {
-              send_error("Nonce overflow");
-              break; // will also effectively stops this thread
-            }
-            randomx_calculate_hash_next(m_vm[thread_id], temp_hash, input, m_input_len, output);
-            const uint8_t* commitment = nullptr;
-            if (is_rx_v2) {
-              memcpy(raw_hash, output, HASH_LEN);
-              randomx_calculate_commitment(prev_input, m_input_len, raw_hash, output);
-              memcpy(prev_input, input, m_input_len);
-              commitment = raw_hash;
-            }
-            if (!is_set_nonce) { // test job
-              char hash[HASH_LEN*2+1];
-              send_msg("test", "result", hash_bin2hex(output, hash));
-              break;
-            }
-            if (--hashrate_update_counter == 0) {
-              hashrate_update_counter = HASHRATE_COUNTER_INTERVAL;
-              m_mutex_hashrate.lock();
-              m_hash_count += HASHRATE_COUNTER_INTERVAL;
-              m_mutex_hashrate.unlock();
-            }
-            if (m_target && *get_result(output, 0) < m_target)
-              send_result(nonce - nonce_step, 4, output, nullptr, 32, commitment);
-          }
-          // only send for mine jobs
-          if (m_target) send_last_nonce(nonce, 4, m_pool_id);
-        } catch(const std::string& err) {
-          send_error(std::string("Compute function thread exception: ") + err);
-        } catch(...) {
-          send_error("Compute function thread exception");
-        }
-      }
+  if (new_dev == DEV::RX_CPU && !new_next_seed_hex.empty() && new_precompute_threads) try {
+    start_rx_precompute(
+      new_algo_str, new_algo_str + "/" + new_next_seed_hex, new_next_seed, new_precompute_threads
     );
+  } catch (const std::string& err) {
+    send_error(err);
+  }
+
+  // publish job to rx threads that are started now or once m_rx_build is done
+  if (new_dev == DEV::RX_CPU) {
+    auto job = std::make_shared<RxJob>();
+    memcpy(job->input, new_input, new_input_len);
+    job->input_len     = new_input_len;
+    job->nonce_offset  = new_nonce_offset;
+    job->nonce_step    = new_thread_num * m_batch;
+    job->nonce         = static_cast<uint32_t>(new_nonce + new_thread_id * m_batch);
+    job->nicehash_mask = static_cast<uint32_t>(new_nicehash_mask);
+    job->target        = m_target;
+    job->is_set_nonce  = is_set_nonce;
+    job->is_rx_v2      = new_algo_str == "rx/2";
+    job->algo          = new_algo_str;
+    job->pool_id       = m_pool_id;
+    job->worker_id     = m_worker_id;
+    job->job_id        = m_job_id;
+    // time switch of already running rx threads to the new mine job
+    m_job_timestamp = m_rx_thread_count && is_set_nonce ? job_timestamp : 0;
+    publish_rx_job(std::move(job));
+    if (m_rx_build == nullptr) {
+      start_rx_threads(m_batch);
+      // free unused datasets only after rx threads are restarted to not delay them
+      if (is_rx_switched) trim_rx_datasets();
+    } else if (m_rx_build->is_done()) finish_rx_build();
   } else {
     m_nonce_step = new_thread_num;
     for (unsigned i = 0; i != m_batch; ++i)
@@ -416,7 +1423,10 @@ void Core::get_algo_params(const MessageValues& v) {
   if (!v.contains("cpu_l3cache")) throw std::string("Missing cpu_l3cache algo_params key");
   const unsigned cpu_sockets = atoi(v.at("cpu_sockets").c_str()),
                  cpu_threads = atoi(v.at("cpu_threads").c_str()),
+                 cpu_l2cache = v.contains("cpu_l2cache") ? atoi(v.at("cpu_l2cache").c_str()) : 0,
                  cpu_l3cache = atoi(v.at("cpu_l3cache").c_str());
+  const size_t   memory_cap  = v.contains("memory_cap_mb") ?
+                               strtoull(v.at("memory_cap_mb").c_str(), NULL, 10) << 20 : 0;
   const auto& cpu_algo_keys = std::views::keys(cpu_name2algo);
   const auto& gpu_cn_algo_keys = std::views::keys(gpu_cn_algo2fn);
   const auto& gpu_c29_algo_keys = std::views::keys(gpu_c29_algo2fn);
@@ -427,10 +1437,65 @@ void Core::get_algo_params(const MessageValues& v) {
                               gpu_c29_algos = std::getenv("MOMINER_SKIP_SYCL_ALGO_PARAMS")
                                 ? std::set<std::string>{}
                                 : std::set<std::string>(gpu_c29_algo_keys.begin(), gpu_c29_algo_keys.end());
+  // algos with more than MAX_CN_CPU_WAYS_ALL_ALGOS hash ways
+  std::map<std::string, unsigned> algo2max_cpu_batch;
+  for (const auto& i : cpu_name2algo) {
+    if (!xmrig::Algorithm::isCN(i.second)) continue;
+    for (unsigned batch = MAX_CN_CPU_WAYS; batch > MAX_CN_CPU_WAYS_ALL_ALGOS; -- batch) {
+      if (!xmrig::CnHash::fn(i.second, cpu_params2variant[batch - 1][ci.hasAES() ? 0 : 1], xmrig::Assembly::AUTO))
+        continue;
+      algo2max_cpu_batch[i.first] = batch;
+      break;
+    }
+  }
   const std::map<std::string, std::string>& result_map = algo_params(
-    MAX_CN_CPU_WAYS, cpu_sockets, cpu_threads, cpu_l3cache, algo2mem, cpu_algos, gpu_cn_algos, gpu_c29_algos
+    MAX_CN_CPU_WAYS_ALL_ALGOS, algo2max_cpu_batch, cpu_sockets, cpu_threads, cpu_l2cache, cpu_l3cache,
+    memory_cap, RANDOMX_DATASET_MAX_SIZE + RANDOMX_CACHE_MAX_SIZE, RANDOMX_CACHE_MAX_SIZE,
+    algo2mem, cpu_algos, gpu_cn_algos, gpu_c29_algos
   );
   MessageValues result;
   for (const auto& i : result_map) result[i.first] = i.second;
   send_msg("algo_params", result);
 }
+
+// selects kernel code globals for vaes, keccak, cn_final and gr_core job keys of the first message that
+// initializes runtime of any compute core of the process (they are shared by all its in-process threads),
+// later calls only throw if v asks for other kernel code than the selected one
+void Core::select_kernel_modes(const MessageValues& v) {
+  MessageValues modes;
+  for (const char* const key : { "vaes", "keccak", "cn_final", "gr_core" })
+    modes[key] = v.contains(key) ? v.at(key) : "auto";
+  std::lock_guard<std::mutex> lock(kernel_modes_mutex);
+  if (!kernel_modes.empty()) {
+    for (const auto& i : modes) if (i.second != kernel_modes.at(i.first))
+      throw "Job " + i.first + " key \"" + i.second + "\" differs from \"" + kernel_modes.at(i.first) +
+            "\" kernel code selected for the process";
+    return;
+  }
+  kernel_modes = modes;
+  set_vaes_mode(modes.at("vaes"));
+  kernel_codes["keccak"]   = set_keccak_mode(modes.at("keccak"));
+  kernel_codes["cn_final"] = set_cn_final_mode(modes.at("cn_final"));
+  kernel_codes["gr_core"]  = set_gr_core_mode(modes.at("gr_core"));
+}
+
+// times kernel code that select_kernel_modes selected for the process from kernel_bench message keys and
+// reports it in <kernel> stats (used by kernel_bench directive of perf tests instead of timing it on each job)
+void Core::bench_kernel(const MessageValues& v) {
+  if (!v.contains("kernel")) throw std::string("Missing kernel kernel_bench key");
+  const std::string& kernel = v.at("kernel");
+  MessageValues values;
+  if (kernel == "keccak") {
+    char ns_per_state[32];
+    snprintf(ns_per_state, sizeof(ns_per_state), "%.1f", bench_keccak());
+    values["ns_per_state"] = ns_per_state;
+  } else if (kernel == "cn_final") {
+    values = bench_cn_final();
+  } else if (kernel == "gr_core") {
+    values = bench_gr_core();
+  } else throw std::string("Bad kernel kernel_bench key");
+  { std::lock_guard<std::mutex> lock(kernel_modes_mutex);
+    values["code"] = kernel_codes.at(kernel);
+  }
+  send_stats(kernel, values);
+}
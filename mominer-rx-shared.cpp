@@ -0,0 +1,192 @@
+// Copyright GNU GPLv3 (c) 2026-2026 MoneroOcean <support@moneroocean.stream>
+
+// RxSharedDataset segments of rx datasets shared by processes of this host (see mominer-core.h)
+
+#include "mominer-core.h"
+
+#include <cstdlib>
+#include <cstring>
+#include <mutex>
+#include <new>
+#include <set>
+#if defined(__linux__)
+#include <cerrno>
+#include <dirent.h>
+#include <fcntl.h>
+#include <signal.h>
+#include <sys/file.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+#if defined(__linux__)
+// RxSharedDataset segment starts with this header padded to huge page size
+struct RxSharedHeader {
+  uint64_t magic;
+  uint64_t dataset_size;
+  std::atomic<int32_t>  builder_pid; // 0 if the build was aborted and can be taken over
+  std::atomic<uint32_t> is_ready;
+};
+static const uint64_t RX_SHARED_MAGIC = 0x31305852494D4F4DULL; // "MOMIRX01"
+static const size_t   RX_SHARED_HEADER_SIZE = xmrig::VirtualMemory::kDefaultHugePageSize;
+static const char* const RX_SHARED_DIRS[] = { "/dev/hugepages", "/dev/shm" };
+static const char* const RX_SHARED_PREFIX = "mominer-rx-";
+
+// segments used by this process (to release them if it exits without their destructors, like
+// cluster worker process that exits once master process disconnects)
+static std::mutex rx_shared_mutex;
+static std::set<RxSharedDataset*> rx_shared_all;
+static bool is_rx_shared_atexit = false;
+
+static RxSharedDataset* add_rx_shared(RxSharedDataset* const shared) {
+  std::lock_guard<std::mutex> lock(rx_shared_mutex);
+  if (!is_rx_shared_atexit) is_rx_shared_atexit = std::atexit(RxSharedDataset::release_all) == 0;
+  rx_shared_all.insert(shared);
+  return shared;
+}
+
+// the last process that uses the segment removes it (if it was not replaced already)
+static void unlink_rx_shared(const std::string& path, const int fd) {
+  struct stat fd_st, path_st;
+  if (flock(fd, LOCK_EX | LOCK_NB) == 0 && fstat(fd, &fd_st) == 0 && stat(path.c_str(), &path_st) == 0 &&
+      fd_st.st_dev == path_st.st_dev && fd_st.st_ino == path_st.st_ino) unlink(path.c_str());
+}
+
+// removes segments (and temporary files) that are not locked by any process anymore
+// (left after crashes since the last process that uses segment removes it normally)
+static void remove_stale_rx_shared() {
+  for (const char* const dir_path : RX_SHARED_DIRS) {
+    DIR* const dir = opendir(dir_path);
+    if (!dir) continue;
+    while (const dirent* const entry = readdir(dir)) {
+      if (strncmp(entry->d_name, RX_SHARED_PREFIX, strlen(RX_SHARED_PREFIX))) continue;
+      const std::string path = std::string(dir_path) + "/" + entry->d_name;
+      const int fd = open(path.c_str(), O_RDONLY | O_CLOEXEC);
+      if (fd < 0) continue;
+      if (flock(fd, LOCK_EX | LOCK_NB) == 0) unlink(path.c_str());
+      close(fd);
+    }
+    closedir(dir);
+  }
+}
+
+// maps published segment read only (except its header) for rx dataset of dataset_size
+static RxSharedDataset* attach_rx_shared(
+  const std::string& path, const int fd, const size_t mem_size, const size_t dataset_size
+) {
+  struct stat st;
+  void* mem = MAP_FAILED;
+  if (flock(fd, LOCK_SH) == 0 && fstat(fd, &st) == 0 && static_cast<size_t>(st.st_size) == mem_size)
+    mem = mmap(nullptr, mem_size, PROT_READ, MAP_SHARED, fd, 0);
+  if (mem == MAP_FAILED) { close(fd); return nullptr; }
+  const RxSharedHeader* const header = static_cast<const RxSharedHeader*>(mem);
+  if (header->magic != RX_SHARED_MAGIC || header->dataset_size != dataset_size ||
+      mprotect(mem, RX_SHARED_HEADER_SIZE, PROT_READ | PROT_WRITE) != 0) {
+    munmap(mem, mem_size);
+    close(fd);
+    return nullptr;
+  }
+  return add_rx_shared(new RxSharedDataset(
+    path, fd, static_cast<uint8_t*>(mem), mem_size, path.starts_with(RX_SHARED_DIRS[0]), false
+  ));
+}
+
+RxSharedDataset* RxSharedDataset::open(const std::string& name, const size_t dataset_size) {
+  const size_t mem_size = RX_SHARED_HEADER_SIZE + xmrig::VirtualMemory::align(dataset_size);
+  for (const char* const dir : RX_SHARED_DIRS) {
+    const std::string path = std::string(dir) + "/" + RX_SHARED_PREFIX + name;
+    const int fd = ::open(path.c_str(), O_RDWR | O_CLOEXEC);
+    if (fd >= 0) return attach_rx_shared(path, fd, mem_size, dataset_size);
+  }
+  remove_stale_rx_shared();
+  // segment is initialized under temporary name and then published by link that fails if
+  // another process was faster, so other processes never see half initialized segments
+  for (const char* const dir : RX_SHARED_DIRS) {
+    const std::string path     = std::string(dir) + "/" + RX_SHARED_PREFIX + name,
+                      tmp_path = path + "." + std::to_string(getpid()) + "." + std::to_string(syscall(SYS_gettid));
+    const int fd = ::open(tmp_path.c_str(), O_RDWR | O_CREAT | O_EXCL | O_CLOEXEC, 0600);
+    if (fd < 0) continue;
+    void* mem = MAP_FAILED;
+    if (flock(fd, LOCK_SH) == 0 && ftruncate(fd, mem_size) == 0)
+      mem = mmap(nullptr, mem_size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    if (mem == MAP_FAILED) { // no free huge pages in hugetlbfs for example
+      unlink(tmp_path.c_str());
+      close(fd);
+      continue;
+    }
+    RxSharedHeader* const header = new (mem) RxSharedHeader;
+    header->magic        = RX_SHARED_MAGIC;
+    header->dataset_size = dataset_size;
+    header->builder_pid  = getpid();
+    header->is_ready     = 0;
+    const int link_errno = link(tmp_path.c_str(), path.c_str()) == 0 ? 0 : errno;
+    unlink(tmp_path.c_str());
+    if (link_errno == 0)
+      return add_rx_shared(new RxSharedDataset(path, fd, static_cast<uint8_t*>(mem), mem_size, dir == RX_SHARED_DIRS[0], true));
+    munmap(mem, mem_size);
+    close(fd);
+    if (link_errno != EEXIST) return nullptr;
+    const int fd2 = ::open(path.c_str(), O_RDWR | O_CLOEXEC);
+    return fd2 < 0 ? nullptr : attach_rx_shared(path, fd2, mem_size, dataset_size);
+  }
+  return nullptr;
+}
+
+RxSharedDataset::~RxSharedDataset() {
+  {
+    std::lock_guard<std::mutex> lock(rx_shared_mutex);
+    rx_shared_all.erase(this);
+  }
+  RxSharedHeader* const header = reinterpret_cast<RxSharedHeader*>(mem);
+  if (is_owner && !is_ready()) header->builder_pid = 0; // let waiting processes finish the build
+  munmap(mem, mem_size);
+  unlink_rx_shared(path, fd);
+  close(fd);
+}
+
+// closes segments of this process before it exits (each segment fd holds its own lock, so
+// only the last one of several fds of the same segment can remove it)
+void RxSharedDataset::release_all() {
+  std::lock_guard<std::mutex> lock(rx_shared_mutex);
+  for (RxSharedDataset* const shared : rx_shared_all) {
+    unlink_rx_shared(shared->path, shared->fd);
+    close(shared->fd);
+    shared->fd = -1; // in case its destructor still runs
+  }
+  rx_shared_all.clear();
+}
+
+uint8_t* RxSharedDataset::dataset() const { return mem + RX_SHARED_HEADER_SIZE; }
+
+bool RxSharedDataset::is_ready() const {
+  return reinterpret_cast<const RxSharedHeader*>(mem)->is_ready.load(std::memory_order_acquire);
+}
+
+void RxSharedDataset::set_ready() {
+  reinterpret_cast<RxSharedHeader*>(mem)->is_ready.store(1, std::memory_order_release);
+}
+
+// makes this process the builder if the current one exited or aborted the build
+bool RxSharedDataset::take_over() {
+  RxSharedHeader* const header = reinterpret_cast<RxSharedHeader*>(mem);
+  int32_t pid = header->builder_pid;
+  if (pid != 0 && (kill(pid, 0) == 0 || errno != ESRCH)) return false;
+  if (!header->builder_pid.compare_exchange_strong(pid, getpid())) return false;
+  if (mprotect(dataset(), mem_size - RX_SHARED_HEADER_SIZE, PROT_READ | PROT_WRITE) != 0) {
+    header->builder_pid = 0;
+    return false;
+  }
+  is_owner = true;
+  return true;
+}
+#else
+RxSharedDataset* RxSharedDataset::open(const std::string&, size_t) { return nullptr; }
+RxSharedDataset::~RxSharedDataset() {}
+void RxSharedDataset::release_all() {}
+uint8_t* RxSharedDataset::dataset() const { return mem; }
+bool RxSharedDataset::is_ready() const { return false; }
+void RxSharedDataset::set_ready() {}
+bool RxSharedDataset::take_over() { return false; }
+#endif
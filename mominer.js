@@ -20,6 +20,7 @@ let compute_core = null;
 let algo_params_bench_cb = null; // used to record algo_params bench data
 let last_job = null;
 let directive = null;
+let kernel = null; // kernel name of kernel_bench directive
 let test = {
   result_hash_hex: null,
   thread_tested:   0,
@@ -27,6 +28,8 @@ let test = {
 };
 let thread_hashrates = {};
 let is_exiting = false;
+let cpu_topology; // detected on the first use
+let last_affinity_plan = "";
 
 const WORKER_CLOSE_GRACE_MS = 3000;
 const PROCESS_EXIT_GRACE_MS = 5000;
@@ -74,7 +77,7 @@ function exit(code, force = directive === "mine" || directive === "bench") {
   }
   h.closeWorkers(force ? WORKER_CLOSE_GRACE_MS : null);
   process.exitCode = code;
-  if (directive === "test" || directive === "algo_params") {
+  if (directive === "test" || directive === "algo_params" || directive === "kernel_bench") {
     reallyExit(code);
   } else if (force) {
     setTimeout(function() {
@@ -138,6 +141,11 @@ function parse_args() {
     case "algo_params":
       break;
 
+    case "kernel_bench":
+      if (args.length < 1) return o.print_help("Directive \"kernel_bench\" needs one parameter");
+      kernel = args.shift();
+      break;
+
     default: return o.print_help("Unknown directive " + directive);
   }
 
@@ -219,6 +227,12 @@ function messageHandler(msg) {
       }
       break;
 
+    case "stats":
+      h.log1("Compute core " + msg.thread_id + " " + msg.value.name + " stats: " +
+             Object.entries(msg.value).filter(([key]) => key !== "name")
+                   .map(([key, value]) => key + "=" + value).join(", "));
+      break;
+
     case "error":
       if (msg.value.message === "Ignore duplicate job") return;
       h.log_err("Compute core error: " + JSON.stringify(msg.value));
@@ -230,6 +244,18 @@ function messageHandler(msg) {
   }
 }
 
+// adds CPU affinity plan of job threads to the job and reports it if it is changed
+function add_affinity_plan(job) {
+  if (cpu_topology === undefined) cpu_topology = global.opt.job.cpu_affinity ? h.detect_cpu_topology() : null;
+  job.affinity_plan = h.get_affinity_plan(job.dev, job.algo.startsWith("rx/"), cpu_topology);
+  if (job.affinity_plan !== last_affinity_plan && /\d/.test(job.affinity_plan)) h.log(
+    "Algo " + job.algo + " (" + job.dev + ") CPU affinity plan: " +
+    job.affinity_plan.split(",").map((cpus) => cpus ? cpus.replaceAll(":", " ") : "-").join(", ")
+  );
+  last_affinity_plan = job.affinity_plan;
+  return job;
+}
+
 function set_algo_msr(algo) {
   if (Object.keys(global.opt.default_msrs).length && compute_core) {
     let default_msr = h.pack_msr(global.opt.default_msrs);
@@ -245,13 +271,15 @@ function set_job(prev_job) {
   if (algo.startsWith("c29") || algo === "cuckaroo") algo = "c29";
   const dev = algo in global.opt.algo_params && global.opt.algo_params[algo].dev ?
               global.opt.algo_params[algo].dev : global.opt.job.dev;
-  if (!last_job || last_job.algo !== algo || last_job.dev !== dev)
-    h.recreate_threads(dev, messageHandler);
+  if (!last_job || (last_job.dev !== dev || last_job.algo !== algo) &&
+                   !h.is_same_threads(last_job.algo, last_job.dev, algo, dev))
+    h.recreate_threads(algo, dev, messageHandler);
   const pool_id = global.opt.pool_ids.active;
   let job = {
     algo:       algo,
     dev:        dev,
     seed_hex:   prev_job.seed_hash ? prev_job.seed_hash : prev_job.seed_hex,
+    next_seed_hex: prev_job.next_seed_hash ? prev_job.next_seed_hash : prev_job.next_seed_hex,
     target:     prev_job.target ? prev_job.target : h.diff2target(prev_job.difficulty),
     worker_id:  prev_job.id     ? prev_job.id     : (prev_job.worker_id ? prev_job.worker_id : global.opt.pools[pool_id].worker_id),
     job_id:     prev_job.job_id ? prev_job.job_id : "",
@@ -259,6 +287,21 @@ function set_job(prev_job) {
     height:     prev_job.height ? prev_job.height : 0,
     thread_num: h.get_dev_threads(dev),
     pool_id:    pool_id,
+    arena_plan: h.get_arena_plan(global.opt.algo_params, algo, dev),
+    rx_dataset_cache_mb: global.opt.job.rx_dataset_cache_mb,
+    rx_precompute_threads: global.opt.job.rx_precompute_threads,
+    rx_light_threads: global.opt.job.rx_light_threads,
+    rx_1gb_pages: global.opt.job.rx_1gb_pages,
+    rx_shared_dataset: global.opt.job.rx_shared_dataset,
+    rx_mode: global.opt.job.rx_mode,
+    rx_dataset_init: global.opt.job.rx_dataset_init,
+    rx_dataset_digest: global.opt.job.rx_dataset_digest,
+    vaes: global.opt.job.vaes,
+    keccak: global.opt.job.keccak,
+    cn_final: global.opt.job.cn_final,
+    gr_helper: global.opt.job.gr_helper,
+    gr_core: global.opt.job.gr_core,
+    memory_cap_mb: global.opt.job.memory_cap_mb,
   };
   if (algo === "c29") {
     job.proofsize     = prev_job.proofsize ? prev_job.proofsize : 42;
@@ -295,7 +338,7 @@ function set_job(prev_job) {
     job.nonce = prev_job.nonce ? prev_job.nonce : (last_job_can_be_used && last_job.nonce ? last_job.nonce : "0");
   }
   set_algo_msr(algo);
-  h.messageWorkers({type: "job", job: last_job = job});
+  h.messageWorkers({type: "job", job: last_job = add_affinity_plan(job)});
   return job;
 }
 
@@ -306,15 +349,27 @@ function bench_algo(algo, cb) {
     blob_hex: global.opt.job.blob_hex,
     seed_hex: global.opt.job.seed_hex,
     pool_id:  "", // to drop last nonce messages from this job
+    rx_dataset_cache_mb: global.opt.job.rx_dataset_cache_mb,
+    rx_1gb_pages: global.opt.job.rx_1gb_pages,
+    rx_shared_dataset: global.opt.job.rx_shared_dataset,
+    rx_mode: global.opt.job.rx_mode,
+    rx_dataset_init: global.opt.job.rx_dataset_init,
+    rx_dataset_digest: global.opt.job.rx_dataset_digest,
+    vaes: global.opt.job.vaes,
+    keccak: global.opt.job.keccak,
+    cn_final: global.opt.job.cn_final,
+    gr_helper: global.opt.job.gr_helper,
+    gr_core: global.opt.job.gr_core,
+    memory_cap_mb: global.opt.job.memory_cap_mb,
   };
-  h.recreate_threads(job.dev, messageHandler);
+  h.recreate_threads(job.algo, job.dev, messageHandler);
   let timeout = setTimeout(function() {
     h.log_err("Benchmark " + algo + " algo (" + job.dev + ") timeout");
     return cb(0);
   }, 2*60*1000);
   algo_params_bench_cb = function(hashrate) { clearTimeout(timeout); return cb(hashrate) };
   set_algo_msr(algo);
-  h.messageWorkers({type: "bench", job: last_job = job});
+  h.messageWorkers({type: "bench", job: last_job = add_affinity_plan(job)});
 }
 
 // do global.opt.algo_params benchmarks if perf === null
@@ -391,6 +446,7 @@ function detect_cpu() {
   const fallback = {
     cpu_sockets: 1,
     cpu_threads: os.cpus().length || 1,
+    cpu_l2cache: 0,
     cpu_l3cache: 0,
   };
   if (process.platform === "win32" || !fs.existsSync("/proc/cpuinfo")) return fallback;
@@ -400,7 +456,8 @@ function detect_cpu() {
   const physical_ids = new Set();
   for (const match of cpuinfo.matchAll(/^physical id\s*:\s*(.+)$/gm)) physical_ids.add(match[1]);
 
-  let l3cache = 0;
+  // l3cache is total L3 size, l2cache is the smallest L2 share of one CPU (L2 size / CPUs sharing it)
+  let l3cache = 0, l2cache = 0;
   const l3_ids = new Set();
   for (const index of fs.readdirSync("/sys/devices/system/cpu").filter((name) => /^cpu\d+$/.test(name))) {
     const cache_dir = `/sys/devices/system/cpu/${index}/cache`;
@@ -409,13 +466,20 @@ function detect_cpu() {
       try {
         const base = `${cache_dir}/${entry}`;
         if (fs.readFileSync(`${base}/type`, "utf8").trim() !== "Unified") continue;
-        if (fs.readFileSync(`${base}/level`, "utf8").trim() !== "3") continue;
+        const level = fs.readFileSync(`${base}/level`, "utf8").trim();
+        if (level !== "2" && level !== "3") continue;
         const size = fs.readFileSync(`${base}/size`, "utf8").trim().match(/^(\d+)([KMG])$/i);
         if (!size) continue;
         const id = fs.existsSync(`${base}/shared_cpu_list`) ? fs.readFileSync(`${base}/shared_cpu_list`, "utf8").trim() : base;
+        const multiplier = { K: 1024, M: 1024 * 1024, G: 1024 * 1024 * 1024 }[size[2].toUpperCase()];
+        if (level === "2") {
+          const cpus = id === base ? 1 : h.get_dev_cpus("@" + id.replace(/,/g, ":")).length || 1;
+          const share = Math.floor(Number(size[1]) * multiplier / cpus);
+          l2cache = l2cache ? Math.min(l2cache, share) : share;
+          continue;
+        }
         if (l3_ids.has(id)) continue;
         l3_ids.add(id);
-        const multiplier = { K: 1024, M: 1024 * 1024, G: 1024 * 1024 * 1024 }[size[2].toUpperCase()];
         l3cache += Number(size[1]) * multiplier;
       } catch (_) {}
     }
@@ -424,6 +488,7 @@ function detect_cpu() {
   return {
     cpu_sockets: physical_ids.size || 1,
     cpu_threads: processor_count || fallback.cpu_threads,
+    cpu_l2cache: l2cache,
     cpu_l3cache: l3cache,
   };
 }
@@ -462,19 +527,19 @@ switch (directive) {
       });
       compute_core.emit_to("read_msr", h.pack_msr(global.opt.default_msrs));
     });
-    compute_core.emit_to("algo_params", detect_cpu());
+    compute_core.emit_to("algo_params", { ...detect_cpu(), memory_cap_mb: global.opt.job.memory_cap_mb });
     break;
 
   case "test":
-    h.recreate_threads(global.opt.job.dev, messageHandler);
-    h.messageWorkers({type: "test", job: global.opt.job});
+    h.recreate_threads(global.opt.job.algo, global.opt.job.dev, messageHandler);
+    h.messageWorkers({type: "test", job: add_affinity_plan(global.opt.job)});
     break;
 
   case "bench":
     install_exit_handlers();
-    h.recreate_threads(global.opt.job.dev, messageHandler);
+    h.recreate_threads(global.opt.job.algo, global.opt.job.dev, messageHandler);
     if (!use_msr_tuning()) {
-      h.messageWorkers({type: "bench", job: last_job = global.opt.job});
+      h.messageWorkers({type: "bench", job: last_job = add_affinity_plan(global.opt.job)});
       break;
     }
     compute_core = h.create_core();
@@ -482,11 +547,11 @@ switch (directive) {
     compute_core.from.on("read_msr", function(v) {
       global.opt.default_msrs = h.unpack_msr(v); // to restore them on exit
       set_algo_msr(global.opt.job.algo);
-      h.messageWorkers({type: "bench", job: last_job = global.opt.job});
+      h.messageWorkers({type: "bench", job: last_job = add_affinity_plan(global.opt.job)});
     });
     compute_core.from.on("error", function(v) {
       h.log("Can't access MSR: " + JSON.stringify(v.message));
-      h.messageWorkers({type: "bench", job: last_job = global.opt.job});
+      h.messageWorkers({type: "bench", job: last_job = add_affinity_plan(global.opt.job)});
     });
     compute_core.emit_to("read_msr", h.pack_msr(global.opt.default_msrs));
     break;
@@ -501,6 +566,23 @@ switch (directive) {
     compute_core.from.on("error", function(v) {
       err_exit("Can't detect algo params: " + JSON.stringify(v.message ? v.message : v));
     });
-    compute_core.emit_to("algo_params", detect_cpu());
+    compute_core.emit_to("algo_params", { ...detect_cpu(), memory_cap_mb: global.opt.job.memory_cap_mb });
+    break;
+
+  case "kernel_bench":
+    compute_core = h.create_core();
+    compute_core.from.on("close", function() { process.exitCode = 0; });
+    compute_core.from.on("stats", function(v) {
+      fs.writeSync(1, v.name + " stats: " + Object.entries(v).filter(([key]) => key !== "name")
+                                               .map(([key, value]) => key + "=" + value).join(", ") + "\n");
+      exit(0);
+    });
+    compute_core.from.on("error", function(v) {
+      err_exit("Can't bench " + kernel + " kernel: " + JSON.stringify(v.message ? v.message : v));
+    });
+    compute_core.emit_to("kernel_bench", {
+      kernel: kernel, vaes: global.opt.job.vaes, keccak: global.opt.job.keccak, cn_final: global.opt.job.cn_final,
+      gr_core: global.opt.job.gr_core
+    });
     break;
 }
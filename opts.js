@@ -21,9 +21,10 @@ module.exports.pool_create = function(url, port, is_tls, login, pass) {
   };
 };
 
-const dev_help = 'device config line "[<dev>[*B][^P],]+", dev = ' +
-                 '{cpu, gpu<N>, cpu<N>}, ' +
-                 'N = device number, B = hash batch size, P = number of parallel processes';
+const dev_help = 'device config line "[<dev>[*B][^P][@C],]+", dev = ' +
+                 '{cpu, cpui, gpu<N>, cpu<N>}, cpui = cpu with two interleaved rx vms per hashing thread (even B), ' +
+                 'N = device number, B = hash batch size, P = number of parallel processes, ' +
+                 'C = "<cpu>[-<cpu>][:...]" list of CPUs to pin cpu hashing threads to';
 
 module.exports.opt_help = {
   job: {
@@ -36,6 +37,38 @@ module.exports.opt_help = {
     seed_hex: [ "3132333435363738393031323334353637383930313233343536373839303132",
                 'hexadecimal string of seed hash blob (used for rx algos)' ],
     height:   [ 0, "Block height used by some algos"],
+    rx_dataset_cache_mb: [ 0, 'memory budget (in MB) to keep recently used rx datasets ' +
+                              'for fast seed/algo switches (0 to keep only the current one)' ],
+    rx_precompute_threads: [ 0, 'number of low priority threads to precompute the next seed rx dataset ' +
+                                'announced by the pool (0 to disable, needs memory for one more dataset)' ],
+    rx_light_threads: [ 0, 'number of rx job threads to hash in slower light mode while rx dataset ' +
+                           'is built (0 to wait for the dataset)' ],
+    rx_1gb_pages: [ 0, 'allocate rx datasets on 1GB huge pages if CPU supports them and they are ' +
+                       'reserved (1 to enable)' ],
+    rx_shared_dataset: [ 0, 'share rx datasets between compute core processes of this host through ' +
+                            'hugetlbfs or /dev/shm segments so only one of them builds each dataset (1 to enable)' ],
+    rx_mode: [ "auto", 'rx dataset mode: "full", "light" (slower hashing that only needs 256 MB rx cache) ' +
+                       'or "auto" to use light mode only if there is no free memory for the full one' ],
+    rx_dataset_init: [ "auto", 'rx dataset init code: "avx2", "scalar" or "auto" to use the widest of ' +
+                               'AVX-512/AVX2 code that CPU supports (scalar on Windows)' ],
+    rx_dataset_digest: [ 0, 'report blake2b digest of built rx datasets in rx_build stats to compare ' +
+                            'rx dataset init code (1 to enable)' ],
+    vaes: [ "auto", 'VAES code of CryptoNight scratchpad explode/implode and RandomX scratchpad hash/fill: ' +
+                    '"512", "256", "off" or "auto" to pick it by CPU flags' ],
+    keccak: [ "auto", 'multi-buffer keccak code of CryptoNight hash ways: "avx512", "avx2", "scalar" or ' +
+                      '"auto" to use the widest of AVX-512/AVX2 code that CPU supports' ],
+    cn_final: [ "auto", 'multi-buffer code of blake256/jh/skein finalizer hashes of CryptoNight hash ways: ' +
+                        '"scalar" or "auto" to use AVX2 code if CPU supports it' ],
+    gr_helper: [ "auto", 'GhostRider helper thread that hashes half of ways on free SMT sibling of pinned ' +
+                         'hashing CPU: "off" or "auto" to use it where per CPU tuning finds it faster' ],
+    gr_core: [ "auto", 'multi-buffer code of GhostRider core hashes of lanes: "scalar" or "auto" to use ' +
+                       'AVX2/AVX-512 code if CPU supports it' ],
+    memory_cap_mb: [ 0, 'memory cap (in MB) for all compute core processes that is used to plan rx batches ' +
+                        'and select rx mode (0 for no cap)' ],
+    in_process_threads: [ 0, 'run ^P parallel processes of CPU only dev (except rx algo ones) as compute ' +
+                             'core threads of the main process (1 to enable)' ],
+    cpu_affinity: [ 1, 'pin cpu hashing threads without dev @C list to CPUs planned from ' +
+                       'cache/SMT topology (0 to disable)' ],
   },
   pool_time: {
     _help:             'JSON string of pool related timings (in seconds)',
@@ -178,6 +211,7 @@ Directives:
   test  <algo> <result_hash_hex_str>
   bench <algo>
   algo_params
+  kernel_bench <kernel>
 
 Options:`;
   console.log(str);
@@ -56,8 +56,9 @@ sycl::device get_dev(const std::string& dev_str) {
 
 // return list of supported algos with the best device config
 std::map<std::string, std::string> algo_params(
-  const unsigned max_cpu_batch,
-  const unsigned cpu_sockets, const unsigned cpu_threads, const unsigned cpu_l3cache,
+  const unsigned max_cpu_batch, const std::map<std::string, unsigned>& algo2max_cpu_batch,
+  const unsigned cpu_sockets, const unsigned cpu_threads, const unsigned cpu_l2cache, const unsigned cpu_l3cache,
+  const size_t memory_cap, const size_t rx_full_mem, const size_t rx_light_mem,
   const std::map<std::string, unsigned>& algo2mem,
   const std::set<std::string>& cpu_algos,
   const std::set<std::string>& gpu_cn_algos,
@@ -91,20 +92,49 @@ std::map<std::string, std::string> algo_params(
           // for each CPU socket we start separate process (named "threads" here)
           // normally we only want one separate process per socket
           // to reduce memory usage per process (2GB) and amount of huge pages too
-          const unsigned batch = std::max(1u, std::min(thread_count, l3cache / batch_mem) / socket_count);
+          unsigned batch = std::max(1u, std::min(thread_count, l3cache / batch_mem) / socket_count);
+          if (memory_cap) {
+            // each process needs its rx dataset (or only cache in light mode) and batch scratchpads
+            const size_t process_mem = memory_cap / socket_count,
+                         fixed_mem   = process_mem >= rx_full_mem + batch_mem ? rx_full_mem : rx_light_mem;
+            const size_t max_batch   = process_mem > fixed_mem ? (process_mem - fixed_mem) / batch_mem : 0;
+            batch = std::max<size_t>(1, std::min<size_t>(batch, max_batch));
+          }
           for (unsigned i = 0; i != socket_count; ++i) {
             threads.push_back(batch);
           }
         } else {
+          // ghostrider thread hashes up to 8 lanes with up to 4 way cn steps of 512 KB scratchpads, so each
+          // lane needs 256 KB of L3 cache: lanes are halved until lanes of all CPU threads fit into L3 cache
+          // (4 threads with 4 MB of L3 cache get cpu*4 each for example)
+          unsigned lanes = 8;
+          if (algo == "ghostrider")
+            while (lanes > 1 && static_cast<size_t>(thread_count) * (lanes << 18) > l3cache) lanes >>= 1;
+          const unsigned thread_mem = algo == "ghostrider" ? lanes << 18 : batch_mem;
           // fill threads list with single batch
-          while (++used_threads <= thread_count && (used_l3cache += batch_mem) <= l3cache)
-            threads.push_back(algo == "ghostrider" ? 8 : 1);
-          if (!algo.starts_with("argon2/")) {
+          while (++used_threads <= thread_count && (used_l3cache += thread_mem) <= l3cache)
+            threads.push_back(1);
+          if (algo == "ghostrider") {
+            if (threads.empty()) threads.push_back(lanes);
+            for (auto& i : threads) i = lanes;
+          } else if (algo.starts_with("argon2/")) {
+            // two hashes of a thread interleave their blocks to hide latency of reference blocks, more
+            // hashes spill their memory out of L2 cache
+            for (auto& i : threads) {
+              if ((used_l3cache += batch_mem) > l3cache) break;
+              i = 2;
+            }
+          } else {
+            // batches above max_cpu_batch (only for algos with wider hashes) are used only if all their
+            // scratchpads still fit into 3/4 of L2 cache share of one CPU (the rest is left for other data)
+            const unsigned l2_batch  = cpu_l2cache / 4 * 3 / batch_mem;
+            const unsigned max_batch = algo2max_cpu_batch.contains(algo) && l2_batch > max_cpu_batch ?
+                                       std::min(algo2max_cpu_batch.at(algo), l2_batch) : max_cpu_batch;
             // increase batch size until we hit L3 cache limit
             while (used_l3cache < l3cache) {
               bool updated = false;
               for (auto& i : threads) {
-                if (i < max_cpu_batch && (used_l3cache += batch_mem) <= l3cache) {
+                if (i < max_batch && (used_l3cache += batch_mem) <= l3cache) {
                   ++ i;
                   updated = true;
                 }
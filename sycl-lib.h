@@ -18,7 +18,9 @@
 #endif
 
 MOMINER_SYCL_API std::map<std::string, std::string> algo_params(
-  unsigned max_cpu_batch, unsigned cpu_sockets, unsigned cpu_threads, unsigned cpu_l3cache,
+  unsigned max_cpu_batch, const std::map<std::string, unsigned>& algo2max_cpu_batch,
+  unsigned cpu_sockets, unsigned cpu_threads, unsigned cpu_l2cache, unsigned cpu_l3cache,
+  size_t memory_cap, size_t rx_full_mem, size_t rx_light_mem,
   const std::map<std::string, unsigned>& algo2mem,
   const std::set<std::string>& cpu_algos,
   const std::set<std::string>& gpu_cn_algos,
@@ -348,9 +348,11 @@ async function runMinerBench(definition) {
   if (resolved.skipped) return resolved;
 
   const job = resolved.job;
-  const args = ["mominer.js", "bench", job.algo, "--job", JSON.stringify(job)];
+  const args = ["mominer.js", "bench", job.algo, "--job", JSON.stringify(job), ...(definition.args || [])];
   const timeoutMs = definition.timeoutMs || 150 * 1000;
   const hashratePattern = new RegExp(`Algo ${escapeRegExp(job.algo)} \\([^)]*\\) hashrate: ([0-9.]+) H\\/s`);
+  // bench can also be stopped earlier by the first output line that matches definition.untilPattern
+  let matchedUntil = null;
 
   return new Promise((resolve, reject) => {
     const command = resolveMinerCommand(args);
@@ -377,6 +379,14 @@ async function runMinerBench(definition) {
 
     const onData = (streamName, chunk) => {
       result[streamName] += chunk.toString("utf8");
+      if (definition.untilPattern) {
+        const match = `${result.stdout}\n${result.stderr}`.match(definition.untilPattern);
+        if (match && !matchedUntil) {
+          matchedUntil = match;
+          stop();
+        }
+        return;
+      }
       const match = `${result.stdout}\n${result.stderr}`.match(hashratePattern);
       if (match && !matchedHashrate) {
         matchedHashrate = Number.parseFloat(match[1]);
@@ -394,18 +404,36 @@ async function runMinerBench(definition) {
       result.code = code;
       result.signal = signal;
 
+      if (matchedUntil) return resolve({ match: matchedUntil, dev: job.dev });
       if (matchedHashrate && matchedHashrate > 0) return resolve({ hashrate: matchedHashrate, dev: job.dev });
       if (definition.gpu && isMissingGpuOutput(result)) {
         return resolve({ skipped: true, reason: "GPU device is not available in this environment" });
       }
 
-      reject(new Error(formatFailure(`${definition.name} did not report hashrate`, args, result)));
+      const expected = definition.untilPattern ? `output matching ${definition.untilPattern}` : "hashrate";
+      reject(new Error(formatFailure(`${definition.name} did not report ${expected}`, args, result)));
     });
   });
 }
 
+// times definition.kernel code with kernel_bench directive and returns match of its stats line
+async function runMinerKernelBench(definition) {
+  const args = ["mominer.js", "kernel_bench", definition.kernel, "--job", JSON.stringify(definition.job)];
+  const result = await runNode(args, { timeoutMs: definition.timeoutMs || 60 * 1000 });
+  if (result.error || result.code !== 0) {
+    throw new Error(formatFailure(`${definition.name} failed`, args, result));
+  }
+  const match = result.stdout.match(definition.statsPattern);
+  if (!match) {
+    throw new Error(formatFailure(`${definition.name} did not report output matching ${definition.statsPattern}`,
+                                  args, result));
+  }
+  return { match };
+}
+
 module.exports = {
   getFirstSyclCpuDevice,
   runMinerBench,
+  runMinerKernelBench,
   runMinerTest,
 };
@@ -3,27 +3,54 @@
 const { describe, it } = require("node:test");
 const assert = require("node:assert/strict");
 
-const { runMinerBench } = require("./common/miner_command");
-const { perfTests } = require("./vectors");
+const { runMinerBench, runMinerKernelBench } = require("./common/miner_command");
+const { perfTests, groupTests } = require("./vectors");
 
 const selectedAlgo = process.env.MOMINER_PERF_ALGO || "";
-const selectedTests = selectedAlgo ? perfTests.filter((definition) => definition.algo === selectedAlgo) : perfTests;
+const selectedAlgos = selectedAlgo ? selectedAlgo.split(",") : [];
+const selectedTests = selectedAlgo ? perfTests.filter((definition) => selectedAlgos.includes(definition.algo)) : perfTests;
+// groups of tests that only run if they are selected by their name
+const selectedGroups = groupTests.filter((group) => selectedAlgos.includes(group.group));
 
-if (selectedAlgo && selectedTests.length === 0) {
-  throw new Error(`Unknown perf algo: ${selectedAlgo}`);
+for (const algo of selectedAlgos) {
+  if (!perfTests.some((definition) => definition.algo === algo) &&
+      !groupTests.some((group) => group.group === algo)) throw new Error(`Unknown perf algo: ${algo}`);
+}
+
+// runs perf test of definition and reports its hashrate (or stats line it waited for), results of
+// tests that ran are added to results
+function itPerf(definition, results) {
+  it(definition.name, { timeout: definition.timeoutMs || 3 * 60 * 1000 }, async (t) => {
+    const result = definition.kernel ? await runMinerKernelBench(definition) : await runMinerBench(definition);
+    if (result.skipped) {
+      t.skip(result.reason);
+      return;
+    }
+
+    if (result.match) {
+      t.diagnostic(`${definition.name}: ${result.match[0].replace(/^\w+ stats: /, "")}`);
+    } else {
+      assert.ok(result.hashrate > 0, `${definition.name} reported invalid hashrate: ${result.hashrate}`);
+      t.diagnostic(`${definition.name} (${result.dev}): ${result.hashrate.toFixed(2)} H/s`);
+    }
+    results.push({ definition, result });
+  });
 }
 
 describe(selectedAlgo ? `proof-of-work performance: ${selectedAlgo}` : "proof-of-work performance", () => {
-  for (const definition of selectedTests) {
-    it(definition.name, { timeout: definition.timeoutMs || 3 * 60 * 1000 }, async (t) => {
-      const result = await runMinerBench(definition);
-      if (result.skipped) {
-        t.skip(result.reason);
+  for (const definition of selectedTests) itPerf(definition, []);
+
+  for (const group of selectedGroups) {
+    const results = [];
+    for (const definition of group.tests) itPerf(definition, results);
+    if (!group.report) continue;
+    it(`${group.group} report`, (t) => {
+      const lines = group.report(results);
+      if (!lines.length) {
+        t.skip(`${group.group} results are not available`);
         return;
       }
-
-      assert.ok(result.hashrate > 0, `${definition.name} reported invalid hashrate: ${result.hashrate}`);
-      t.diagnostic(`${definition.algo} (${result.dev}): ${result.hashrate.toFixed(2)} H/s`);
+      for (const line of lines) t.diagnostic(line);
     });
   }
 });
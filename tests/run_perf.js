@@ -3,7 +3,7 @@
 const { spawn } = require("node:child_process");
 const fs = require("node:fs");
 const path = require("node:path");
-const { perfTests } = require("./vectors");
+const { perfTests, groupTests } = require("./vectors");
 
 const repoRoot = path.join(__dirname, "..");
 const algo = process.argv[2];
@@ -17,9 +17,13 @@ const testArgs = [
 ];
 const testEnv = {};
 
-if (algo && !perfTests.some((definition) => definition.algo === algo)) {
-  console.error(`Unknown perf algo: ${algo}`);
+const perfGroups = groupTests.map((group) => group.group);
+const unknownAlgo = algo && algo.split(",").find((name) =>
+  !perfTests.some((definition) => definition.algo === name) && !perfGroups.includes(name));
+if (unknownAlgo) {
+  console.error(`Unknown perf algo: ${unknownAlgo}`);
   console.error(`Available algos: ${perfTests.map((definition) => definition.algo).join(", ")}`);
+  console.error(`Available groups: ${perfGroups.join(", ")}`);
   process.exit(1);
 }
 
@@ -15,6 +15,56 @@ const hashTests = [
     job: { algo: "rx/2", dev: "cpu*2", blob_hex: "5468697320697320612074657374" },
     expected: dup("ad6eff4f6d8a301b40183174edb4cf72b85caa65e8e5616354c92a2607022712", 2),
   },
+  {
+    name: "rx/0 cpui*2",
+    job: { algo: "rx/0", dev: "cpui*2", blob_hex: "5468697320697320612074657374" },
+    expected: dup("38f638606c730dd6f271d037556b83988c71acc6980e22e25271b22389ecfce6", 2),
+  },
+  {
+    name: "rx/2 cpui*2",
+    job: { algo: "rx/2", dev: "cpui*2", blob_hex: "5468697320697320612074657374" },
+    expected: dup("ad6eff4f6d8a301b40183174edb4cf72b85caa65e8e5616354c92a2607022712", 2),
+  },
+  {
+    name: "rx/0 cpu*2 vaes 256",
+    job: { algo: "rx/0", dev: "cpu*2", blob_hex: "5468697320697320612074657374", vaes: "256" },
+    expected: dup("38f638606c730dd6f271d037556b83988c71acc6980e22e25271b22389ecfce6", 2),
+  },
+  {
+    name: "rx/0 cpu*2 vaes 512",
+    job: { algo: "rx/0", dev: "cpu*2", blob_hex: "5468697320697320612074657374", vaes: "512" },
+    expected: dup("38f638606c730dd6f271d037556b83988c71acc6980e22e25271b22389ecfce6", 2),
+  },
+  {
+    name: "rx/0 cpu*2 shared dataset",
+    job: { algo: "rx/0", dev: "cpu*2", blob_hex: "5468697320697320612074657374", rx_shared_dataset: 1 },
+    expected: dup("38f638606c730dd6f271d037556b83988c71acc6980e22e25271b22389ecfce6", 2),
+  },
+  {
+    name: "rx/0 cpu*2 light mode",
+    job: { algo: "rx/0", dev: "cpu*2", blob_hex: "5468697320697320612074657374", rx_mode: "light" },
+    expected: dup("38f638606c730dd6f271d037556b83988c71acc6980e22e25271b22389ecfce6", 2),
+  },
+  {
+    name: "rx/0 cpui*2 light mode",
+    job: { algo: "rx/0", dev: "cpui*2", blob_hex: "5468697320697320612074657374", rx_mode: "light" },
+    expected: dup("38f638606c730dd6f271d037556b83988c71acc6980e22e25271b22389ecfce6", 2),
+  },
+  {
+    name: "rx/2 cpu*2 light mode",
+    job: { algo: "rx/2", dev: "cpu*2", blob_hex: "5468697320697320612074657374", rx_mode: "light" },
+    expected: dup("ad6eff4f6d8a301b40183174edb4cf72b85caa65e8e5616354c92a2607022712", 2),
+  },
+  {
+    name: "rx/0 cpu*2 light threads",
+    job: { algo: "rx/0", dev: "cpu*2", blob_hex: "5468697320697320612074657374", rx_light_threads: 1 },
+    expected: dup("38f638606c730dd6f271d037556b83988c71acc6980e22e25271b22389ecfce6", 2),
+  },
+  {
+    name: "rx/2 cpu*2 light threads",
+    job: { algo: "rx/2", dev: "cpu*2", blob_hex: "5468697320697320612074657374", rx_light_threads: 1 },
+    expected: dup("ad6eff4f6d8a301b40183174edb4cf72b85caa65e8e5616354c92a2607022712", 2),
+  },
   {
     name: "rx/wow cpu*2",
     job: { algo: "rx/wow", dev: "cpu*2", blob_hex: "5468697320697320612074657374" },
@@ -53,6 +103,47 @@ const hashTests = [
     },
     expected: dup("84402e62b6bedafcd65f6ba13b59ff19ad7f273900c59fa49bfbb5f67e10030f", 8),
   },
+  ...[1, 2, 4].map((lanes) => ({
+    name: `ghostrider cpu*${lanes}`,
+    job: {
+      algo: "ghostrider",
+      dev: `cpu*${lanes}`,
+      blob_hex:
+        "000000208c246d0b90c3b389c4086e8b672ee040" +
+        "d64db5b9648527133e217fbfa48da64c0f3c0a0b" +
+        "0e8350800568b40fbb323ac3ccdf2965de51b9aa" +
+        "eb939b4f11ff81c49b74a16156ff251c00000000",
+    },
+    expected: dup("84402e62b6bedafcd65f6ba13b59ff19ad7f273900c59fa49bfbb5f67e10030f", lanes),
+  })),
+  {
+    name: "ghostrider cpu*8 vaes 256",
+    job: {
+      algo: "ghostrider",
+      dev: "cpu*8",
+      blob_hex:
+        "000000208c246d0b90c3b389c4086e8b672ee040" +
+        "d64db5b9648527133e217fbfa48da64c0f3c0a0b" +
+        "0e8350800568b40fbb323ac3ccdf2965de51b9aa" +
+        "eb939b4f11ff81c49b74a16156ff251c00000000",
+      vaes: "256",
+    },
+    expected: dup("84402e62b6bedafcd65f6ba13b59ff19ad7f273900c59fa49bfbb5f67e10030f", 8),
+  },
+  {
+    name: "ghostrider cpu*8 gr_core scalar",
+    job: {
+      algo: "ghostrider",
+      dev: "cpu*8",
+      blob_hex:
+        "000000208c246d0b90c3b389c4086e8b672ee040" +
+        "d64db5b9648527133e217fbfa48da64c0f3c0a0b" +
+        "0e8350800568b40fbb323ac3ccdf2965de51b9aa" +
+        "eb939b4f11ff81c49b74a16156ff251c00000000",
+      gr_core: "scalar",
+    },
+    expected: dup("84402e62b6bedafcd65f6ba13b59ff19ad7f273900c59fa49bfbb5f67e10030f", 8),
+  },
   {
     name: "argon2/chukwa",
     job: { algo: "argon2/chukwa" },
@@ -68,11 +159,35 @@ const hashTests = [
     job: { algo: "argon2/wrkz" },
     expected: "35e083d4b9c64c2a68820a431f61311998a8cd1864dba4077e25b7f121d54bd1",
   },
+  ...[
+    ["argon2/chukwa", "c158a105ae75c7561cfd029083a47a87653d51f914128e21c1971d8b10c49034"],
+    ["argon2/chukwav2", "77cf6958b3536e1f9f0d1ea165f22811ca7bc487ea9f52030b5050c17fcdd8f5"],
+    ["argon2/wrkz", "35e083d4b9c64c2a68820a431f61311998a8cd1864dba4077e25b7f121d54bd1"],
+  ].flatMap(([algo, hash]) => [2, 3, 8].map((batch) => ({
+    name: `${algo} cpu*${batch}`,
+    job: { algo, dev: `cpu*${batch}` },
+    expected: dup(hash, batch),
+  }))),
   {
     name: "cn/0",
     job: { algo: "cn/0" },
     expected: "1a3ffbee909b420d91f7be6e5fb56db71b3110d886011e877ee5786afd080100",
   },
+  {
+    name: "cn/0 cpu*2 vaes off",
+    job: { algo: "cn/0", dev: "cpu*2", vaes: "off" },
+    expected: dup("1a3ffbee909b420d91f7be6e5fb56db71b3110d886011e877ee5786afd080100", 2),
+  },
+  {
+    name: "cn/0 cpu*2 vaes 256",
+    job: { algo: "cn/0", dev: "cpu*2", vaes: "256" },
+    expected: dup("1a3ffbee909b420d91f7be6e5fb56db71b3110d886011e877ee5786afd080100", 2),
+  },
+  {
+    name: "cn/0 cpu*2 vaes 512",
+    job: { algo: "cn/0", dev: "cpu*2", vaes: "512" },
+    expected: dup("1a3ffbee909b420d91f7be6e5fb56db71b3110d886011e877ee5786afd080100", 2),
+  },
   {
     name: "cn/1",
     job: { algo: "cn/1" },
@@ -94,6 +209,42 @@ const hashTests = [
     },
     expected: "f759588ad57e758467295443a9bd71490abff8e9dad1b95b6bf2f5d0d78387bc",
   },
+  {
+    name: "cn/r height 1806260 cpu*3",
+    job: {
+      algo: "cn/r",
+      dev: "cpu*3",
+      height: 1806260,
+      blob_hex:
+        "54686973206973206120746573742054686973206973" +
+        "20612074657374205468697320697320612074657374",
+    },
+    expected: dup("f759588ad57e758467295443a9bd71490abff8e9dad1b95b6bf2f5d0d78387bc", 3),
+  },
+  {
+    name: "cn/r height 1806260 cpu*4",
+    job: {
+      algo: "cn/r",
+      dev: "cpu*4",
+      height: 1806260,
+      blob_hex:
+        "54686973206973206120746573742054686973206973" +
+        "20612074657374205468697320697320612074657374",
+    },
+    expected: dup("f759588ad57e758467295443a9bd71490abff8e9dad1b95b6bf2f5d0d78387bc", 4),
+  },
+  {
+    name: "cn/r height 1806260 cpu*5",
+    job: {
+      algo: "cn/r",
+      dev: "cpu*5",
+      height: 1806260,
+      blob_hex:
+        "54686973206973206120746573742054686973206973" +
+        "20612074657374205468697320697320612074657374",
+    },
+    expected: dup("f759588ad57e758467295443a9bd71490abff8e9dad1b95b6bf2f5d0d78387bc", 5),
+  },
   {
     name: "cn/fast",
     job: { algo: "cn/fast" },
@@ -139,16 +290,31 @@ const hashTests = [
     job: { algo: "cn/upx2" },
     expected: "aabbb8ed14a835fa22cfb1b5dea872b0a1d6cbd846f4391c0f01f3875e3a3761",
   },
+  {
+    name: "cn/upx2 cpu*8",
+    job: { algo: "cn/upx2", dev: "cpu*8" },
+    expected: dup("aabbb8ed14a835fa22cfb1b5dea872b0a1d6cbd846f4391c0f01f3875e3a3761", 8),
+  },
   {
     name: "cn-pico/0",
     job: { algo: "cn-pico/0" },
     expected: "08f421d7833117300eda66e98f4a2569093df300500173944efc401e9a4a17af",
   },
+  {
+    name: "cn-pico/0 cpu*6",
+    job: { algo: "cn-pico/0", dev: "cpu*6" },
+    expected: dup("08f421d7833117300eda66e98f4a2569093df300500173944efc401e9a4a17af", 6),
+  },
   {
     name: "cn-pico/tlo",
     job: { algo: "cn-pico/tlo" },
     expected: "9975f2c1b3b45434a49386213097f31bb4b9a6586a7e81f4429f6d5f65c38d1a",
   },
+  {
+    name: "cn-pico/tlo cpu*7",
+    job: { algo: "cn-pico/tlo", dev: "cpu*7" },
+    expected: dup("9975f2c1b3b45434a49386213097f31bb4b9a6586a7e81f4429f6d5f65c38d1a", 7),
+  },
   {
     name: "cn-lite/0",
     job: { algo: "cn-lite/0" },
@@ -159,6 +325,11 @@ const hashTests = [
     job: { algo: "cn-lite/1" },
     expected: "6d8cdc444e9bbbfd68fc43fcd4855b228c8a1bd91d9d00285bec02b7ca2d6741",
   },
+  {
+    name: "cn-lite/1 cpu*8",
+    job: { algo: "cn-lite/1", dev: "cpu*8" },
+    expected: dup("6d8cdc444e9bbbfd68fc43fcd4855b228c8a1bd91d9d00285bec02b7ca2d6741", 8),
+  },
   {
     name: "cn-heavy/0",
     job: { algo: "cn-heavy/0" },
@@ -226,7 +397,149 @@ for (const definition of hashTests) {
   });
 }
 
+// best number of hash ways (ghostrider lanes, argon2 batch) of each algo in results of its ways group
+function reportBestWays(results) {
+  const best = {};
+  for (const { definition, result } of results) {
+    if (!best[definition.algo] || result.hashrate > best[definition.algo].hashrate) {
+      best[definition.algo] = { ways: definition.ways, hashrate: result.hashrate };
+    }
+  }
+  return Object.entries(best).map(([algo, { ways, hashrate }]) => `${algo}: cpu*${ways} (${hashrate.toFixed(2)} H/s)`);
+}
+
+// perf test groups that only run if they are selected by their name: tests of a group run one after another
+// with mining bench (or kernel_bench directive for definition.kernel) and optional report(results) returns
+// summary lines of all { definition, result } results of the group
+const groupTests = [
+  {
+    // per hash cost of rx/2 commitment over rx/0 measured in the same run
+    group: "rx/2-overhead",
+    tests: perfTests.filter((definition) => definition.algo === "rx/0" || definition.algo === "rx/2"),
+    report: (results) => {
+      const hashrates = Object.fromEntries(results.map(({ definition, result }) => [definition.algo, result.hashrate]));
+      if (!hashrates["rx/2"] || !hashrates["rx/0"]) return [];
+      const overheadUs = 1e6 / hashrates["rx/2"] - 1e6 / hashrates["rx/0"];
+      return [
+        `rx/2 vs rx/0: ${overheadUs.toFixed(2)} us/hash (${((hashrates["rx/0"] / hashrates["rx/2"] - 1) * 100).toFixed(2)}%)`,
+      ];
+    },
+  },
+  {
+    // rx dataset init code benchmarks that also compare digests of whole datasets built by each code
+    group: "rx-dataset-init",
+    tests: ["scalar", "avx2", "auto"].map((init) => ({
+      algo: "rx/0",
+      autoDev: true,
+      name: `rx/0 dataset init ${init}`,
+      timeoutMs: 5 * 60 * 1000,
+      job: { algo: "rx/0", rx_mode: "full", rx_dataset_init: init, rx_dataset_digest: 1 },
+      args: ["--log_level", "1"],
+      untilPattern: /rx_build stats: dataset_init=(\w+), digest=([0-9a-f]+), items_per_sec=(\d+)/,
+    })),
+    report: (results) => {
+      const scalar = results.find(({ definition }) => definition.job.rx_dataset_init === "scalar");
+      if (!scalar) return [];
+      for (const { result } of results) {
+        const [, init, digest] = result.match;
+        if (digest !== scalar.result.match[2]) throw new Error(`${init} rx dataset differs from scalar one`);
+      }
+      return [`${results.length} rx datasets match scalar one`];
+    },
+  },
+  {
+    // hashrate of small scratchpad cn algos for each number of hash ways to find where it peaks on the CPU
+    group: "cn-ways",
+    tests: ["cn-pico/0", "cn/upx2", "cn-lite/0"].flatMap((algo) =>
+      [1, 2, 3, 4, 5, 6, 7, 8].map((ways) => ({
+        algo,
+        ways,
+        name: `${algo} cpu*${ways}`,
+        timeoutMs: 3 * 60 * 1000,
+        job: { algo, dev: `cpu*${ways}` },
+      }))
+    ),
+    report: reportBestWays,
+  },
+  {
+    // multi-buffer keccak code of cn hash ways
+    group: "keccak",
+    tests: ["scalar", "avx2", "auto"].map((keccak) => ({
+      kernel: "keccak",
+      name: `keccak ${keccak}`,
+      timeoutMs: 60 * 1000,
+      job: { keccak },
+      statsPattern: /keccak stats: code=\w+, ns_per_state=[0-9.]+/,
+    })),
+  },
+  {
+    // multi-buffer finalizer code of cn hash ways
+    group: "cn-final",
+    tests: ["scalar", "auto"].map((cnFinal) => ({
+      kernel: "cn_final",
+      name: `cn finalizers ${cnFinal}`,
+      timeoutMs: 60 * 1000,
+      job: { cn_final: cnFinal },
+      statsPattern: /cn_final stats: blake=[0-9.]+, code=\w+, groestl=[0-9.]+, jh=[0-9.]+, skein=[0-9.]+/,
+    })),
+  },
+  {
+    // ghostrider hashrate without and with helper threads on free SMT siblings
+    group: "gr-helper",
+    tests: ["off", "auto"].map((grHelper) => ({
+      algo: "ghostrider",
+      autoDev: true,
+      name: `ghostrider helper ${grHelper}`,
+      timeoutMs: 3 * 60 * 1000,
+      job: { algo: "ghostrider", gr_helper: grHelper },
+    })),
+    report: (results) => {
+      const hashrates = Object.fromEntries(results.map(({ definition, result }) => [definition.job.gr_helper, result.hashrate]));
+      if (!hashrates.auto || !hashrates.off) return [];
+      return [`auto vs off: ${((hashrates.auto / hashrates.off - 1) * 100).toFixed(2)}%`];
+    },
+  },
+  {
+    // ghostrider hashrate of each number of lanes per thread to find where it peaks on the CPU
+    group: "gr-lanes",
+    tests: [1, 2, 4, 8].map((lanes) => ({
+      algo: "ghostrider",
+      ways: lanes,
+      name: `ghostrider cpu*${lanes}`,
+      timeoutMs: 3 * 60 * 1000,
+      job: { algo: "ghostrider", dev: `cpu*${lanes}` },
+    })),
+    report: reportBestWays,
+  },
+  {
+    // multi-buffer core hash code of ghostrider lanes
+    group: "gr-core",
+    tests: ["scalar", "auto"].map((grCore) => ({
+      kernel: "gr_core",
+      name: `ghostrider core hashes ${grCore}`,
+      timeoutMs: 60 * 1000,
+      job: { gr_core: grCore },
+      statsPattern: /gr_core stats: code=\w+, echo=[0-9.]+, groestl=[0-9.]+, hamsi=[0-9.]+, shavite=[0-9.]+, simd=[0-9.]+, whirlpool=[0-9.]+/,
+    })),
+  },
+  {
+    // argon2 hashrate of each batch size with interleaved hashes to find where it peaks on the CPU
+    group: "argon2-batch",
+    tests: ["argon2/chukwa", "argon2/chukwav2", "argon2/wrkz"].flatMap((algo) =>
+      [1, 2, 4, 8].map((batch) => ({
+        algo,
+        ways: batch,
+        name: `${algo} cpu*${batch}`,
+        timeoutMs: 3 * 60 * 1000,
+        job: { algo, dev: `cpu*${batch}` },
+      }))
+    ),
+    report: reportBestWays,
+  },
+];
+
 module.exports = {
   hashTests,
   perfTests,
+  groupTests,
 };
@@ -308,12 +308,122 @@ void xmrig_ar2_fill_segment_avx512f(const argon2_instance_t *instance, argon2_po
     }
 }
 
+/* MOMINER PATCH BEGIN: batched segments of single lane instances */
+static void prefetch_block(const block *b)
+{
+    unsigned int i;
+
+    for (i = 0; i < ARGON2_QWORDS_IN_BLOCK; i += 8) {
+        _mm_prefetch((const char *)(b->v + i), _MM_HINT_T0);
+    }
+}
+
+void xmrig_ar2_fill_segment_multi_avx512f(const argon2_instance_t *instances, size_t count, argon2_position_t position)
+{
+    /* all instances have the same geometry, only their memory differs */
+    const argon2_instance_t *instance = instances;
+    block *ref_blocks[ARGON2_MULTI_MAX_HASHES];
+    block *curr_block;
+    block address_block, input_block;
+    uint64_t pseudo_rand;
+    uint32_t prev_offset, curr_offset;
+    uint32_t starting_index, ref_index, i;
+    size_t k;
+    __m512i state[ARGON2_MULTI_MAX_HASHES][ARGON2_VECS_IN_BLOCK];
+    int data_independent_addressing, with_xor;
+
+    if (instances == NULL || count == 0 || count > ARGON2_MULTI_MAX_HASHES) {
+        return;
+    }
+
+    data_independent_addressing = (instance->type == Argon2_i) ||
+            (instance->type == Argon2_id && (position.pass == 0) &&
+             (position.slice < ARGON2_SYNC_POINTS / 2));
+    /* version 1.2.1 and earlier: overwrite, not XOR */
+    with_xor = 0 != position.pass && ARGON2_VERSION_10 != instance->version;
+
+    if (data_independent_addressing) {
+        init_block_value(&input_block, 0);
+
+        input_block.v[0] = position.pass;
+        input_block.v[1] = position.lane;
+        input_block.v[2] = position.slice;
+        input_block.v[3] = instance->memory_blocks;
+        input_block.v[4] = instance->passes;
+        input_block.v[5] = instance->type;
+    }
+
+    starting_index = 0;
+
+    if ((0 == position.pass) && (0 == position.slice)) {
+        starting_index = 2; /* we have already generated the first two blocks */
+
+        /* Don't forget to generate the first block of addresses: */
+        if (data_independent_addressing) {
+            next_addresses(&address_block, &input_block);
+        }
+    }
+
+    /* Offset of the current block (instances have only one lane) */
+    curr_offset = position.slice * instance->segment_length + starting_index;
+
+    if (0 == curr_offset % instance->lane_length) {
+        /* Last block in this lane */
+        prev_offset = curr_offset + instance->lane_length - 1;
+    } else {
+        /* Previous block */
+        prev_offset = curr_offset - 1;
+    }
+
+    position.index = starting_index;
+    for (k = 0; k < count; ++k) {
+        memcpy(state[k], ((instances[k].memory + prev_offset)->v), ARGON2_BLOCK_SIZE);
+        if (!data_independent_addressing) {
+            ref_index = xmrig_ar2_index_alpha(&instances[k], &position, instances[k].memory[prev_offset].v[0] & 0xFFFFFFFF, 1);
+            ref_blocks[k] = instances[k].memory + ref_index;
+        }
+    }
+
+    for (i = starting_index; i < instance->segment_length; ++i, ++curr_offset) {
+        /* addresses of data independent reference blocks are the same for all instances */
+        if (data_independent_addressing) {
+            if (i % ARGON2_ADDRESSES_IN_BLOCK == 0) {
+                next_addresses(&address_block, &input_block);
+            }
+            pseudo_rand = address_block.v[i % ARGON2_ADDRESSES_IN_BLOCK];
+            position.index = i;
+            ref_index = xmrig_ar2_index_alpha(instance, &position, pseudo_rand & 0xFFFFFFFF, 1);
+            for (k = 0; k < count; ++k) {
+                ref_blocks[k] = instances[k].memory + ref_index;
+            }
+        }
+
+        position.index = i + 1;
+        for (k = 0; k < count; ++k) {
+            curr_block = instances[k].memory + curr_offset;
+            fill_block(state[k], ref_blocks[k], curr_block, with_xor);
+
+            /* data dependent reference block of the next block is known now, it is
+             * loaded while blocks of the other instances are hashed */
+            if (!data_independent_addressing && i + 1 < instance->segment_length) {
+                ref_index = xmrig_ar2_index_alpha(&instances[k], &position, curr_block->v[0] & 0xFFFFFFFF, 1);
+                ref_blocks[k] = instances[k].memory + ref_index;
+                prefetch_block(ref_blocks[k]);
+            }
+        }
+    }
+}
+/* MOMINER PATCH END */
+
 extern int cpu_flags_has_avx512f(void);
 int xmrig_ar2_check_avx512f(void) { return cpu_flags_has_avx512f(); }
 
 #else
 
 void xmrig_ar2_fill_segment_avx512f(const argon2_instance_t *instance, argon2_position_t position) {}
+/* MOMINER PATCH BEGIN: batched segments of single lane instances */
+void xmrig_ar2_fill_segment_multi_avx512f(const argon2_instance_t *instances, size_t count, argon2_position_t position) {}
+/* MOMINER PATCH END */
 int xmrig_ar2_check_avx512f(void) { return 0; }
 
 #endif
@@ -5,5 +5,8 @@
 
 void xmrig_ar2_fill_segment_avx512f(const argon2_instance_t *instance, argon2_position_t position);
 int xmrig_ar2_check_avx512f(void);
+/* MOMINER PATCH BEGIN: batched segments of single lane instances */
+void xmrig_ar2_fill_segment_multi_avx512f(const argon2_instance_t *instances, size_t count, argon2_position_t position);
+/* MOMINER PATCH END */
 
 #endif // ARGON2_AVX512F_H
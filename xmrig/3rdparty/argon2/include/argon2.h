@@ -316,6 +316,31 @@ ARGON2_PUBLIC int argon2id_hash_raw_ex(const uint32_t t_cost,
                                        const size_t hashlen,
                                        void *memory);
 
+/* MOMINER PATCH BEGIN: batched argon2id hashes */
+#define ARGON2_MULTI_MAX_HASHES 8
+
+/**
+ * Hashes count passwords with argon2id of one lane, each in its own preallocated memory,
+ * with interleaved memory blocks of all hashes to hide memory latency
+ * @param pwds Array of count passwords of pwdlen bytes each
+ * @param salts Array of count salts of saltlen bytes each
+ * @param hashes Array of count outputs of hashlen bytes each
+ * @param memories Array of count memories of argon2_memory_size(m_cost, 1) bytes each
+ * @param count Number of hashes (1 to ARGON2_MULTI_MAX_HASHES)
+ * @return Error code if smth is wrong, ARGON2_OK otherwise
+ */
+ARGON2_PUBLIC int argon2id_hash_raw_multi(const uint32_t t_cost,
+                                          const uint32_t m_cost,
+                                          const void *const *pwds,
+                                          const size_t pwdlen,
+                                          const void *const *salts,
+                                          const size_t saltlen,
+                                          void *const *hashes,
+                                          const size_t hashlen,
+                                          void *const *memories,
+                                          const size_t count);
+/* MOMINER PATCH END */
+
 /* generic function underlying the above ones */
 ARGON2_PUBLIC int argon2_hash(const uint32_t t_cost, const uint32_t m_cost,
                               const uint32_t parallelism, const void *pwd,
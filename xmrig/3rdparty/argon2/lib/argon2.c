@@ -287,6 +287,86 @@ int argon2id_hash_raw_ex(const uint32_t t_cost, const uint32_t m_cost,
     return argon2_ctx_mem(&context, Argon2_id, memory, m_cost * 1024);
 }
 
+/* MOMINER PATCH BEGIN: batched argon2id hashes */
+int argon2id_hash_raw_multi(const uint32_t t_cost, const uint32_t m_cost,
+                            const void *const *pwds, const size_t pwdlen,
+                            const void *const *salts, const size_t saltlen,
+                            void *const *hashes, const size_t hashlen,
+                            void *const *memories, const size_t count) {
+    argon2_context contexts[ARGON2_MULTI_MAX_HASHES];
+    argon2_instance_t instances[ARGON2_MULTI_MAX_HASHES];
+    uint32_t memory_blocks, segment_length;
+    size_t i;
+    int result;
+
+    if (count == 0 || count > ARGON2_MULTI_MAX_HASHES) {
+        return ARGON2_INCORRECT_PARAMETER;
+    }
+
+    argon2_compute_memory_blocks(&memory_blocks, &segment_length, m_cost, 1);
+
+    for (i = 0; i < count; ++i) {
+        argon2_context *context = &contexts[i];
+        argon2_instance_t *instance = &instances[i];
+
+        context->out = (uint8_t *)hashes[i];
+        context->outlen = (uint32_t)hashlen;
+        context->pwd = CONST_CAST(uint8_t *)pwds[i];
+        context->pwdlen = (uint32_t)pwdlen;
+        context->salt = CONST_CAST(uint8_t *)salts[i];
+        context->saltlen = (uint32_t)saltlen;
+        context->secret = NULL;
+        context->secretlen = 0;
+        context->ad = NULL;
+        context->adlen = 0;
+        context->t_cost = t_cost;
+        context->m_cost = m_cost;
+        context->lanes = 1;
+        context->threads = 1;
+        context->allocate_cbk = NULL;
+        context->free_cbk = NULL;
+        context->flags = ARGON2_DEFAULT_FLAGS;
+        context->version = ARGON2_VERSION_NUMBER;
+
+        result = xmrig_ar2_validate_inputs(context);
+        if (ARGON2_OK != result) {
+            return result;
+        }
+        if (memories[i] == NULL) {
+            return ARGON2_MEMORY_ALLOCATION_ERROR;
+        }
+
+        instance->version = context->version;
+        instance->memory = (block *)memories[i];
+        instance->passes = t_cost;
+        instance->memory_blocks = memory_blocks;
+        instance->segment_length = segment_length;
+        instance->lane_length = segment_length * ARGON2_SYNC_POINTS;
+        instance->lanes = 1;
+        instance->threads = 1;
+        instance->type = Argon2_id;
+        instance->print_internals = 0;
+        instance->keep_memory = 1;
+
+        result = xmrig_ar2_initialize(instance, context);
+        if (ARGON2_OK != result) {
+            return result;
+        }
+    }
+
+    result = xmrig_ar2_fill_memory_blocks_multi(instances, count);
+    if (ARGON2_OK != result) {
+        return result;
+    }
+
+    for (i = 0; i < count; ++i) {
+        xmrig_ar2_finalize(&contexts[i], &instances[i]);
+    }
+
+    return ARGON2_OK;
+}
+/* MOMINER PATCH END */
+
 static int argon2_compare(const uint8_t *b1, const uint8_t *b2, size_t len) {
     size_t i;
     uint8_t d = 0U;
@@ -271,6 +271,24 @@ int xmrig_ar2_fill_memory_blocks(argon2_instance_t *instance) {
     return fill_memory_blocks_st(instance);
 }
 
+/* MOMINER PATCH BEGIN: batched single lane instances */
+int xmrig_ar2_fill_memory_blocks_multi(argon2_instance_t *instances, size_t count) {
+    uint32_t r, s;
+
+    if (instances == NULL || count == 0 || count > ARGON2_MULTI_MAX_HASHES) {
+        return ARGON2_INCORRECT_PARAMETER;
+    }
+
+    for (r = 0; r < instances[0].passes; ++r) {
+        for (s = 0; s < ARGON2_SYNC_POINTS; ++s) {
+            argon2_position_t position = { r, 0, (uint8_t)s, 0 };
+            xmrig_ar2_fill_segment_multi(instances, count, position);
+        }
+    }
+    return ARGON2_OK;
+}
+/* MOMINER PATCH END */
+
 int xmrig_ar2_validate_inputs(const argon2_context *context) {
     if (NULL == context) {
         return ARGON2_INCORRECT_PARAMETER;
@@ -217,4 +217,22 @@ void xmrig_ar2_fill_segment(const argon2_instance_t *instance, argon2_position_t
  */
 int xmrig_ar2_fill_memory_blocks(argon2_instance_t *instance);
 
+/* MOMINER PATCH BEGIN: batched single lane instances */
+/*
+ * Function that fills the same segment of count single lane instances of the same geometry
+ * @param instances Array of count instances
+ * @param count Number of instances (1 to ARGON2_MULTI_MAX_HASHES)
+ * @param position Current position (lane is always 0)
+ */
+void xmrig_ar2_fill_segment_multi(const argon2_instance_t *instances, size_t count, argon2_position_t position);
+
+/*
+ * Function that fills memory of count single lane instances of the same geometry
+ * @param instances Array of count instances
+ * @param count Number of instances (1 to ARGON2_MULTI_MAX_HASHES)
+ * @return ARGON2_OK if success
+ */
+int xmrig_ar2_fill_memory_blocks_multi(argon2_instance_t *instances, size_t count);
+/* MOMINER PATCH END */
+
 #endif
@@ -17,7 +17,9 @@ extern uint64_t uv_hrtime(void);
 #endif
 
 
-static argon2_impl selected_argon_impl = { "default", NULL, fill_segment_default };
+/* MOMINER PATCH BEGIN: batched segments of single lane instances */
+static argon2_impl selected_argon_impl = { "default", NULL, fill_segment_default, NULL };
+/* MOMINER PATCH END */
 
 
 /* the benchmark routine is not thread-safe, so we can use a global var here: */
@@ -92,6 +94,22 @@ void xmrig_ar2_fill_segment(const argon2_instance_t *instance, argon2_position_t
 }
 
 
+/* MOMINER PATCH BEGIN: batched segments of single lane instances */
+void xmrig_ar2_fill_segment_multi(const argon2_instance_t *instances, size_t count, argon2_position_t position)
+{
+    if (selected_argon_impl.fill_segment_multi != NULL) {
+        selected_argon_impl.fill_segment_multi(instances, count, position);
+        return;
+    }
+
+    /* implementations without interleaved blocks fill segments one by one */
+    for (size_t i = 0; i < count; i++) {
+        selected_argon_impl.fill_segment(&instances[i], position);
+    }
+}
+/* MOMINER PATCH END */
+
+
 const char *argon2_get_impl_name()
 {
     return selected_argon_impl.name;
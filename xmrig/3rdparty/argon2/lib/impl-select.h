@@ -8,6 +8,11 @@ typedef struct Argon2_impl {
     int (*check)(void);
     void (*fill_segment)(const argon2_instance_t *instance,
                          argon2_position_t position);
+    /* MOMINER PATCH BEGIN: batched segments of single lane instances */
+    /* fills the same segment of count instances with interleaved blocks (NULL if not supported) */
+    void (*fill_segment_multi)(const argon2_instance_t *instances, size_t count,
+                               argon2_position_t position);
+    /* MOMINER PATCH END */
 } argon2_impl;
 
 typedef struct Argon2_impl_list {
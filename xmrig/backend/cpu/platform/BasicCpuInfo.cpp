@@ -313,6 +313,9 @@ xmrig::BasicCpuInfo::BasicCpuInfo() :
 
     cn_sse41_enabled = has(FLAG_SSE41);
     cn_vaes_enabled = has(FLAG_VAES);
+    // MOMINER PATCH BEGIN: double hash scratchpad explode/implode can also use VAES-512 (see CryptoNight_x86_vaes.cpp).
+    cn_vaes512_enabled = has(FLAG_VAES) && has(FLAG_AVX512F);
+    // MOMINER PATCH END
 }
 
 
@@ -212,3 +212,220 @@ void xmrig::keccak(const uint8_t *in, int inlen, uint8_t *md, int mdlen)
 
     memcpy(md, st, mdlen);
 }
+
+
+// MOMINER PATCH BEGIN: multi-buffer keccak of several independent states (AVX2 or AVX-512 when enabled).
+#if defined(HAVE_AVX2) || defined(HAVE_AVX512F)
+#include <immintrin.h>
+
+
+namespace {
+
+
+// each vector lane keeps the same state word of one of several states
+template<typename OPS>
+static inline void keccakf_lanes(typename OPS::V st[25], int rounds)
+{
+    using V = typename OPS::V;
+
+    for (int round = 0; round < rounds; ++round) {
+        V bc[5];
+
+        // Theta
+        for (int i = 0; i < 5; ++i) {
+            bc[i] = OPS::xor5(st[i], st[i + 5], st[i + 10], st[i + 15], st[i + 20]);
+        }
+
+        for (int i = 0; i < 5; ++i) {
+            const V t = OPS::xor2(bc[(i + 4) % 5], OPS::template rotl<1>(bc[(i + 1) % 5]));
+            st[i     ] = OPS::xor2(st[i     ], t);
+            st[i +  5] = OPS::xor2(st[i +  5], t);
+            st[i + 10] = OPS::xor2(st[i + 10], t);
+            st[i + 15] = OPS::xor2(st[i + 15], t);
+            st[i + 20] = OPS::xor2(st[i + 20], t);
+        }
+
+        // Rho Pi
+        const V t = st[1];
+        st[ 1] = OPS::template rotl<44>(st[ 6]);
+        st[ 6] = OPS::template rotl<20>(st[ 9]);
+        st[ 9] = OPS::template rotl<61>(st[22]);
+        st[22] = OPS::template rotl<39>(st[14]);
+        st[14] = OPS::template rotl<18>(st[20]);
+        st[20] = OPS::template rotl<62>(st[ 2]);
+        st[ 2] = OPS::template rotl<43>(st[12]);
+        st[12] = OPS::template rotl<25>(st[13]);
+        st[13] = OPS::template rotl< 8>(st[19]);
+        st[19] = OPS::template rotl<56>(st[23]);
+        st[23] = OPS::template rotl<41>(st[15]);
+        st[15] = OPS::template rotl<27>(st[ 4]);
+        st[ 4] = OPS::template rotl<14>(st[24]);
+        st[24] = OPS::template rotl< 2>(st[21]);
+        st[21] = OPS::template rotl<55>(st[ 8]);
+        st[ 8] = OPS::template rotl<45>(st[16]);
+        st[16] = OPS::template rotl<36>(st[ 5]);
+        st[ 5] = OPS::template rotl<28>(st[ 3]);
+        st[ 3] = OPS::template rotl<21>(st[18]);
+        st[18] = OPS::template rotl<15>(st[17]);
+        st[17] = OPS::template rotl<10>(st[11]);
+        st[11] = OPS::template rotl< 6>(st[ 7]);
+        st[ 7] = OPS::template rotl< 3>(st[10]);
+        st[10] = OPS::template rotl< 1>(t);
+
+        // Chi
+        for (int j = 0; j < 25; j += 5) {
+            for (int i = 0; i < 5; ++i) {
+                bc[i] = st[j + i];
+            }
+            for (int i = 0; i < 5; ++i) {
+                st[j + i] = OPS::chi(bc[i], bc[(i + 1) % 5], bc[(i + 2) % 5]);
+            }
+        }
+
+        // Iota
+        st[0] = OPS::xor2(st[0], OPS::set1(keccakf_rndc[round]));
+    }
+}
+
+
+// keccakf of n <= OPS::N states, missing lanes repeat the last state and store the same result into it
+template<typename OPS>
+static inline void keccakf_pass(uint64_t *const *st, size_t n, int rounds)
+{
+    alignas(64) uint64_t lanes[25][OPS::N];
+    for (size_t k = 0; k < OPS::N; ++k) {
+        const uint64_t *s = st[k < n ? k : n - 1];
+        for (int i = 0; i < 25; ++i) {
+            lanes[i][k] = s[i];
+        }
+    }
+
+    typename OPS::V v[25];
+    for (int i = 0; i < 25; ++i) {
+        v[i] = OPS::load(lanes[i]);
+    }
+
+    keccakf_lanes<OPS>(v, rounds);
+
+    for (int i = 0; i < 25; ++i) {
+        OPS::store(lanes[i], v[i]);
+    }
+    for (size_t k = 0; k < n; ++k) {
+        for (int i = 0; i < 25; ++i) {
+            st[k][i] = lanes[i][k];
+        }
+    }
+}
+
+
+#if defined(HAVE_AVX2)
+struct KeccakAvx2 {
+    using V = __m256i;
+    static constexpr size_t N = 4;
+
+    static inline V load(const uint64_t *p)                 { return _mm256_load_si256(reinterpret_cast<const V*>(p)); }
+    static inline void store(uint64_t *p, V a)              { _mm256_store_si256(reinterpret_cast<V*>(p), a); }
+    static inline V set1(uint64_t a)                        { return _mm256_set1_epi64x(static_cast<int64_t>(a)); }
+    static inline V xor2(V a, V b)                          { return _mm256_xor_si256(a, b); }
+    static inline V xor5(V a, V b, V c, V d, V e)           { return xor2(xor2(xor2(a, b), xor2(c, d)), e); }
+    static inline V chi(V a, V b, V c)                      { return xor2(a, _mm256_andnot_si256(b, c)); }
+    template<int n> static inline V rotl(V a)               { return _mm256_or_si256(_mm256_slli_epi64(a, n), _mm256_srli_epi64(a, 64 - n)); }
+};
+#endif
+
+
+#if defined(HAVE_AVX512F)
+struct KeccakAvx512 {
+    using V = __m512i;
+    static constexpr size_t N = 8;
+
+    static inline V load(const uint64_t *p)                 { return _mm512_load_si512(p); }
+    static inline void store(uint64_t *p, V a)              { _mm512_store_si512(p, a); }
+    static inline V set1(uint64_t a)                        { return _mm512_set1_epi64(static_cast<int64_t>(a)); }
+    static inline V xor2(V a, V b)                          { return _mm512_xor_si512(a, b); }
+    static inline V xor5(V a, V b, V c, V d, V e)           { return _mm512_ternarylogic_epi64(_mm512_ternarylogic_epi64(a, b, c, 0x96), d, e, 0x96); }
+    static inline V chi(V a, V b, V c)                      { return _mm512_ternarylogic_epi64(a, b, c, 0xD2); } // a ^ (~b & c)
+    // full mask maskz rotate is the same instruction as unmasked one that passes undefined source GCC warns about
+    template<int n> static inline V rotl(V a)               { return _mm512_maskz_rol_epi64(0xFF, a, n); }
+};
+#endif
+
+
+} // namespace
+#endif
+
+
+static int keccak_multi_lanes = 1;
+
+
+int xmrig::keccak_set_multi_lanes(int lanes)
+{
+#   if defined(HAVE_AVX512F)
+    if (lanes >= 8) {
+        return keccak_multi_lanes = 8;
+    }
+#   endif
+#   if defined(HAVE_AVX2)
+    if (lanes >= 4) {
+        return keccak_multi_lanes = 4;
+    }
+#   endif
+    return keccak_multi_lanes = 1;
+}
+
+
+void xmrig::keccakf_multi(uint64_t *const *st, size_t n, int rounds)
+{
+    size_t i = 0;
+#   if defined(HAVE_AVX512F)
+    // AVX-512 pass is slower than AVX2 one for up to 4 states
+    if (keccak_multi_lanes == 8) {
+        for (; i + 4 < n; i += 8) {
+            keccakf_pass<KeccakAvx512>(st + i, n - i < 8 ? n - i : 8, rounds);
+        }
+    }
+#   endif
+#   if defined(HAVE_AVX2)
+    if (keccak_multi_lanes >= 4) {
+        for (; i + 1 < n; i += 4) {
+            keccakf_pass<KeccakAvx2>(st + i, n - i < 4 ? n - i : 4, rounds);
+        }
+    }
+#   endif
+    for (; i < n; ++i) {
+        keccakf(st[i], rounds);
+    }
+}
+
+
+void xmrig::keccak_multi(const uint8_t *in, size_t inlen, uint8_t *const *md, size_t n)
+{
+    // multi-block inputs are not used by hashes and keep the scalar code
+    if (inlen >= HASH_DATA_AREA || keccak_multi_lanes == 1) {
+        for (size_t i = 0; i < n; ++i) {
+            keccak(in + i * inlen, static_cast<int>(inlen), md[i], 200);
+        }
+        return;
+    }
+
+    for (size_t i = 0; i < n; ++i) {
+        alignas(8) uint8_t temp[HASH_DATA_AREA];
+        memcpy(temp, in + i * inlen, inlen);
+        temp[inlen] = 1;
+        memset(temp + inlen + 1, 0, HASH_DATA_AREA - inlen - 1);
+        temp[HASH_DATA_AREA - 1] |= 0x80;
+
+        memset(md[i], 0, 200);
+        memcpy(md[i], temp, HASH_DATA_AREA);
+    }
+
+    for (size_t i = 0; i < n; i += 8) {
+        uint64_t *st[8];
+        const size_t count = n - i < 8 ? n - i : 8;
+        for (size_t k = 0; k < count; ++k) {
+            st[k] = reinterpret_cast<uint64_t *>(md[i + k]);
+        }
+        keccakf_multi(st, count, KECCAK_ROUNDS);
+    }
+}
+// MOMINER PATCH END
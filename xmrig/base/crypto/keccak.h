@@ -51,6 +51,18 @@ inline void keccak(const char *in, size_t inlen, uint8_t *md)
 // update the state
 void keccakf(uint64_t st[25], int norounds);
 
+// MOMINER PATCH BEGIN: multi-buffer keccak of several independent states (AVX2 or AVX-512 when enabled).
+// update n states, 4 or 8 of them per SIMD pass depending on keccak_set_multi_lanes
+void keccakf_multi(uint64_t *const *st, size_t n, int norounds);
+
+// keccak(in + i * inlen, inlen, md[i]) with 200 byte md for each of n inputs
+void keccak_multi(const uint8_t *in, size_t inlen, uint8_t *const *md, size_t n);
+
+// selects SIMD lanes used by keccakf_multi: 1 (scalar), 4 (AVX2) or 8 (AVX-512), returns the number
+// of lanes actually set (less than requested if this build has no such code), CPU support is checked by caller
+int keccak_set_multi_lanes(int lanes);
+// MOMINER PATCH END
+
 } /* namespace xmrig */
 
 #endif /* XMRIG_KECCAK_H */
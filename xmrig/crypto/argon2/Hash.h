@@ -49,6 +49,34 @@ inline void single_hash(const uint8_t *__restrict__ input, size_t size, uint8_t
 }
 
 
+// MOMINER PATCH BEGIN: batched argon2id hashes of N nonces, each in memory of its own ctx
+template<Algorithm::Id ALGO, size_t N>
+inline void multi_hash(const uint8_t *__restrict__ input, size_t size, uint8_t *__restrict__ output, cryptonight_ctx **__restrict__ ctx, uint64_t)
+{
+    static_assert(N >= 2 && N <= ARGON2_MULTI_MAX_HASHES, "Unsupported number of argon2 hashes");
+
+    const void *inputs[N];
+    void *outputs[N];
+    void *memories[N];
+    for (size_t i = 0; i < N; ++i) {
+        inputs[i]   = input + i * size;
+        outputs[i]  = output + i * 32;
+        memories[i] = ctx[i]->memory;
+    }
+
+    if (ALGO == Algorithm::AR2_CHUKWA) {
+        argon2id_hash_raw_multi(3, 512, inputs, size, inputs, 16, outputs, 32, memories, N);
+    }
+    else if (ALGO == Algorithm::AR2_CHUKWA_V2) {
+        argon2id_hash_raw_multi(4, 1024, inputs, size, inputs, 16, outputs, 32, memories, N);
+    }
+    else if (ALGO == Algorithm::AR2_WRKZ) {
+        argon2id_hash_raw_multi(4, 256, inputs, size, inputs, 16, outputs, 32, memories, N);
+    }
+}
+// MOMINER PATCH END
+
+
 }} // namespace xmrig::argon2
 
 
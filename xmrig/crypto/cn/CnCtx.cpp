@@ -36,6 +36,11 @@ void xmrig::CnCtx::create(cryptonight_ctx **ctx, uint8_t *memory, size_t size, s
         c->generated_code              = reinterpret_cast<cn_mainloop_fun_ms_abi>(VirtualMemory::allocateExecutableMemory(0x4000, false));
         c->generated_code_data.algo    = Algorithm::INVALID;
         c->generated_code_data.height  = std::numeric_limits<uint64_t>::max();
+        // MOMINER PATCH BEGIN: generated CnR random math of 3-5 way hashes uses second half of generated_code memory block.
+        c->generated_math              = reinterpret_cast<cn_r_math_fun_ms_abi>(reinterpret_cast<uint8_t*>(c->generated_code) + CN_R_MATH_OFFSET);
+        c->generated_math_data.algo    = Algorithm::INVALID;
+        c->generated_math_data.height  = std::numeric_limits<uint64_t>::max();
+        // MOMINER PATCH END
 
         ctx[i] = c;
     }
@@ -54,8 +54,47 @@
     } while (0)
 
 
+// MOMINER PATCH BEGIN: 6-8 way hashes only pay off when all their scratchpads fit into L2, so they are
+// only instantiated for algos with small scratchpads.
+#define ADD_FN_WIDE(algo) do {                                                                       \
+        m_map[algo]->data[AV_HEXA][Assembly::NONE]        = cryptonight_hexa_hash<algo,  false>;     \
+        m_map[algo]->data[AV_HEXA_SOFT][Assembly::NONE]   = cryptonight_hexa_hash<algo,  true>;      \
+        m_map[algo]->data[AV_HEPTA][Assembly::NONE]       = cryptonight_hepta_hash<algo, false>;     \
+        m_map[algo]->data[AV_HEPTA_SOFT][Assembly::NONE]  = cryptonight_hepta_hash<algo, true>;      \
+        m_map[algo]->data[AV_OCTA][Assembly::NONE]        = cryptonight_octa_hash<algo,  false>;     \
+        m_map[algo]->data[AV_OCTA_SOFT][Assembly::NONE]   = cryptonight_octa_hash<algo,  true>;      \
+    } while (0)
+// MOMINER PATCH END
+
+
+// MOMINER PATCH BEGIN: batches of 2-8 argon2 hashes interleave their memory blocks (see argon2id_hash_raw_multi).
+#define ADD_FN_ARGON2_MULTI(algo) do {                                                               \
+        m_map[algo]->data[AV_DOUBLE][Assembly::NONE]      = argon2::multi_hash<algo, 2>;             \
+        m_map[algo]->data[AV_DOUBLE_SOFT][Assembly::NONE] = argon2::multi_hash<algo, 2>;             \
+        m_map[algo]->data[AV_TRIPLE][Assembly::NONE]      = argon2::multi_hash<algo, 3>;             \
+        m_map[algo]->data[AV_TRIPLE_SOFT][Assembly::NONE] = argon2::multi_hash<algo, 3>;             \
+        m_map[algo]->data[AV_QUAD][Assembly::NONE]        = argon2::multi_hash<algo, 4>;             \
+        m_map[algo]->data[AV_QUAD_SOFT][Assembly::NONE]   = argon2::multi_hash<algo, 4>;             \
+        m_map[algo]->data[AV_PENTA][Assembly::NONE]       = argon2::multi_hash<algo, 5>;             \
+        m_map[algo]->data[AV_PENTA_SOFT][Assembly::NONE]  = argon2::multi_hash<algo, 5>;             \
+        m_map[algo]->data[AV_HEXA][Assembly::NONE]        = argon2::multi_hash<algo, 6>;             \
+        m_map[algo]->data[AV_HEXA_SOFT][Assembly::NONE]   = argon2::multi_hash<algo, 6>;             \
+        m_map[algo]->data[AV_HEPTA][Assembly::NONE]       = argon2::multi_hash<algo, 7>;             \
+        m_map[algo]->data[AV_HEPTA_SOFT][Assembly::NONE]  = argon2::multi_hash<algo, 7>;             \
+        m_map[algo]->data[AV_OCTA][Assembly::NONE]        = argon2::multi_hash<algo, 8>;             \
+        m_map[algo]->data[AV_OCTA_SOFT][Assembly::NONE]   = argon2::multi_hash<algo, 8>;             \
+    } while (0)
+// MOMINER PATCH END
+
+
 bool cn_sse41_enabled = false;
 bool cn_vaes_enabled = false;
+// MOMINER PATCH BEGIN: double hash scratchpad explode/implode can also use VAES-512 (see CryptoNight_x86_vaes.cpp).
+bool cn_vaes512_enabled = false;
+// MOMINER PATCH END
+// MOMINER PATCH BEGIN: finalizer hashes of multi-way hashes can use multi-buffer code (see cn_extra_hashes_lanes).
+bool cn_final_multi_enabled = false;
+// MOMINER PATCH END
 
 
 #ifdef XMRIG_FEATURE_ASM
@@ -338,6 +377,10 @@ xmrig::CnHash::CnHash()
 #   ifdef XMRIG_ALGO_CN_LITE
     ADD_FN(Algorithm::CN_LITE_0);
     ADD_FN(Algorithm::CN_LITE_1);
+    // MOMINER PATCH BEGIN: 6-8 way hashes for small scratchpad algos.
+    ADD_FN_WIDE(Algorithm::CN_LITE_0);
+    ADD_FN_WIDE(Algorithm::CN_LITE_1);
+    // MOMINER PATCH END
 #   endif
 
 #   ifdef XMRIG_ALGO_CN_HEAVY
@@ -351,6 +394,10 @@ xmrig::CnHash::CnHash()
     ADD_FN_ASM(Algorithm::CN_PICO_0);
     ADD_FN(Algorithm::CN_PICO_TLO);
     ADD_FN_ASM(Algorithm::CN_PICO_TLO);
+    // MOMINER PATCH BEGIN: 6-8 way hashes for small scratchpad algos.
+    ADD_FN_WIDE(Algorithm::CN_PICO_0);
+    ADD_FN_WIDE(Algorithm::CN_PICO_TLO);
+    // MOMINER PATCH END
 #   endif
 
     ADD_FN(Algorithm::CN_CCX);
@@ -358,6 +405,9 @@ xmrig::CnHash::CnHash()
 #   ifdef XMRIG_ALGO_CN_FEMTO
     ADD_FN(Algorithm::CN_UPX2);
     ADD_FN_ASM(Algorithm::CN_UPX2);
+    // MOMINER PATCH BEGIN: 6-8 way hashes for small scratchpad algos.
+    ADD_FN_WIDE(Algorithm::CN_UPX2);
+    // MOMINER PATCH END
 #   endif
 
 #   ifdef XMRIG_ALGO_ARGON2
@@ -372,6 +422,12 @@ xmrig::CnHash::CnHash()
     m_map[Algorithm::AR2_WRKZ] = new cn_hash_fun_array{};
     m_map[Algorithm::AR2_WRKZ]->data[AV_SINGLE][Assembly::NONE]           = argon2::single_hash<Algorithm::AR2_WRKZ>;
     m_map[Algorithm::AR2_WRKZ]->data[AV_SINGLE_SOFT][Assembly::NONE]      = argon2::single_hash<Algorithm::AR2_WRKZ>;
+
+    // MOMINER PATCH BEGIN: batches of 2-8 argon2 hashes.
+    ADD_FN_ARGON2_MULTI(Algorithm::AR2_CHUKWA);
+    ADD_FN_ARGON2_MULTI(Algorithm::AR2_CHUKWA_V2);
+    ADD_FN_ARGON2_MULTI(Algorithm::AR2_WRKZ);
+    // MOMINER PATCH END
 #   endif
 
 #   ifdef XMRIG_ALGO_GHOSTRIDER
@@ -442,3 +498,49 @@ xmrig::cn_hash_fun xmrig::CnHash::fn(const Algorithm &algorithm, AlgoVariant av,
 
     return it->second->data[av][Assembly::NONE];
 }
+
+
+// MOMINER PATCH BEGIN: cn/r program of fn(CN_R, av, assembly) compiled ahead of hashing.
+bool xmrig::CnHash::compileR(uint64_t height, AlgoVariant av, Assembly::Id assembly, uint8_t *code)
+{
+#   if defined(XMRIG_FEATURE_ASM) && !defined(XMRIG_ARM) && !defined(XMRIG_RISCV)
+    V4_Instruction program[256];
+    const int size = v4_random_math_init<Algorithm::CN_R>(program, height);
+    const Assembly::Id id = Cpu::assembly(assembly);
+
+    switch (av) {
+    case AV_SINGLE:
+        if (id == Assembly::NONE) {
+            return false;
+        }
+        v4_compile_code(program, size, code, id);
+        return true;
+
+    case AV_DOUBLE:
+        if (id == Assembly::NONE) {
+            return false;
+        }
+        v4_compile_code_double(program, size, code, id);
+        return true;
+
+    case AV_SINGLE_SOFT:
+        v4_soft_aes_compile_code(program, size, code, Assembly::NONE);
+        return true;
+
+    case AV_TRIPLE:
+    case AV_QUAD:
+    case AV_PENTA:
+    case AV_TRIPLE_SOFT:
+    case AV_QUAD_SOFT:
+    case AV_PENTA_SOFT:
+        v4_compile_code_lanes(program, size, code + CN_R_MATH_OFFSET, Cpu::info()->assembly());
+        return true;
+
+    default:
+        break;
+    }
+#   endif
+
+    return false;
+}
+// MOMINER PATCH END
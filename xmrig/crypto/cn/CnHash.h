@@ -55,6 +55,14 @@ public:
         AV_TRIPLE_SOFT, // --av=8  Triple hash mode (Software AES)
         AV_QUAD_SOFT,   // --av=9  Quard hash mode  (Software AES)
         AV_PENTA_SOFT,  // --av=10 Penta hash mode  (Software AES)
+        // MOMINER PATCH BEGIN: 6-8 way hashes for small scratchpad algos only.
+        AV_HEXA,        // --av=11 Hexa hash mode
+        AV_HEPTA,       // --av=12 Hepta hash mode
+        AV_OCTA,        // --av=13 Octa hash mode
+        AV_HEXA_SOFT,   // --av=14 Hexa hash mode   (Software AES)
+        AV_HEPTA_SOFT,  // --av=15 Hepta hash mode  (Software AES)
+        AV_OCTA_SOFT,   // --av=16 Octa hash mode   (Software AES)
+        // MOMINER PATCH END
         AV_MAX
     };
 
@@ -62,6 +70,11 @@ public:
     virtual ~CnHash();
 
     static cn_hash_fun fn(const Algorithm &algorithm, AlgoVariant av, Assembly::Id assembly);
+    // MOMINER PATCH BEGIN: cn/r program of fn(CN_R, av, assembly) compiled ahead of hashing.
+    // Fills CN_R_CODE_SIZE bytes of executable code memory laid out like generated_code block of cryptonight_ctx,
+    // returns false if that fn does not use generated code.
+    static bool compileR(uint64_t height, AlgoVariant av, Assembly::Id assembly, uint8_t *code);
+    // MOMINER PATCH END
 
 private:
     struct cn_hash_fun_array {
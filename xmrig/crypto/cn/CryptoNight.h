@@ -39,6 +39,12 @@
 
 struct cryptonight_ctx;
 typedef void(*cn_mainloop_fun_ms_abi)(cryptonight_ctx**) ABI_ATTRIBUTE;
+// MOMINER PATCH BEGIN: generated CnR random math of 3-5 way hashes (registers of each hash are passed as uint32_t[9]).
+typedef void(*cn_r_math_fun_ms_abi)(uint32_t* const*, size_t) ABI_ATTRIBUTE;
+// generated_code block size and offset of generated_math in it
+constexpr size_t CN_R_CODE_SIZE   = 0x4000;
+constexpr size_t CN_R_MATH_OFFSET = 0x2000;
+// MOMINER PATCH END
 
 
 struct cryptonight_r_data {
@@ -60,6 +66,10 @@ struct cryptonight_ctx {
 
     cn_mainloop_fun_ms_abi generated_code;
     cryptonight_r_data generated_code_data;
+    // MOMINER PATCH BEGIN: generated CnR random math of 3-5 way hashes (lives in generated_code memory block).
+    cn_r_math_fun_ms_abi generated_math;
+    cryptonight_r_data generated_math_data;
+    // MOMINER PATCH END
 
     alignas(16) uint8_t save_state[128];
     bool first_half;
@@ -206,5 +206,11 @@
 
 extern bool cn_sse41_enabled;
 extern bool cn_vaes_enabled;
+// MOMINER PATCH BEGIN: double hash scratchpad explode/implode can also use VAES-512 (see CryptoNight_x86_vaes.cpp).
+extern bool cn_vaes512_enabled;
+// MOMINER PATCH END
+// MOMINER PATCH BEGIN: finalizer hashes of multi-way hashes can use multi-buffer code (see cn_extra_hashes_lanes).
+extern bool cn_final_multi_enabled;
+// MOMINER PATCH END
 
 #endif /* XMRIG_CRYPTONIGHT_MONERO_H */
@@ -289,6 +289,61 @@ inline constexpr uint64_t interleaved_index<0>(uint64_t k)
 }
 
 
+// MOMINER PATCH BEGIN: keccak of all states of a multi-way hash is done by multi-buffer keccak.
+template<size_t N>
+static inline void cn_keccak_lanes(const uint8_t *input, size_t size, cryptonight_ctx **ctx)
+{
+    uint8_t *md[N];
+    for (size_t i = 0; i < N; i++) {
+        md[i] = ctx[i]->state;
+    }
+    keccak_multi(input, size, md, N);
+}
+
+
+template<size_t N>
+static inline void cn_keccakf_lanes(cryptonight_ctx **ctx)
+{
+    uint64_t *st[N];
+    for (size_t i = 0; i < N; i++) {
+        st[i] = reinterpret_cast<uint64_t*>(ctx[i]->state);
+    }
+    keccakf_multi(st, N, 24);
+}
+// MOMINER PATCH END
+
+
+// MOMINER PATCH BEGIN: finalizer hashes of a multi-way hash are bucketed by finalizer and done by multi-buffer code.
+template<size_t N>
+static inline void cn_extra_hashes_lanes(cryptonight_ctx **ctx, uint8_t *output)
+{
+    if (!cn_final_multi_enabled) {
+        for (size_t i = 0; i < N; i++) {
+            extra_hashes[ctx[i]->state[0] & 3](ctx[i]->state, 200, output + 32 * i);
+        }
+        return;
+    }
+
+    const uint8_t *in[4][N];
+    uint8_t *out[4][N];
+    size_t count[4] = {};
+    for (size_t i = 0; i < N; i++) {
+        const size_t fn = ctx[i]->state[0] & 3;
+        in[fn][count[fn]]    = ctx[i]->state;
+        out[fn][count[fn]++] = output + 32 * i;
+    }
+
+    blake256_hash_multi(out[0], in[0], 200, count[0]);
+    // groestl is table based and has no multi-buffer code
+    for (size_t i = 0; i < count[1]; i++) {
+        do_groestl_hash(in[1][i], 200, out[1][i]);
+    }
+    jh256_hash_multi(out[2], in[2], 200, count[2]);
+    xmr_skein_multi(in[3], out[3], count[3]);
+}
+// MOMINER PATCH END
+
+
 template<Algorithm::Id ALGO, bool SOFT_AES, int interleave>
 static NOINLINE void cn_explode_scratchpad(cryptonight_ctx *ctx)
 {
@@ -589,6 +644,9 @@ static inline __m128i int_sqrt_v2(const uint64_t n0)
 
 
 void v4_soft_aes_compile_code(const V4_Instruction *code, int code_size, void *machine_code, xmrig::Assembly ASM);
+// MOMINER PATCH BEGIN: generated CnR random math of 3-5 way hashes.
+void v4_compile_code_lanes(const V4_Instruction *code, int code_size, void *machine_code, xmrig::Assembly ASM);
+// MOMINER PATCH END
 
 
 alignas(64) static const uint32_t tweak1_table[256] = { 268435456,0,268435456,0,268435456,0,268435456,0,268435456,0,268435456,0,268435456,0,268435456,0,805306368,0,805306368,0,805306368,0,805306368,0,805306368,0,805306368,0,805306368,0,805306368,0,268435456,268435456,268435456,268435456,268435456,268435456,268435456,268435456,268435456,268435456,268435456,268435456,268435456,268435456,268435456,268435456,805306368,268435456,805306368,268435456,805306368,268435456,805306368,268435456,805306368,268435456,805306368,268435456,805306368,268435456,805306368,268435456,268435456,0,268435456,0,268435456,0,268435456,0,268435456,0,268435456,0,268435456,0,268435456,0,805306368,0,805306368,0,805306368,0,805306368,0,805306368,0,805306368,0,805306368,0,805306368,0,268435456,268435456,268435456,268435456,268435456,268435456,268435456,268435456,268435456,268435456,268435456,268435456,268435456,268435456,268435456,268435456,805306368,268435456,805306368,268435456,805306368,268435456,805306368,268435456,805306368,268435456,805306368,268435456,805306368,268435456,805306368,268435456,268435456,0,268435456,0,268435456,0,268435456,0,268435456,0,268435456,0,268435456,0,268435456,0,805306368,0,805306368,0,805306368,0,805306368,0,805306368,0,805306368,0,805306368,0,805306368,0,268435456,268435456,268435456,268435456,268435456,268435456,268435456,268435456,268435456,268435456,268435456,268435456,268435456,268435456,268435456,268435456,805306368,268435456,805306368,268435456,805306368,268435456,805306368,268435456,805306368,268435456,805306368,268435456,805306368,268435456,805306368,268435456,268435456,0,268435456,0,268435456,0,268435456,0,268435456,0,268435456,0,268435456,0,268435456,0,805306368,0,805306368,0,805306368,0,805306368,0,805306368,0,805306368,0,805306368,0,805306368,0,268435456,268435456,268435456,268435456,268435456,268435456,268435456,268435456,268435456,268435456,268435456,268435456,268435456,268435456,268435456,268435456,805306368,268435456,805306368,268435456,805306368,268435456,805306368,268435456,805306368,268435456,805306368,268435456,805306368,268435456,805306368,268435456 };
@@ -1059,8 +1117,9 @@ inline void cryptonight_double_hash_asm(const uint8_t *__restrict__ input, size_
         ctx[0]->generated_code_data = { ALGO, height };
     }
 
-    keccak(input,        size, ctx[0]->state);
-    keccak(input + size, size, ctx[1]->state);
+    // MOMINER PATCH BEGIN: keccak of all states of a multi-way hash is done by multi-buffer keccak.
+    cn_keccak_lanes<2>(input, size, ctx);
+    // MOMINER PATCH END
 
     if (props.half_mem()) {
         ctx[0]->first_half = true;
@@ -1126,11 +1185,13 @@ inline void cryptonight_double_hash_asm(const uint8_t *__restrict__ input, size_
         cn_implode_scratchpad<ALGO, false, 0>(ctx[1]);
     }
 
-    keccakf(reinterpret_cast<uint64_t*>(ctx[0]->state), 24);
-    keccakf(reinterpret_cast<uint64_t*>(ctx[1]->state), 24);
+    // MOMINER PATCH BEGIN: keccak of all states of a multi-way hash is done by multi-buffer keccak.
+    cn_keccakf_lanes<2>(ctx);
+    // MOMINER PATCH END
 
-    extra_hashes[ctx[0]->state[0] & 3](ctx[0]->state, 200, output);
-    extra_hashes[ctx[1]->state[0] & 3](ctx[1]->state, 200, output + 32);
+    // MOMINER PATCH BEGIN: finalizer hashes of a multi-way hash are bucketed by finalizer and done by multi-buffer code.
+    cn_extra_hashes_lanes<2>(ctx, output);
+    // MOMINER PATCH END
 }
 
 
@@ -1187,8 +1248,9 @@ static NOINLINE void cryptonight_double_hash_gr_sse41(const uint8_t *__restrict_
         return;
     }
 
-    keccak(input,        size, ctx[0]->state);
-    keccak(input + size, size, ctx[1]->state);
+    // MOMINER PATCH BEGIN: keccak of all states of a multi-way hash is done by multi-buffer keccak.
+    cn_keccak_lanes<2>(input, size, ctx);
+    // MOMINER PATCH END
 
     if (props.half_mem()) {
         ctx[0]->first_half = true;
@@ -1232,11 +1294,13 @@ static NOINLINE void cryptonight_double_hash_gr_sse41(const uint8_t *__restrict_
         cn_implode_scratchpad<ALGO, false, 0>(ctx[1]);
     }
 
-    keccakf(reinterpret_cast<uint64_t*>(ctx[0]->state), 24);
-    keccakf(reinterpret_cast<uint64_t*>(ctx[1]->state), 24);
+    // MOMINER PATCH BEGIN: keccak of all states of a multi-way hash is done by multi-buffer keccak.
+    cn_keccakf_lanes<2>(ctx);
+    // MOMINER PATCH END
 
-    extra_hashes[ctx[0]->state[0] & 3](ctx[0]->state, 200, output);
-    extra_hashes[ctx[1]->state[0] & 3](ctx[1]->state, 200, output + 32);
+    // MOMINER PATCH BEGIN: finalizer hashes of a multi-way hash are bucketed by finalizer and done by multi-buffer code.
+    cn_extra_hashes_lanes<2>(ctx, output);
+    // MOMINER PATCH END
 }
 #endif
 
@@ -1280,8 +1344,9 @@ inline void cryptonight_double_hash(const uint8_t *__restrict__ input, size_t si
         return;
     }
 
-    keccak(input,        size, ctx[0]->state);
-    keccak(input + size, size, ctx[1]->state);
+    // MOMINER PATCH BEGIN: keccak of all states of a multi-way hash is done by multi-buffer keccak.
+    cn_keccak_lanes<2>(input, size, ctx);
+    // MOMINER PATCH END
 
     uint8_t *l0  = ctx[0]->memory;
     uint8_t *l1  = ctx[1]->memory;
@@ -1516,11 +1581,13 @@ inline void cryptonight_double_hash(const uint8_t *__restrict__ input, size_t si
         cn_implode_scratchpad<ALGO, SOFT_AES, 0>(ctx[1]);
     }
 
-    keccakf(h0, 24);
-    keccakf(h1, 24);
+    // MOMINER PATCH BEGIN: keccak of all states of a multi-way hash is done by multi-buffer keccak.
+    cn_keccakf_lanes<2>(ctx);
+    // MOMINER PATCH END
 
-    extra_hashes[ctx[0]->state[0] & 3](ctx[0]->state, 200, output);
-    extra_hashes[ctx[1]->state[0] & 3](ctx[1]->state, 200, output + 32);
+    // MOMINER PATCH BEGIN: finalizer hashes of a multi-way hash are bucketed by finalizer and done by multi-buffer code.
+    cn_extra_hashes_lanes<2>(ctx, output);
+    // MOMINER PATCH END
 }
 
 
@@ -1536,10 +1603,9 @@ static NOINLINE void cryptonight_quad_hash_gr_sse41(const uint8_t* __restrict__
         return;
     }
 
-    keccak(input + size * 0, size, ctx[0]->state);
-    keccak(input + size * 1, size, ctx[1]->state);
-    keccak(input + size * 2, size, ctx[2]->state);
-    keccak(input + size * 3, size, ctx[3]->state);
+    // MOMINER PATCH BEGIN: keccak of all states of a multi-way hash is done by multi-buffer keccak.
+    cn_keccak_lanes<4>(input, size, ctx);
+    // MOMINER PATCH END
 
     if (props.half_mem()) {
         ctx[0]->first_half = true;
@@ -1590,15 +1656,13 @@ static NOINLINE void cryptonight_quad_hash_gr_sse41(const uint8_t* __restrict__
         cn_implode_scratchpad<ALGO, false, 0>(ctx[3]);
     }
 
-    keccakf(reinterpret_cast<uint64_t*>(ctx[0]->state), 24);
-    keccakf(reinterpret_cast<uint64_t*>(ctx[1]->state), 24);
-    keccakf(reinterpret_cast<uint64_t*>(ctx[2]->state), 24);
-    keccakf(reinterpret_cast<uint64_t*>(ctx[3]->state), 24);
+    // MOMINER PATCH BEGIN: keccak of all states of a multi-way hash is done by multi-buffer keccak.
+    cn_keccakf_lanes<4>(ctx);
+    // MOMINER PATCH END
 
-    extra_hashes[ctx[0]->state[0] & 3](ctx[0]->state, 200, output);
-    extra_hashes[ctx[1]->state[0] & 3](ctx[1]->state, 200, output + 32);
-    extra_hashes[ctx[2]->state[0] & 3](ctx[2]->state, 200, output + 64);
-    extra_hashes[ctx[3]->state[0] & 3](ctx[3]->state, 200, output + 96);
+    // MOMINER PATCH BEGIN: finalizer hashes of a multi-way hash are bucketed by finalizer and done by multi-buffer code.
+    cn_extra_hashes_lanes<4>(ctx, output);
+    // MOMINER PATCH END
 }
 #endif
 
@@ -1636,13 +1700,47 @@ static NOINLINE void cryptonight_quad_hash_gr_sse41(const uint8_t* __restrict__
     uint64_t ch##part = ((uint64_t*)ptr)[1];
 
 
+// MOMINER PATCH BEGIN: CnR random math of all 3-5 way hashes is done by one generated code call between CN_STEP3 and CN_STEP4.
+template<Algorithm::Id ALGO>
+static inline cn_r_math_fun_ms_abi cn_r_math_lanes(cryptonight_ctx *ctx, uint64_t height)
+{
+#   ifdef XMRIG_FEATURE_ASM
+    if (!ctx->generated_math_data.match(ALGO, height)) {
+        V4_Instruction code[256];
+        const int code_size = v4_random_math_init<ALGO>(code, height);
+        v4_compile_code_lanes(code, code_size, reinterpret_cast<void*>(ctx->generated_math), Cpu::info()->assembly());
+
+        ctx->generated_math_data = { ALGO, height };
+    }
+
+    return ctx->generated_math;
+#   else
+    return nullptr;
+#   endif
+}
+
+
+#define CN_STEP_R(part, a, b0, b1)                                                                          \
+    if (props.isR() && r_math) {                                                                            \
+        cl##part ^= (r##part[0] + r##part[1]) | (static_cast<uint64_t>(r##part[2] + r##part[3]) << 32);     \
+        r##part[4] = static_cast<uint32_t>(_mm_cvtsi128_si32(a));                                           \
+        r##part[5] = static_cast<uint32_t>(_mm_cvtsi128_si32(_mm_srli_si128(a, 8)));                        \
+        r##part[6] = static_cast<uint32_t>(_mm_cvtsi128_si32(b0));                                          \
+        r##part[7] = static_cast<uint32_t>(_mm_cvtsi128_si32(b1));                                          \
+        r##part[8] = static_cast<uint32_t>(_mm_cvtsi128_si32(_mm_srli_si128(b1, 8)));                       \
+    }
+// MOMINER PATCH END
+
+
 #define CN_STEP4(part, a, b0, b1, c, l, mc, ptr, idx)                                                       \
     uint64_t al##part, ah##part;                                                                            \
     if (BASE == Algorithm::CN_2) {                                                                          \
         if (props.isR()) {                                                                                  \
             al##part = _mm_cvtsi128_si64(a);                                                                \
             ah##part = _mm_cvtsi128_si64(_mm_srli_si128(a, 8));                                             \
-            VARIANT4_RANDOM_MATH(part, al##part, ah##part, cl##part, b0, b1);                               \
+            if (!r_math) {                                                                                  \
+                VARIANT4_RANDOM_MATH(part, al##part, ah##part, cl##part, b0, b1);                           \
+            }                                                                                               \
             if (ALGO == Algorithm::CN_R) {                                                                  \
                 al##part ^= r##part[2] | ((uint64_t)(r##part[3]) << 32);                                    \
                 ah##part ^= r##part[0] | ((uint64_t)(r##part[1]) << 32);                                    \
@@ -1736,8 +1834,10 @@ inline void cryptonight_triple_hash(const uint8_t *__restrict__ input, size_t si
         return;
     }
 
+    // MOMINER PATCH BEGIN: keccak of all states of a multi-way hash is done by multi-buffer keccak.
+    cn_keccak_lanes<3>(input, size, ctx);
+    // MOMINER PATCH END
     for (size_t i = 0; i < 3; i++) {
-        keccak(input + size * i, size, ctx[i]->state);
         if (props.half_mem()) {
             ctx[i]->first_half = true;
         }
@@ -1754,6 +1854,10 @@ inline void cryptonight_triple_hash(const uint8_t *__restrict__ input, size_t si
     CONST_INIT(ctx[0], 0);
     CONST_INIT(ctx[1], 1);
     CONST_INIT(ctx[2], 2);
+    // MOMINER PATCH BEGIN: CnR random math of all hashes is done by one generated code call.
+    const cn_r_math_fun_ms_abi r_math = props.isR() ? cn_r_math_lanes<ALGO>(ctx[0], height) : nullptr;
+    uint32_t* const r_lanes[] = { r0, r1, r2 };
+    // MOMINER PATCH END
     VARIANT2_SET_ROUNDING_MODE();
     if (ALGO == Algorithm::CN_CCX) {
         RESTORE_ROUNDING_MODE();
@@ -1780,6 +1884,15 @@ inline void cryptonight_triple_hash(const uint8_t *__restrict__ input, size_t si
         CN_STEP3(1, ax1, bx10, bx11, cx1, l1, ptr1, idx1);
         CN_STEP3(2, ax2, bx20, bx21, cx2, l2, ptr2, idx2);
 
+        // MOMINER PATCH BEGIN: CnR random math of all hashes is done by one generated code call.
+        CN_STEP_R(0, ax0, bx00, bx01);
+        CN_STEP_R(1, ax1, bx10, bx11);
+        CN_STEP_R(2, ax2, bx20, bx21);
+        if (props.isR() && r_math) {
+            r_math(r_lanes, 3);
+        }
+        // MOMINER PATCH END
+
         CN_STEP4(0, ax0, bx00, bx01, cx0, l0, mc0, ptr0, idx0);
         CN_STEP4(1, ax1, bx10, bx11, cx1, l1, mc1, ptr1, idx1);
         CN_STEP4(2, ax2, bx20, bx21, cx2, l2, mc2, ptr2, idx2);
@@ -1787,9 +1900,15 @@ inline void cryptonight_triple_hash(const uint8_t *__restrict__ input, size_t si
 
     for (size_t i = 0; i < 3; i++) {
         cn_implode_scratchpad<ALGO, SOFT_AES, 0>(ctx[i]);
-        keccakf(reinterpret_cast<uint64_t*>(ctx[i]->state), 24);
-        extra_hashes[ctx[i]->state[0] & 3](ctx[i]->state, 200, output + 32 * i);
     }
+
+    // MOMINER PATCH BEGIN: keccak of all states of a multi-way hash is done by multi-buffer keccak.
+    cn_keccakf_lanes<3>(ctx);
+    // MOMINER PATCH END
+
+    // MOMINER PATCH BEGIN: finalizer hashes of a multi-way hash are bucketed by finalizer and done by multi-buffer code.
+    cn_extra_hashes_lanes<3>(ctx, output);
+    // MOMINER PATCH END
 }
 
 
@@ -1834,8 +1953,10 @@ inline void cryptonight_quad_hash(const uint8_t *__restrict__ input, size_t size
         return;
     }
 
+    // MOMINER PATCH BEGIN: keccak of all states of a multi-way hash is done by multi-buffer keccak.
+    cn_keccak_lanes<4>(input, size, ctx);
+    // MOMINER PATCH END
     for (size_t i = 0; i < 4; i++) {
-        keccak(input + size * i, size, ctx[i]->state);
         if (props.half_mem()) {
             ctx[i]->first_half = true;
         }
@@ -1868,6 +1989,10 @@ inline void cryptonight_quad_hash(const uint8_t *__restrict__ input, size_t size
     CONST_INIT(ctx[1], 1);
     CONST_INIT(ctx[2], 2);
     CONST_INIT(ctx[3], 3);
+    // MOMINER PATCH BEGIN: CnR random math of all hashes is done by one generated code call.
+    const cn_r_math_fun_ms_abi r_math = props.isR() ? cn_r_math_lanes<ALGO>(ctx[0], height) : nullptr;
+    uint32_t* const r_lanes[] = { r0, r1, r2, r3 };
+    // MOMINER PATCH END
     VARIANT2_SET_ROUNDING_MODE();
     if (ALGO == Algorithm::CN_CCX) {
         RESTORE_ROUNDING_MODE();
@@ -1898,6 +2023,16 @@ inline void cryptonight_quad_hash(const uint8_t *__restrict__ input, size_t size
         CN_STEP3(2, ax2, bx20, bx21, cx2, l2, ptr2, idx2);
         CN_STEP3(3, ax3, bx30, bx31, cx3, l3, ptr3, idx3);
 
+        // MOMINER PATCH BEGIN: CnR random math of all hashes is done by one generated code call.
+        CN_STEP_R(0, ax0, bx00, bx01);
+        CN_STEP_R(1, ax1, bx10, bx11);
+        CN_STEP_R(2, ax2, bx20, bx21);
+        CN_STEP_R(3, ax3, bx30, bx31);
+        if (props.isR() && r_math) {
+            r_math(r_lanes, 4);
+        }
+        // MOMINER PATCH END
+
         CN_STEP4(0, ax0, bx00, bx01, cx0, l0, mc0, ptr0, idx0);
         CN_STEP4(1, ax1, bx10, bx11, cx1, l1, mc1, ptr1, idx1);
         CN_STEP4(2, ax2, bx20, bx21, cx2, l2, mc2, ptr2, idx2);
@@ -1918,10 +2053,13 @@ inline void cryptonight_quad_hash(const uint8_t *__restrict__ input, size_t size
         cn_implode_scratchpad<ALGO, SOFT_AES, 0>(ctx[3]);
     }
 
-    for (size_t i = 0; i < 4; i++) {
-        keccakf(reinterpret_cast<uint64_t*>(ctx[i]->state), 24);
-        extra_hashes[ctx[i]->state[0] & 3](ctx[i]->state, 200, output + 32 * i);
-    }
+    // MOMINER PATCH BEGIN: keccak of all states of a multi-way hash is done by multi-buffer keccak.
+    cn_keccakf_lanes<4>(ctx);
+    // MOMINER PATCH END
+
+    // MOMINER PATCH BEGIN: finalizer hashes of a multi-way hash are bucketed by finalizer and done by multi-buffer code.
+    cn_extra_hashes_lanes<4>(ctx, output);
+    // MOMINER PATCH END
 }
 
 
@@ -1945,8 +2083,10 @@ inline void cryptonight_penta_hash(const uint8_t *__restrict__ input, size_t siz
         return;
     }
 
+    // MOMINER PATCH BEGIN: keccak of all states of a multi-way hash is done by multi-buffer keccak.
+    cn_keccak_lanes<5>(input, size, ctx);
+    // MOMINER PATCH END
     for (size_t i = 0; i < 5; i++) {
-        keccak(input + size * i, size, ctx[i]->state);
         if (props.half_mem()) {
             ctx[i]->first_half = true;
         }
@@ -1969,6 +2109,10 @@ inline void cryptonight_penta_hash(const uint8_t *__restrict__ input, size_t siz
     CONST_INIT(ctx[2], 2);
     CONST_INIT(ctx[3], 3);
     CONST_INIT(ctx[4], 4);
+    // MOMINER PATCH BEGIN: CnR random math of all hashes is done by one generated code call.
+    const cn_r_math_fun_ms_abi r_math = props.isR() ? cn_r_math_lanes<ALGO>(ctx[0], height) : nullptr;
+    uint32_t* const r_lanes[] = { r0, r1, r2, r3, r4 };
+    // MOMINER PATCH END
     VARIANT2_SET_ROUNDING_MODE();
     if (ALGO == Algorithm::CN_CCX) {
         RESTORE_ROUNDING_MODE();
@@ -2003,6 +2147,17 @@ inline void cryptonight_penta_hash(const uint8_t *__restrict__ input, size_t siz
         CN_STEP3(3, ax3, bx30, bx31, cx3, l3, ptr3, idx3);
         CN_STEP3(4, ax4, bx40, bx41, cx4, l4, ptr4, idx4);
 
+        // MOMINER PATCH BEGIN: CnR random math of all hashes is done by one generated code call.
+        CN_STEP_R(0, ax0, bx00, bx01);
+        CN_STEP_R(1, ax1, bx10, bx11);
+        CN_STEP_R(2, ax2, bx20, bx21);
+        CN_STEP_R(3, ax3, bx30, bx31);
+        CN_STEP_R(4, ax4, bx40, bx41);
+        if (props.isR() && r_math) {
+            r_math(r_lanes, 5);
+        }
+        // MOMINER PATCH END
+
         CN_STEP4(0, ax0, bx00, bx01, cx0, l0, mc0, ptr0, idx0);
         CN_STEP4(1, ax1, bx10, bx11, cx1, l1, mc1, ptr1, idx1);
         CN_STEP4(2, ax2, bx20, bx21, cx2, l2, mc2, ptr2, idx2);
@@ -2012,10 +2167,458 @@ inline void cryptonight_penta_hash(const uint8_t *__restrict__ input, size_t siz
 
     for (size_t i = 0; i < 5; i++) {
         cn_implode_scratchpad<ALGO, SOFT_AES, 0>(ctx[i]);
-        keccakf(reinterpret_cast<uint64_t*>(ctx[i]->state), 24);
-        extra_hashes[ctx[i]->state[0] & 3](ctx[i]->state, 200, output + 32 * i);
     }
+
+    // MOMINER PATCH BEGIN: keccak of all states of a multi-way hash is done by multi-buffer keccak.
+    cn_keccakf_lanes<5>(ctx);
+    // MOMINER PATCH END
+
+    // MOMINER PATCH BEGIN: finalizer hashes of a multi-way hash are bucketed by finalizer and done by multi-buffer code.
+    cn_extra_hashes_lanes<5>(ctx, output);
+    // MOMINER PATCH END
+}
+
+
+// MOMINER PATCH BEGIN: 6-8 way hashes for small scratchpad algos (see ADD_FN_WIDE in CnHash.cpp).
+template<Algorithm::Id ALGO, bool SOFT_AES>
+inline void cryptonight_hexa_hash(const uint8_t *__restrict__ input, size_t size, uint8_t *__restrict__ output, cryptonight_ctx **__restrict__ ctx, uint64_t height)
+{
+    constexpr CnAlgo<ALGO> props;
+    constexpr size_t MASK        = props.mask();
+    constexpr Algorithm::Id BASE = props.base();
+
+#   ifdef XMRIG_ALGO_CN_HEAVY
+    constexpr bool IS_CN_HEAVY_TUBE = ALGO == Algorithm::CN_HEAVY_TUBE;
+    constexpr bool IS_CN_HEAVY_XHV  = ALGO == Algorithm::CN_HEAVY_XHV;
+#   else
+    constexpr bool IS_CN_HEAVY_TUBE = false;
+    constexpr bool IS_CN_HEAVY_XHV  = false;
+#   endif
+
+    if (BASE == Algorithm::CN_1 && size < 43) {
+        memset(output, 0, 32 * 6);
+        return;
+    }
+
+    cn_keccak_lanes<6>(input, size, ctx);
+    for (size_t i = 0; i < 6; i++) {
+        if (props.half_mem()) {
+            ctx[i]->first_half = true;
+        }
+    }
+
+#   ifdef XMRIG_VAES
+    if (!SOFT_AES && !props.isHeavy() && cn_vaes_enabled) {
+        for (size_t i = 0; i + 1 < 6; i += 2) {
+            cn_explode_scratchpad_vaes_double(ctx[i], ctx[i + 1], props.memory(), props.half_mem());
+        }
+    }
+    else
+#   endif
+    {
+        for (size_t i = 0; i < 6; i++) {
+            cn_explode_scratchpad<ALGO, SOFT_AES, 0>(ctx[i]);
+        }
+    }
+
+    uint8_t* l0  = ctx[0]->memory;
+    uint8_t* l1  = ctx[1]->memory;
+    uint8_t* l2  = ctx[2]->memory;
+    uint8_t* l3  = ctx[3]->memory;
+    uint8_t* l4  = ctx[4]->memory;
+    uint8_t* l5  = ctx[5]->memory;
+    uint64_t* h0 = reinterpret_cast<uint64_t*>(ctx[0]->state);
+    uint64_t* h1 = reinterpret_cast<uint64_t*>(ctx[1]->state);
+    uint64_t* h2 = reinterpret_cast<uint64_t*>(ctx[2]->state);
+    uint64_t* h3 = reinterpret_cast<uint64_t*>(ctx[3]->state);
+    uint64_t* h4 = reinterpret_cast<uint64_t*>(ctx[4]->state);
+    uint64_t* h5 = reinterpret_cast<uint64_t*>(ctx[5]->state);
+
+    CONST_INIT(ctx[0], 0);
+    CONST_INIT(ctx[1], 1);
+    CONST_INIT(ctx[2], 2);
+    CONST_INIT(ctx[3], 3);
+    CONST_INIT(ctx[4], 4);
+    CONST_INIT(ctx[5], 5);
+    const cn_r_math_fun_ms_abi r_math = props.isR() ? cn_r_math_lanes<ALGO>(ctx[0], height) : nullptr;
+    uint32_t* const r_lanes[] = { r0, r1, r2, r3, r4, r5 };
+    VARIANT2_SET_ROUNDING_MODE();
+    if (ALGO == Algorithm::CN_CCX) {
+        RESTORE_ROUNDING_MODE();
+    }
+
+    uint64_t idx0, idx1, idx2, idx3, idx4, idx5;
+    idx0 = _mm_cvtsi128_si64(ax0);
+    idx1 = _mm_cvtsi128_si64(ax1);
+    idx2 = _mm_cvtsi128_si64(ax2);
+    idx3 = _mm_cvtsi128_si64(ax3);
+    idx4 = _mm_cvtsi128_si64(ax4);
+    idx5 = _mm_cvtsi128_si64(ax5);
+
+    for (size_t i = 0; i < props.iterations(); i++) {
+        uint64_t hi, lo;
+        __m128i *ptr0, *ptr1, *ptr2, *ptr3, *ptr4, *ptr5;
+
+        CN_STEP1(ax0, bx00, bx01, cx0, l0, ptr0, idx0, conc_var0);
+        CN_STEP1(ax1, bx10, bx11, cx1, l1, ptr1, idx1, conc_var1);
+        CN_STEP1(ax2, bx20, bx21, cx2, l2, ptr2, idx2, conc_var2);
+        CN_STEP1(ax3, bx30, bx31, cx3, l3, ptr3, idx3, conc_var3);
+        CN_STEP1(ax4, bx40, bx41, cx4, l4, ptr4, idx4, conc_var4);
+        CN_STEP1(ax5, bx50, bx51, cx5, l5, ptr5, idx5, conc_var5);
+
+        CN_STEP2(ax0, bx00, bx01, cx0, l0, ptr0, idx0);
+        CN_STEP2(ax1, bx10, bx11, cx1, l1, ptr1, idx1);
+        CN_STEP2(ax2, bx20, bx21, cx2, l2, ptr2, idx2);
+        CN_STEP2(ax3, bx30, bx31, cx3, l3, ptr3, idx3);
+        CN_STEP2(ax4, bx40, bx41, cx4, l4, ptr4, idx4);
+        CN_STEP2(ax5, bx50, bx51, cx5, l5, ptr5, idx5);
+
+        CN_STEP3(0, ax0, bx00, bx01, cx0, l0, ptr0, idx0);
+        CN_STEP3(1, ax1, bx10, bx11, cx1, l1, ptr1, idx1);
+        CN_STEP3(2, ax2, bx20, bx21, cx2, l2, ptr2, idx2);
+        CN_STEP3(3, ax3, bx30, bx31, cx3, l3, ptr3, idx3);
+        CN_STEP3(4, ax4, bx40, bx41, cx4, l4, ptr4, idx4);
+        CN_STEP3(5, ax5, bx50, bx51, cx5, l5, ptr5, idx5);
+
+        CN_STEP_R(0, ax0, bx00, bx01);
+        CN_STEP_R(1, ax1, bx10, bx11);
+        CN_STEP_R(2, ax2, bx20, bx21);
+        CN_STEP_R(3, ax3, bx30, bx31);
+        CN_STEP_R(4, ax4, bx40, bx41);
+        CN_STEP_R(5, ax5, bx50, bx51);
+        if (props.isR() && r_math) {
+            r_math(r_lanes, 6);
+        }
+
+        CN_STEP4(0, ax0, bx00, bx01, cx0, l0, mc0, ptr0, idx0);
+        CN_STEP4(1, ax1, bx10, bx11, cx1, l1, mc1, ptr1, idx1);
+        CN_STEP4(2, ax2, bx20, bx21, cx2, l2, mc2, ptr2, idx2);
+        CN_STEP4(3, ax3, bx30, bx31, cx3, l3, mc3, ptr3, idx3);
+        CN_STEP4(4, ax4, bx40, bx41, cx4, l4, mc4, ptr4, idx4);
+        CN_STEP4(5, ax5, bx50, bx51, cx5, l5, mc5, ptr5, idx5);
+    }
+
+#   ifdef XMRIG_VAES
+    if (!SOFT_AES && !props.isHeavy() && cn_vaes_enabled) {
+        for (size_t i = 0; i + 1 < 6; i += 2) {
+            cn_implode_scratchpad_vaes_double(ctx[i], ctx[i + 1], props.memory(), props.half_mem());
+        }
+    }
+    else
+#   endif
+    {
+        for (size_t i = 0; i < 6; i++) {
+            cn_implode_scratchpad<ALGO, SOFT_AES, 0>(ctx[i]);
+        }
+    }
+
+    cn_keccakf_lanes<6>(ctx);
+    cn_extra_hashes_lanes<6>(ctx, output);
+}
+
+
+template<Algorithm::Id ALGO, bool SOFT_AES>
+inline void cryptonight_hepta_hash(const uint8_t *__restrict__ input, size_t size, uint8_t *__restrict__ output, cryptonight_ctx **__restrict__ ctx, uint64_t height)
+{
+    constexpr CnAlgo<ALGO> props;
+    constexpr size_t MASK        = props.mask();
+    constexpr Algorithm::Id BASE = props.base();
+
+#   ifdef XMRIG_ALGO_CN_HEAVY
+    constexpr bool IS_CN_HEAVY_TUBE = ALGO == Algorithm::CN_HEAVY_TUBE;
+    constexpr bool IS_CN_HEAVY_XHV  = ALGO == Algorithm::CN_HEAVY_XHV;
+#   else
+    constexpr bool IS_CN_HEAVY_TUBE = false;
+    constexpr bool IS_CN_HEAVY_XHV  = false;
+#   endif
+
+    if (BASE == Algorithm::CN_1 && size < 43) {
+        memset(output, 0, 32 * 7);
+        return;
+    }
+
+    cn_keccak_lanes<7>(input, size, ctx);
+    for (size_t i = 0; i < 7; i++) {
+        if (props.half_mem()) {
+            ctx[i]->first_half = true;
+        }
+    }
+
+#   ifdef XMRIG_VAES
+    if (!SOFT_AES && !props.isHeavy() && cn_vaes_enabled) {
+        for (size_t i = 0; i + 1 < 7; i += 2) {
+            cn_explode_scratchpad_vaes_double(ctx[i], ctx[i + 1], props.memory(), props.half_mem());
+        }
+        cn_explode_scratchpad<ALGO, SOFT_AES, 0>(ctx[6]);
+    }
+    else
+#   endif
+    {
+        for (size_t i = 0; i < 7; i++) {
+            cn_explode_scratchpad<ALGO, SOFT_AES, 0>(ctx[i]);
+        }
+    }
+
+    uint8_t* l0  = ctx[0]->memory;
+    uint8_t* l1  = ctx[1]->memory;
+    uint8_t* l2  = ctx[2]->memory;
+    uint8_t* l3  = ctx[3]->memory;
+    uint8_t* l4  = ctx[4]->memory;
+    uint8_t* l5  = ctx[5]->memory;
+    uint8_t* l6  = ctx[6]->memory;
+    uint64_t* h0 = reinterpret_cast<uint64_t*>(ctx[0]->state);
+    uint64_t* h1 = reinterpret_cast<uint64_t*>(ctx[1]->state);
+    uint64_t* h2 = reinterpret_cast<uint64_t*>(ctx[2]->state);
+    uint64_t* h3 = reinterpret_cast<uint64_t*>(ctx[3]->state);
+    uint64_t* h4 = reinterpret_cast<uint64_t*>(ctx[4]->state);
+    uint64_t* h5 = reinterpret_cast<uint64_t*>(ctx[5]->state);
+    uint64_t* h6 = reinterpret_cast<uint64_t*>(ctx[6]->state);
+
+    CONST_INIT(ctx[0], 0);
+    CONST_INIT(ctx[1], 1);
+    CONST_INIT(ctx[2], 2);
+    CONST_INIT(ctx[3], 3);
+    CONST_INIT(ctx[4], 4);
+    CONST_INIT(ctx[5], 5);
+    CONST_INIT(ctx[6], 6);
+    const cn_r_math_fun_ms_abi r_math = props.isR() ? cn_r_math_lanes<ALGO>(ctx[0], height) : nullptr;
+    uint32_t* const r_lanes[] = { r0, r1, r2, r3, r4, r5, r6 };
+    VARIANT2_SET_ROUNDING_MODE();
+    if (ALGO == Algorithm::CN_CCX) {
+        RESTORE_ROUNDING_MODE();
+    }
+
+    uint64_t idx0, idx1, idx2, idx3, idx4, idx5, idx6;
+    idx0 = _mm_cvtsi128_si64(ax0);
+    idx1 = _mm_cvtsi128_si64(ax1);
+    idx2 = _mm_cvtsi128_si64(ax2);
+    idx3 = _mm_cvtsi128_si64(ax3);
+    idx4 = _mm_cvtsi128_si64(ax4);
+    idx5 = _mm_cvtsi128_si64(ax5);
+    idx6 = _mm_cvtsi128_si64(ax6);
+
+    for (size_t i = 0; i < props.iterations(); i++) {
+        uint64_t hi, lo;
+        __m128i *ptr0, *ptr1, *ptr2, *ptr3, *ptr4, *ptr5, *ptr6;
+
+        CN_STEP1(ax0, bx00, bx01, cx0, l0, ptr0, idx0, conc_var0);
+        CN_STEP1(ax1, bx10, bx11, cx1, l1, ptr1, idx1, conc_var1);
+        CN_STEP1(ax2, bx20, bx21, cx2, l2, ptr2, idx2, conc_var2);
+        CN_STEP1(ax3, bx30, bx31, cx3, l3, ptr3, idx3, conc_var3);
+        CN_STEP1(ax4, bx40, bx41, cx4, l4, ptr4, idx4, conc_var4);
+        CN_STEP1(ax5, bx50, bx51, cx5, l5, ptr5, idx5, conc_var5);
+        CN_STEP1(ax6, bx60, bx61, cx6, l6, ptr6, idx6, conc_var6);
+
+        CN_STEP2(ax0, bx00, bx01, cx0, l0, ptr0, idx0);
+        CN_STEP2(ax1, bx10, bx11, cx1, l1, ptr1, idx1);
+        CN_STEP2(ax2, bx20, bx21, cx2, l2, ptr2, idx2);
+        CN_STEP2(ax3, bx30, bx31, cx3, l3, ptr3, idx3);
+        CN_STEP2(ax4, bx40, bx41, cx4, l4, ptr4, idx4);
+        CN_STEP2(ax5, bx50, bx51, cx5, l5, ptr5, idx5);
+        CN_STEP2(ax6, bx60, bx61, cx6, l6, ptr6, idx6);
+
+        CN_STEP3(0, ax0, bx00, bx01, cx0, l0, ptr0, idx0);
+        CN_STEP3(1, ax1, bx10, bx11, cx1, l1, ptr1, idx1);
+        CN_STEP3(2, ax2, bx20, bx21, cx2, l2, ptr2, idx2);
+        CN_STEP3(3, ax3, bx30, bx31, cx3, l3, ptr3, idx3);
+        CN_STEP3(4, ax4, bx40, bx41, cx4, l4, ptr4, idx4);
+        CN_STEP3(5, ax5, bx50, bx51, cx5, l5, ptr5, idx5);
+        CN_STEP3(6, ax6, bx60, bx61, cx6, l6, ptr6, idx6);
+
+        CN_STEP_R(0, ax0, bx00, bx01);
+        CN_STEP_R(1, ax1, bx10, bx11);
+        CN_STEP_R(2, ax2, bx20, bx21);
+        CN_STEP_R(3, ax3, bx30, bx31);
+        CN_STEP_R(4, ax4, bx40, bx41);
+        CN_STEP_R(5, ax5, bx50, bx51);
+        CN_STEP_R(6, ax6, bx60, bx61);
+        if (props.isR() && r_math) {
+            r_math(r_lanes, 7);
+        }
+
+        CN_STEP4(0, ax0, bx00, bx01, cx0, l0, mc0, ptr0, idx0);
+        CN_STEP4(1, ax1, bx10, bx11, cx1, l1, mc1, ptr1, idx1);
+        CN_STEP4(2, ax2, bx20, bx21, cx2, l2, mc2, ptr2, idx2);
+        CN_STEP4(3, ax3, bx30, bx31, cx3, l3, mc3, ptr3, idx3);
+        CN_STEP4(4, ax4, bx40, bx41, cx4, l4, mc4, ptr4, idx4);
+        CN_STEP4(5, ax5, bx50, bx51, cx5, l5, mc5, ptr5, idx5);
+        CN_STEP4(6, ax6, bx60, bx61, cx6, l6, mc6, ptr6, idx6);
+    }
+
+#   ifdef XMRIG_VAES
+    if (!SOFT_AES && !props.isHeavy() && cn_vaes_enabled) {
+        for (size_t i = 0; i + 1 < 7; i += 2) {
+            cn_implode_scratchpad_vaes_double(ctx[i], ctx[i + 1], props.memory(), props.half_mem());
+        }
+        cn_implode_scratchpad<ALGO, SOFT_AES, 0>(ctx[6]);
+    }
+    else
+#   endif
+    {
+        for (size_t i = 0; i < 7; i++) {
+            cn_implode_scratchpad<ALGO, SOFT_AES, 0>(ctx[i]);
+        }
+    }
+
+    cn_keccakf_lanes<7>(ctx);
+    cn_extra_hashes_lanes<7>(ctx, output);
+}
+
+
+template<Algorithm::Id ALGO, bool SOFT_AES>
+inline void cryptonight_octa_hash(const uint8_t *__restrict__ input, size_t size, uint8_t *__restrict__ output, cryptonight_ctx **__restrict__ ctx, uint64_t height)
+{
+    constexpr CnAlgo<ALGO> props;
+    constexpr size_t MASK        = props.mask();
+    constexpr Algorithm::Id BASE = props.base();
+
+#   ifdef XMRIG_ALGO_CN_HEAVY
+    constexpr bool IS_CN_HEAVY_TUBE = ALGO == Algorithm::CN_HEAVY_TUBE;
+    constexpr bool IS_CN_HEAVY_XHV  = ALGO == Algorithm::CN_HEAVY_XHV;
+#   else
+    constexpr bool IS_CN_HEAVY_TUBE = false;
+    constexpr bool IS_CN_HEAVY_XHV  = false;
+#   endif
+
+    if (BASE == Algorithm::CN_1 && size < 43) {
+        memset(output, 0, 32 * 8);
+        return;
+    }
+
+    cn_keccak_lanes<8>(input, size, ctx);
+    for (size_t i = 0; i < 8; i++) {
+        if (props.half_mem()) {
+            ctx[i]->first_half = true;
+        }
+    }
+
+#   ifdef XMRIG_VAES
+    if (!SOFT_AES && !props.isHeavy() && cn_vaes_enabled) {
+        for (size_t i = 0; i + 1 < 8; i += 2) {
+            cn_explode_scratchpad_vaes_double(ctx[i], ctx[i + 1], props.memory(), props.half_mem());
+        }
+    }
+    else
+#   endif
+    {
+        for (size_t i = 0; i < 8; i++) {
+            cn_explode_scratchpad<ALGO, SOFT_AES, 0>(ctx[i]);
+        }
+    }
+
+    uint8_t* l0  = ctx[0]->memory;
+    uint8_t* l1  = ctx[1]->memory;
+    uint8_t* l2  = ctx[2]->memory;
+    uint8_t* l3  = ctx[3]->memory;
+    uint8_t* l4  = ctx[4]->memory;
+    uint8_t* l5  = ctx[5]->memory;
+    uint8_t* l6  = ctx[6]->memory;
+    uint8_t* l7  = ctx[7]->memory;
+    uint64_t* h0 = reinterpret_cast<uint64_t*>(ctx[0]->state);
+    uint64_t* h1 = reinterpret_cast<uint64_t*>(ctx[1]->state);
+    uint64_t* h2 = reinterpret_cast<uint64_t*>(ctx[2]->state);
+    uint64_t* h3 = reinterpret_cast<uint64_t*>(ctx[3]->state);
+    uint64_t* h4 = reinterpret_cast<uint64_t*>(ctx[4]->state);
+    uint64_t* h5 = reinterpret_cast<uint64_t*>(ctx[5]->state);
+    uint64_t* h6 = reinterpret_cast<uint64_t*>(ctx[6]->state);
+    uint64_t* h7 = reinterpret_cast<uint64_t*>(ctx[7]->state);
+
+    CONST_INIT(ctx[0], 0);
+    CONST_INIT(ctx[1], 1);
+    CONST_INIT(ctx[2], 2);
+    CONST_INIT(ctx[3], 3);
+    CONST_INIT(ctx[4], 4);
+    CONST_INIT(ctx[5], 5);
+    CONST_INIT(ctx[6], 6);
+    CONST_INIT(ctx[7], 7);
+    const cn_r_math_fun_ms_abi r_math = props.isR() ? cn_r_math_lanes<ALGO>(ctx[0], height) : nullptr;
+    uint32_t* const r_lanes[] = { r0, r1, r2, r3, r4, r5, r6, r7 };
+    VARIANT2_SET_ROUNDING_MODE();
+    if (ALGO == Algorithm::CN_CCX) {
+        RESTORE_ROUNDING_MODE();
+    }
+
+    uint64_t idx0, idx1, idx2, idx3, idx4, idx5, idx6, idx7;
+    idx0 = _mm_cvtsi128_si64(ax0);
+    idx1 = _mm_cvtsi128_si64(ax1);
+    idx2 = _mm_cvtsi128_si64(ax2);
+    idx3 = _mm_cvtsi128_si64(ax3);
+    idx4 = _mm_cvtsi128_si64(ax4);
+    idx5 = _mm_cvtsi128_si64(ax5);
+    idx6 = _mm_cvtsi128_si64(ax6);
+    idx7 = _mm_cvtsi128_si64(ax7);
+
+    for (size_t i = 0; i < props.iterations(); i++) {
+        uint64_t hi, lo;
+        __m128i *ptr0, *ptr1, *ptr2, *ptr3, *ptr4, *ptr5, *ptr6, *ptr7;
+
+        CN_STEP1(ax0, bx00, bx01, cx0, l0, ptr0, idx0, conc_var0);
+        CN_STEP1(ax1, bx10, bx11, cx1, l1, ptr1, idx1, conc_var1);
+        CN_STEP1(ax2, bx20, bx21, cx2, l2, ptr2, idx2, conc_var2);
+        CN_STEP1(ax3, bx30, bx31, cx3, l3, ptr3, idx3, conc_var3);
+        CN_STEP1(ax4, bx40, bx41, cx4, l4, ptr4, idx4, conc_var4);
+        CN_STEP1(ax5, bx50, bx51, cx5, l5, ptr5, idx5, conc_var5);
+        CN_STEP1(ax6, bx60, bx61, cx6, l6, ptr6, idx6, conc_var6);
+        CN_STEP1(ax7, bx70, bx71, cx7, l7, ptr7, idx7, conc_var7);
+
+        CN_STEP2(ax0, bx00, bx01, cx0, l0, ptr0, idx0);
+        CN_STEP2(ax1, bx10, bx11, cx1, l1, ptr1, idx1);
+        CN_STEP2(ax2, bx20, bx21, cx2, l2, ptr2, idx2);
+        CN_STEP2(ax3, bx30, bx31, cx3, l3, ptr3, idx3);
+        CN_STEP2(ax4, bx40, bx41, cx4, l4, ptr4, idx4);
+        CN_STEP2(ax5, bx50, bx51, cx5, l5, ptr5, idx5);
+        CN_STEP2(ax6, bx60, bx61, cx6, l6, ptr6, idx6);
+        CN_STEP2(ax7, bx70, bx71, cx7, l7, ptr7, idx7);
+
+        CN_STEP3(0, ax0, bx00, bx01, cx0, l0, ptr0, idx0);
+        CN_STEP3(1, ax1, bx10, bx11, cx1, l1, ptr1, idx1);
+        CN_STEP3(2, ax2, bx20, bx21, cx2, l2, ptr2, idx2);
+        CN_STEP3(3, ax3, bx30, bx31, cx3, l3, ptr3, idx3);
+        CN_STEP3(4, ax4, bx40, bx41, cx4, l4, ptr4, idx4);
+        CN_STEP3(5, ax5, bx50, bx51, cx5, l5, ptr5, idx5);
+        CN_STEP3(6, ax6, bx60, bx61, cx6, l6, ptr6, idx6);
+        CN_STEP3(7, ax7, bx70, bx71, cx7, l7, ptr7, idx7);
+
+        CN_STEP_R(0, ax0, bx00, bx01);
+        CN_STEP_R(1, ax1, bx10, bx11);
+        CN_STEP_R(2, ax2, bx20, bx21);
+        CN_STEP_R(3, ax3, bx30, bx31);
+        CN_STEP_R(4, ax4, bx40, bx41);
+        CN_STEP_R(5, ax5, bx50, bx51);
+        CN_STEP_R(6, ax6, bx60, bx61);
+        CN_STEP_R(7, ax7, bx70, bx71);
+        if (props.isR() && r_math) {
+            r_math(r_lanes, 8);
+        }
+
+        CN_STEP4(0, ax0, bx00, bx01, cx0, l0, mc0, ptr0, idx0);
+        CN_STEP4(1, ax1, bx10, bx11, cx1, l1, mc1, ptr1, idx1);
+        CN_STEP4(2, ax2, bx20, bx21, cx2, l2, mc2, ptr2, idx2);
+        CN_STEP4(3, ax3, bx30, bx31, cx3, l3, mc3, ptr3, idx3);
+        CN_STEP4(4, ax4, bx40, bx41, cx4, l4, mc4, ptr4, idx4);
+        CN_STEP4(5, ax5, bx50, bx51, cx5, l5, mc5, ptr5, idx5);
+        CN_STEP4(6, ax6, bx60, bx61, cx6, l6, mc6, ptr6, idx6);
+        CN_STEP4(7, ax7, bx70, bx71, cx7, l7, mc7, ptr7, idx7);
+    }
+
+#   ifdef XMRIG_VAES
+    if (!SOFT_AES && !props.isHeavy() && cn_vaes_enabled) {
+        for (size_t i = 0; i + 1 < 8; i += 2) {
+            cn_implode_scratchpad_vaes_double(ctx[i], ctx[i + 1], props.memory(), props.half_mem());
+        }
+    }
+    else
+#   endif
+    {
+        for (size_t i = 0; i < 8; i++) {
+            cn_implode_scratchpad<ALGO, SOFT_AES, 0>(ctx[i]);
+        }
+    }
+
+    cn_keccakf_lanes<8>(ctx);
+    cn_extra_hashes_lanes<8>(ctx, output);
 }
+// MOMINER PATCH END
 
 
 } /* namespace xmrig */
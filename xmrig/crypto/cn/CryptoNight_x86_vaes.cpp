@@ -159,6 +159,170 @@ static FORCEINLINE void vaes_round(__m256i key, __m256i& x0, __m256i& x1, __m256
 }
 
 
+// MOMINER PATCH BEGIN: VAES-512 double hash explode/implode keeps 8 AES lanes of each hash in two zmm registers,
+// so scratchpad lines are loaded and stored whole instead of being split between two hashes like in VAES-256 code.
+#if defined(__AVX512F__) || defined(_MSC_VER)
+#   define XMRIG_VAES512
+
+
+// round keys use zero masked broadcasts with full mask: same instruction as unmasked broadcast that passes undefined
+// source operand GCC reports as uninitialized
+static NOINLINE void vaes512_genkey(const __m128i* memory, __m512i (&k)[10])
+{
+    __m128i xout0 = _mm_load_si128(memory);
+    __m128i xout2 = _mm_load_si128(memory + 1);
+    k[0] = _mm512_maskz_broadcast_i32x4(0xFFFF, xout0);
+    k[1] = _mm512_maskz_broadcast_i32x4(0xFFFF, xout2);
+
+    aes_genkey_sub<0x01>(&xout0, &xout2);
+    k[2] = _mm512_maskz_broadcast_i32x4(0xFFFF, xout0);
+    k[3] = _mm512_maskz_broadcast_i32x4(0xFFFF, xout2);
+
+    aes_genkey_sub<0x02>(&xout0, &xout2);
+    k[4] = _mm512_maskz_broadcast_i32x4(0xFFFF, xout0);
+    k[5] = _mm512_maskz_broadcast_i32x4(0xFFFF, xout2);
+
+    aes_genkey_sub<0x04>(&xout0, &xout2);
+    k[6] = _mm512_maskz_broadcast_i32x4(0xFFFF, xout0);
+    k[7] = _mm512_maskz_broadcast_i32x4(0xFFFF, xout2);
+
+    aes_genkey_sub<0x08>(&xout0, &xout2);
+    k[8] = _mm512_maskz_broadcast_i32x4(0xFFFF, xout0);
+    k[9] = _mm512_maskz_broadcast_i32x4(0xFFFF, xout2);
+}
+
+
+static FORCEINLINE void vaes512_rounds(const __m512i (&k1)[10], const __m512i (&k2)[10], __m512i& x10, __m512i& x11, __m512i& x20, __m512i& x21)
+{
+    for (int i = 0; i < 10; ++i) {
+        x10 = _mm512_aesenc_epi128(x10, k1[i]);
+        x11 = _mm512_aesenc_epi128(x11, k1[i]);
+        x20 = _mm512_aesenc_epi128(x20, k2[i]);
+        x21 = _mm512_aesenc_epi128(x21, k2[i]);
+    }
+}
+
+
+static NOINLINE void cn_explode_scratchpad_vaes512_double(cryptonight_ctx* ctx1, cryptonight_ctx* ctx2, size_t memory, bool half_mem)
+{
+    const size_t N = (memory / sizeof(__m512i)) / (half_mem ? 2 : 1);
+
+    __m512i k1[10], k2[10];
+    vaes512_genkey(reinterpret_cast<const __m128i*>(ctx1->state), k1);
+    vaes512_genkey(reinterpret_cast<const __m128i*>(ctx2->state), k2);
+
+    const bool b = half_mem && !ctx1->first_half && !ctx2->first_half;
+    const __m512i* p1 = b ? reinterpret_cast<const __m512i*>(ctx1->save_state) : reinterpret_cast<const __m512i*>(ctx1->state + 64);
+    const __m512i* p2 = b ? reinterpret_cast<const __m512i*>(ctx2->save_state) : reinterpret_cast<const __m512i*>(ctx2->state + 64);
+    __m512i x10 = _mm512_loadu_si512(p1 + 0);
+    __m512i x11 = _mm512_loadu_si512(p1 + 1);
+    __m512i x20 = _mm512_loadu_si512(p2 + 0);
+    __m512i x21 = _mm512_loadu_si512(p2 + 1);
+
+    __m512i* output1 = reinterpret_cast<__m512i*>(ctx1->memory);
+    __m512i* output2 = reinterpret_cast<__m512i*>(ctx2->memory);
+
+    constexpr int prefetch_dist = 2048 / sizeof(__m512i);
+
+    __m512i* e = output1 + N - prefetch_dist;
+    __m512i* prefetch_ptr1 = output1 + prefetch_dist;
+    __m512i* prefetch_ptr2 = output2 + prefetch_dist;
+
+    for (int i = 0; i < 2; ++i) {
+        do {
+            _mm_prefetch((const char*)(prefetch_ptr1), _MM_HINT_T0);
+            _mm_prefetch((const char*)(prefetch_ptr1 + 1), _MM_HINT_T0);
+            _mm_prefetch((const char*)(prefetch_ptr2), _MM_HINT_T0);
+            _mm_prefetch((const char*)(prefetch_ptr2 + 1), _MM_HINT_T0);
+
+            vaes512_rounds(k1, k2, x10, x11, x20, x21);
+
+            _mm512_storeu_si512(output1 + 0, x10);
+            _mm512_storeu_si512(output1 + 1, x11);
+            _mm512_storeu_si512(output2 + 0, x20);
+            _mm512_storeu_si512(output2 + 1, x21);
+
+            output1 += 2;
+            prefetch_ptr1 += 2;
+            output2 += 2;
+            prefetch_ptr2 += 2;
+        } while (output1 < e);
+        e += prefetch_dist;
+        prefetch_ptr1 = output1;
+        prefetch_ptr2 = output2;
+    }
+
+    if (half_mem && ctx1->first_half && ctx2->first_half) {
+        __m512i* s1 = reinterpret_cast<__m512i*>(ctx1->save_state);
+        __m512i* s2 = reinterpret_cast<__m512i*>(ctx2->save_state);
+        _mm512_storeu_si512(s1 + 0, x10);
+        _mm512_storeu_si512(s1 + 1, x11);
+        _mm512_storeu_si512(s2 + 0, x20);
+        _mm512_storeu_si512(s2 + 1, x21);
+    }
+
+    _mm256_zeroupper();
+}
+
+
+static NOINLINE void cn_implode_scratchpad_vaes512_double(cryptonight_ctx* ctx1, cryptonight_ctx* ctx2, size_t memory, bool half_mem)
+{
+    const size_t N = (memory / sizeof(__m512i)) / (half_mem ? 2 : 1);
+
+    __m512i k1[10], k2[10];
+    vaes512_genkey(reinterpret_cast<const __m128i*>(ctx1->state) + 2, k1);
+    vaes512_genkey(reinterpret_cast<const __m128i*>(ctx2->state) + 2, k2);
+
+    __m512i* output1 = reinterpret_cast<__m512i*>(ctx1->state + 64);
+    __m512i* output2 = reinterpret_cast<__m512i*>(ctx2->state + 64);
+    __m512i x10 = _mm512_loadu_si512(output1 + 0);
+    __m512i x11 = _mm512_loadu_si512(output1 + 1);
+    __m512i x20 = _mm512_loadu_si512(output2 + 0);
+    __m512i x21 = _mm512_loadu_si512(output2 + 1);
+
+    for (size_t part = 0; part < (half_mem ? 2 : 1); ++part) {
+        if (half_mem && (part == 1)) {
+            ctx1->first_half = false;
+            ctx2->first_half = false;
+            cn_explode_scratchpad_vaes512_double(ctx1, ctx2, memory, half_mem);
+        }
+
+        const __m512i* input1 = reinterpret_cast<const __m512i*>(ctx1->memory);
+        const __m512i* input2 = reinterpret_cast<const __m512i*>(ctx2->memory);
+
+        for (size_t i = 0; i < N; i += 2) {
+            x10 = _mm512_xor_si512(x10, _mm512_loadu_si512(input1 + 0));
+            x11 = _mm512_xor_si512(x11, _mm512_loadu_si512(input1 + 1));
+            x20 = _mm512_xor_si512(x20, _mm512_loadu_si512(input2 + 0));
+            x21 = _mm512_xor_si512(x21, _mm512_loadu_si512(input2 + 1));
+
+            input1 += 2;
+            input2 += 2;
+
+            if (i + 2 < N) {
+                _mm_prefetch((const char*)(input1), _MM_HINT_T0);
+                _mm_prefetch((const char*)(input1 + 1), _MM_HINT_T0);
+                _mm_prefetch((const char*)(input2), _MM_HINT_T0);
+                _mm_prefetch((const char*)(input2 + 1), _MM_HINT_T0);
+            }
+
+            vaes512_rounds(k1, k2, x10, x11, x20, x21);
+        }
+    }
+
+    _mm512_storeu_si512(output1 + 0, x10);
+    _mm512_storeu_si512(output1 + 1, x11);
+    _mm512_storeu_si512(output2 + 0, x20);
+    _mm512_storeu_si512(output2 + 1, x21);
+
+    _mm256_zeroupper();
+}
+
+
+#endif
+// MOMINER PATCH END
+
+
 namespace xmrig {
 
 
@@ -237,6 +401,15 @@ NOINLINE void cn_explode_scratchpad_vaes(cryptonight_ctx* ctx, size_t memory, bo
 
 NOINLINE void cn_explode_scratchpad_vaes_double(cryptonight_ctx* ctx1, cryptonight_ctx* ctx2, size_t memory, bool half_mem)
 {
+    // MOMINER PATCH BEGIN: VAES-512 double hash explode.
+#   ifdef XMRIG_VAES512
+    if (cn_vaes512_enabled) {
+        cn_explode_scratchpad_vaes512_double(ctx1, ctx2, memory, half_mem);
+        return;
+    }
+#   endif
+    // MOMINER PATCH END
+
     const size_t N = (memory / sizeof(__m128i)) / (half_mem ? 2 : 1);
 
     __m256i xin0, xin1, xin2, xin3, xin4, xin5, xin6, xin7;
@@ -392,6 +565,15 @@ NOINLINE void cn_implode_scratchpad_vaes(cryptonight_ctx* ctx, size_t memory, bo
 
 NOINLINE void cn_implode_scratchpad_vaes_double(cryptonight_ctx* ctx1, cryptonight_ctx* ctx2, size_t memory, bool half_mem)
 {
+    // MOMINER PATCH BEGIN: VAES-512 double hash implode.
+#   ifdef XMRIG_VAES512
+    if (cn_vaes512_enabled) {
+        cn_implode_scratchpad_vaes512_double(ctx1, ctx2, memory, half_mem);
+        return;
+    }
+#   endif
+    // MOMINER PATCH END
+
     const size_t N = (memory / sizeof(__m128i)) / (half_mem ? 2 : 1);
 
     __m256i xout0, xout1, xout2, xout3, xout4, xout5, xout6, xout7;
@@ -324,3 +324,103 @@ void hmac_blake224_hash(uint8_t *out, const uint8_t *key, uint64_t keylen, const
     hmac_blake224_update(&S, in, inlen * 8);
     hmac_blake224_final(&S, out);
 }
+
+/* MOMINER PATCH BEGIN: multi-buffer blake256 of CryptoNight hash ways (8 messages of the same length per AVX2 pass). */
+#if defined(HAVE_AVX2)
+#include <immintrin.h>
+
+#define MB_ROT16(x) _mm256_shuffle_epi8((x), _mm256_setr_epi8(2,3,0,1,6,7,4,5,10,11,8,9,14,15,12,13,2,3,0,1,6,7,4,5,10,11,8,9,14,15,12,13))
+#define MB_ROT8(x)  _mm256_shuffle_epi8((x), _mm256_setr_epi8(1,2,3,0,5,6,7,4,9,10,11,8,13,14,15,12,1,2,3,0,5,6,7,4,9,10,11,8,13,14,15,12))
+#define MB_ROT(x,n) _mm256_or_si256(_mm256_srli_epi32((x), (n)), _mm256_slli_epi32((x), 32 - (n)))
+
+/* block k of padded message of inlen bytes */
+static void blake256_pad_block(uint8_t *blk, const uint8_t *in, uint64_t inlen, uint64_t k, uint64_t blocks) {
+    const uint64_t off = k * 64, bits = inlen * 8;
+    memset(blk, 0, 64);
+    if (off < inlen) memcpy(blk, in + off, inlen - off < 64 ? inlen - off : 64);
+    if (inlen >= off && inlen < off + 64) blk[inlen - off] |= 0x80;
+    if (k == blocks - 1) {
+        blk[55] |= 0x01;
+        U32TO8(blk + 56, (uint32_t)(bits >> 32));
+        U32TO8(blk + 60, (uint32_t)bits);
+    }
+}
+
+static void blake256_hash_x8(uint8_t *const *out, const uint8_t *const *in, uint64_t inlen) {
+    const uint64_t blocks = (inlen + 9 + 63) / 64;
+    __m256i h[8], v[16], m[16];
+    uint32_t i, j;
+    h[0] = _mm256_set1_epi32(0x6A09E667); h[1] = _mm256_set1_epi32(0xBB67AE85);
+    h[2] = _mm256_set1_epi32(0x3C6EF372); h[3] = _mm256_set1_epi32(0xA54FF53A);
+    h[4] = _mm256_set1_epi32(0x510E527F); h[5] = _mm256_set1_epi32(0x9B05688C);
+    h[6] = _mm256_set1_epi32(0x1F83D9AB); h[7] = _mm256_set1_epi32(0x5BE0CD19);
+
+    for (uint64_t k = 0; k < blocks; ++k) {
+        /* counter of message bits up to this block (0 for padding only blocks) */
+        const uint64_t t = k * 64 < inlen ? ((k + 1) * 512 < inlen * 8 ? (k + 1) * 512 : inlen * 8) : 0;
+        uint8_t blk[8][64];
+        for (j = 0; j < 8; ++j) blake256_pad_block(blk[j], in[j], inlen, k, blocks);
+        for (i = 0; i < 16; ++i) {
+            m[i] = _mm256_setr_epi32(U8TO32(blk[0] + i * 4), U8TO32(blk[1] + i * 4), U8TO32(blk[2] + i * 4), U8TO32(blk[3] + i * 4),
+                                     U8TO32(blk[4] + i * 4), U8TO32(blk[5] + i * 4), U8TO32(blk[6] + i * 4), U8TO32(blk[7] + i * 4));
+        }
+        for (i = 0; i < 8; ++i) v[i] = h[i];
+        for (i = 0; i < 8; ++i) v[i + 8] = _mm256_set1_epi32(cst[i]);
+        v[12] = _mm256_xor_si256(v[12], _mm256_set1_epi32((uint32_t)t));
+        v[13] = _mm256_xor_si256(v[13], _mm256_set1_epi32((uint32_t)t));
+        v[14] = _mm256_xor_si256(v[14], _mm256_set1_epi32((uint32_t)(t >> 32)));
+        v[15] = _mm256_xor_si256(v[15], _mm256_set1_epi32((uint32_t)(t >> 32)));
+
+#define MB_G(a,b,c,d,e)                                                                                  \
+        v[a] = _mm256_add_epi32(_mm256_add_epi32(v[a], v[b]),                                            \
+                                _mm256_xor_si256(m[sigma[i][e]], _mm256_set1_epi32(cst[sigma[i][e+1]]))); \
+        v[d] = MB_ROT16(_mm256_xor_si256(v[d], v[a]));                                                   \
+        v[c] = _mm256_add_epi32(v[c], v[d]);                                                             \
+        v[b] = MB_ROT(_mm256_xor_si256(v[b], v[c]), 12);                                                 \
+        v[a] = _mm256_add_epi32(_mm256_add_epi32(v[a], v[b]),                                            \
+                                _mm256_xor_si256(m[sigma[i][e+1]], _mm256_set1_epi32(cst[sigma[i][e]]))); \
+        v[d] = MB_ROT8(_mm256_xor_si256(v[d], v[a]));                                                    \
+        v[c] = _mm256_add_epi32(v[c], v[d]);                                                             \
+        v[b] = MB_ROT(_mm256_xor_si256(v[b], v[c]), 7);
+
+        for (i = 0; i < 14; ++i) {
+            MB_G(0, 4,  8, 12,  0);
+            MB_G(1, 5,  9, 13,  2);
+            MB_G(2, 6, 10, 14,  4);
+            MB_G(3, 7, 11, 15,  6);
+            MB_G(3, 4,  9, 14, 14);
+            MB_G(2, 7,  8, 13, 12);
+            MB_G(0, 5, 10, 15,  8);
+            MB_G(1, 6, 11, 12, 10);
+        }
+#undef MB_G
+
+        for (i = 0; i < 8; ++i) h[i] = _mm256_xor_si256(h[i], _mm256_xor_si256(v[i], v[i + 8]));
+    }
+
+    for (i = 0; i < 8; ++i) {
+        uint32_t w[8];
+        _mm256_storeu_si256((__m256i *)w, h[i]);
+        for (j = 0; j < 8; ++j) { U32TO8(out[j] + i * 4, w[j]); }
+    }
+}
+#endif
+
+void blake256_hash_multi(uint8_t *const *out, const uint8_t *const *in, uint64_t inlen, size_t n) {
+    size_t i = 0;
+#if defined(HAVE_AVX2)
+    /* 8 lane pass is only faster than scalar code for 3+ messages */
+    for (; i + 2 < n; i += 8) {
+        /* missing lanes repeat the last message and their hashes are dropped */
+        const uint8_t *lane_in[8];
+        uint8_t *lane_out[8], dummy[8][32];
+        for (size_t j = 0; j < 8; ++j) {
+            lane_in[j]  = i + j < n ? in[i + j]  : in[n - 1];
+            lane_out[j] = i + j < n ? out[i + j] : dummy[j];
+        }
+        blake256_hash_x8(lane_out, lane_in, inlen);
+    }
+#endif
+    for (; i < n; ++i) blake256_hash(out[i], in[i], inlen);
+}
+/* MOMINER PATCH END */
@@ -40,4 +40,9 @@ void hmac_blake224_final(hmac_state *, uint8_t *);
 void hmac_blake256_hash(uint8_t *, const uint8_t *, uint64_t, const uint8_t *, uint64_t);
 void hmac_blake224_hash(uint8_t *, const uint8_t *, uint64_t, const uint8_t *, uint64_t);
 
+/* MOMINER PATCH BEGIN: multi-buffer blake256 of CryptoNight hash ways. */
+#include <stddef.h>
+void blake256_hash_multi(uint8_t *const *, const uint8_t *const *, uint64_t, size_t);
+/* MOMINER PATCH END */
+
 #endif /* _BLAKE256_H_ */
@@ -214,7 +214,10 @@ static void E8(hashState *state)
 static void F8(hashState *state)
 {
       uint64_t* x = (uint64_t*)state->x;
-      const uint64_t* buf = (uint64*)state->buffer;
+      /* MOMINER PATCH BEGIN: byte buffer is loaded with memcpy as reading it through uint64 pointer breaks strict aliasing once jh_hash is inlined. */
+      uint64_t buf[8];
+      memcpy(buf, state->buffer, sizeof(buf));
+      /* MOMINER PATCH END */
 
       /*xor the 512-bit message with the fist half of the 1024-bit hash state*/
       for (int i = 0; i < 8; ++i) x[i] ^= buf[i];
@@ -367,3 +370,129 @@ HashReturn jh_hash(int hashbitlen, const BitSequence *data,DataLength databitlen
       else
             return(BAD_HASHLEN);
 }
+
+/* MOMINER PATCH BEGIN: multi-buffer jh256 of CryptoNight hash ways (4 messages of the same length per AVX2 pass). */
+#if defined(HAVE_AVX2)
+#include <immintrin.h>
+
+#define MB_SWAP(x,mask,n) (x) = _mm256_or_si256(_mm256_slli_epi64(_mm256_and_si256((x), _mm256_set1_epi64x(mask)), (n)), \
+                                                _mm256_and_si256(_mm256_srli_epi64((x), (n)), _mm256_set1_epi64x(mask)));
+#define MB_SWAP1(x)  MB_SWAP(x, 0x5555555555555555ULL, 1)
+#define MB_SWAP2(x)  MB_SWAP(x, 0x3333333333333333ULL, 2)
+#define MB_SWAP4(x)  MB_SWAP(x, 0x0f0f0f0f0f0f0f0fULL, 4)
+#define MB_SWAP8(x)  MB_SWAP(x, 0x00ff00ff00ff00ffULL, 8)
+#define MB_SWAP16(x) MB_SWAP(x, 0x0000ffff0000ffffULL, 16)
+#define MB_SWAP32(x) (x) = _mm256_shuffle_epi32((x), 0xB1);
+
+#define MB_XOR(a,b)    _mm256_xor_si256((a), (b))
+#define MB_AND(a,b)    _mm256_and_si256((a), (b))
+#define MB_ANDNOT(a,b) _mm256_andnot_si256((a), (b)) /* ~a & b */
+
+#define MB_L(m0,m1,m2,m3,m4,m5,m6,m7) \
+      m4 = MB_XOR(m4, m1);            \
+      m5 = MB_XOR(m5, m2);            \
+      m6 = MB_XOR(MB_XOR(m6, m0), m3); \
+      m7 = MB_XOR(m7, m0);            \
+      m0 = MB_XOR(m0, m5);            \
+      m1 = MB_XOR(m1, m6);            \
+      m2 = MB_XOR(MB_XOR(m2, m4), m7); \
+      m3 = MB_XOR(m3, m4);
+
+/* one of the two sboxes of SS */
+#define MB_S(m0,m1,m2,m3,cc)                          \
+      m3 = MB_XOR(m3, ones);                          \
+      m0 = MB_XOR(m0, MB_ANDNOT(m2, cc));             \
+      temp = MB_XOR(cc, MB_AND(m0, m1));              \
+      m0 = MB_XOR(m0, MB_AND(m2, m3));                \
+      m3 = MB_XOR(m3, MB_ANDNOT(m1, m2));             \
+      m1 = MB_XOR(m1, MB_AND(m0, m2));                \
+      m2 = MB_XOR(m2, MB_ANDNOT(m3, m0));             \
+      m0 = MB_XOR(m0, _mm256_or_si256(m1, m3));       \
+      m3 = MB_XOR(m3, MB_AND(m1, m2));                \
+      m1 = MB_XOR(m1, MB_AND(temp, m0));              \
+      m2 = MB_XOR(m2, temp);
+
+/* x[2 * row + column] of 4 states */
+#define MB_ROUND(r, SWAPN)                                                                            \
+      for (i = 0; i < 2; i++) {                                                                       \
+            const __m256i cc0 = _mm256_set1_epi64x(((const uint64*)E8_bitslice_roundconstant[r])[i]);   \
+            const __m256i cc1 = _mm256_set1_epi64x(((const uint64*)E8_bitslice_roundconstant[r])[i+2]); \
+            MB_S(x[0+i], x[4+i], x[8+i], x[12+i], cc0);                                               \
+            MB_S(x[2+i], x[6+i], x[10+i], x[14+i], cc1);                                              \
+            MB_L(x[0+i], x[4+i], x[8+i], x[12+i], x[2+i], x[6+i], x[10+i], x[14+i]);                  \
+            SWAPN(x[2+i]); SWAPN(x[6+i]); SWAPN(x[10+i]); SWAPN(x[14+i]);                             \
+      }
+
+#define MB_NOSWAP(x)
+
+static void jh_E8_x4(__m256i *x) {
+      const __m256i ones = _mm256_set1_epi64x(-1);
+      __m256i temp;
+      int i, r;
+      for (r = 0; r < 42; r = r + 7) {
+            MB_ROUND(r + 0, MB_SWAP1);
+            MB_ROUND(r + 1, MB_SWAP2);
+            MB_ROUND(r + 2, MB_SWAP4);
+            MB_ROUND(r + 3, MB_SWAP8);
+            MB_ROUND(r + 4, MB_SWAP16);
+            MB_ROUND(r + 5, MB_SWAP32);
+            MB_ROUND(r + 6, MB_NOSWAP);
+            for (i = 2; i < 16; i = i + 4) {
+                  temp = x[i]; x[i] = x[i+1]; x[i+1] = temp;
+            }
+      }
+}
+
+/* block k of padded message of inlen bytes */
+static void jh_pad_block(uint8_t *blk, const uint8_t *in, uint64_t inlen, uint64_t k, uint64_t blocks) {
+      const uint64_t off = k * 64, bits = inlen * 8;
+      memset(blk, 0, 64);
+      if (off < inlen) memcpy(blk, in + off, inlen - off < 64 ? inlen - off : 64);
+      if (inlen >= off && inlen < off + 64) blk[inlen - off] = 0x80;
+      if (k == blocks - 1) for (int i = 0; i < 8; i++) blk[63 - i] = (uint8_t)(bits >> (8 * i));
+}
+
+static void jh256_hash_x4(uint8_t *const *out, const uint8_t *const *in, uint64_t inlen) {
+      const uint64_t blocks = inlen / 64 + ((inlen % 64) ? 2 : 1);
+      const uint64* h0 = (const uint64*)JH256_H0;
+      __m256i x[16];
+      int i;
+      for (i = 0; i < 16; i++) x[i] = _mm256_set1_epi64x(h0[i]);
+      for (uint64_t k = 0; k < blocks; k++) {
+            /* blocks are padded into uint64 words as reading byte buffer through uint64 pointer breaks strict aliasing */
+            DATA_ALIGN16(uint64_t blk[4][8]);
+            __m256i m[8];
+            for (i = 0; i < 4; i++) jh_pad_block((uint8_t*)blk[i], in[i], inlen, k, blocks);
+            for (i = 0; i < 8; i++) {
+                  m[i] = _mm256_setr_epi64x(blk[0][i], blk[1][i], blk[2][i], blk[3][i]);
+                  x[i] = MB_XOR(x[i], m[i]);
+            }
+            jh_E8_x4(x);
+            for (i = 0; i < 8; i++) x[i + 8] = MB_XOR(x[i + 8], m[i]);
+      }
+      for (i = 0; i < 4; i++) {
+            uint64 w[4];
+            _mm256_storeu_si256((__m256i *)w, x[12 + i]);
+            for (int j = 0; j < 4; j++) memcpy(out[j] + 8 * i, &w[j], 8);
+      }
+}
+#endif
+
+void jh256_hash_multi(uint8_t *const *out, const uint8_t *const *in, uint64_t inlen, size_t n) {
+      size_t i = 0;
+#if defined(HAVE_AVX2)
+      /* 4 lane pass is faster than scalar code even for one message */
+      for (; i < n; i += 4) {
+            /* missing lanes repeat the last message and their hashes are dropped */
+            const uint8_t *lane_in[4];
+            uint8_t *lane_out[4], dummy[4][32];
+            for (size_t j = 0; j < 4; j++) {
+                  lane_in[j]  = i + j < n ? in[i + j]  : in[n - 1];
+                  lane_out[j] = i + j < n ? out[i + j] : dummy[j];
+            }
+            jh256_hash_x4(lane_out, lane_in, inlen);
+      }
+#endif
+      for (; i < n; i++) jh_hash(256, in[i], 8 * inlen, out[i]);
+}
+/* MOMINER PATCH END */
@@ -17,3 +17,9 @@
 #include "hash.h"
 
 HashReturn jh_hash(int hashbitlen, const BitSequence *data, DataLength databitlen, BitSequence *hashval);
+
+/* MOMINER PATCH BEGIN: multi-buffer jh256 of CryptoNight hash ways. */
+#include <stddef.h>
+#include <stdint.h>
+void jh256_hash_multi(uint8_t *const *out, const uint8_t *const *in, uint64_t inlen, size_t n);
+/* MOMINER PATCH END */
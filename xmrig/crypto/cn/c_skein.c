@@ -699,3 +699,95 @@ void xmr_skein(const SkeinBitSequence *data, SkeinBitSequence *hashval){
   // Finalize
   Skein_512_Final(&state.u.ctx_512, hashval);
 }
+
+/* MOMINER PATCH BEGIN: multi-buffer xmr_skein of CryptoNight hash ways (4 messages per AVX2 pass). */
+#if defined(HAVE_AVX2)
+#include <immintrin.h>
+
+#define MB_ROTL(x,n) _mm256_or_si256(_mm256_slli_epi64((x), (n)), _mm256_srli_epi64((x), 64 - (n)))
+#define MB_MIX(a,b,ROT) X[a] = _mm256_add_epi64(X[a], X[b]); X[b] = _mm256_xor_si256(MB_ROTL(X[b], ROT), X[a]);
+
+/* subkey injection s of Threefish-512 */
+#define MB_INJECT(s)                                                                                        \
+    for (i = 0; i < 8; i++) X[i] = _mm256_add_epi64(X[i], key[((s) + i) % 9]);                               \
+    X[5] = _mm256_add_epi64(X[5], _mm256_set1_epi64x((int64_t) twk[(s) % 3]));                               \
+    X[6] = _mm256_add_epi64(X[6], _mm256_set1_epi64x((int64_t) twk[((s) + 1) % 3]));                         \
+    X[7] = _mm256_add_epi64(X[7], _mm256_set1_epi64x((s)));
+
+/* Skein_512_Process_Block of one block of 4 states with the same tweak */
+static void skein512_block_x4(__m256i *ctx_X, const __m256i *w, u64b_t t0, u64b_t t1)
+{
+    const u64b_t twk[3] = { t0, t1, t0 ^ t1 };
+    __m256i key[9], X[8];
+    int i, s;
+    key[8] = _mm256_set1_epi64x((int64_t) SKEIN_KS_PARITY);
+    for (i = 0; i < 8; i++) {
+        key[i] = ctx_X[i];
+        key[8] = _mm256_xor_si256(key[8], key[i]);
+        X[i]  = w[i];
+    }
+    MB_INJECT(0);
+    for (s = 1; s <= SKEIN_512_ROUNDS_TOTAL / 4; s += 2) {
+        MB_MIX(0,1,R_512_0_0); MB_MIX(2,3,R_512_0_1); MB_MIX(4,5,R_512_0_2); MB_MIX(6,7,R_512_0_3);
+        MB_MIX(2,1,R_512_1_0); MB_MIX(4,7,R_512_1_1); MB_MIX(6,5,R_512_1_2); MB_MIX(0,3,R_512_1_3);
+        MB_MIX(4,1,R_512_2_0); MB_MIX(6,3,R_512_2_1); MB_MIX(0,5,R_512_2_2); MB_MIX(2,7,R_512_2_3);
+        MB_MIX(6,1,R_512_3_0); MB_MIX(0,7,R_512_3_1); MB_MIX(2,5,R_512_3_2); MB_MIX(4,3,R_512_3_3);
+        MB_INJECT(s);
+        MB_MIX(0,1,R_512_4_0); MB_MIX(2,3,R_512_4_1); MB_MIX(4,5,R_512_4_2); MB_MIX(6,7,R_512_4_3);
+        MB_MIX(2,1,R_512_5_0); MB_MIX(4,7,R_512_5_1); MB_MIX(6,5,R_512_5_2); MB_MIX(0,3,R_512_5_3);
+        MB_MIX(4,1,R_512_6_0); MB_MIX(6,3,R_512_6_1); MB_MIX(0,5,R_512_6_2); MB_MIX(2,7,R_512_6_3);
+        MB_MIX(6,1,R_512_7_0); MB_MIX(0,7,R_512_7_1); MB_MIX(2,5,R_512_7_2); MB_MIX(4,3,R_512_7_3);
+        MB_INJECT(s + 1);
+    }
+    for (i = 0; i < 8; i++) ctx_X[i] = _mm256_xor_si256(X[i], w[i]);
+}
+
+static void xmr_skein_x4(const SkeinBitSequence *const *data, SkeinBitSequence *const *hashval)
+{
+    const size_t len = XMR_DATABITLEN >> 3;
+    u64b_t t0 = 0, t1 = SKEIN_T1_FLAG_FIRST | SKEIN_T1_BLK_TYPE_MSG;
+    __m256i X[8], w[8];
+    size_t i, off;
+    for (i = 0; i < 8; i++) X[i] = _mm256_set1_epi64x((int64_t) SKEIN_512_IV_256[i]);
+    for (off = 0; off < len; off += SKEIN_512_BLOCK_BYTES) {
+        const size_t n = len - off > SKEIN_512_BLOCK_BYTES ? SKEIN_512_BLOCK_BYTES : len - off;
+        u64b_t blk[4][SKEIN_512_STATE_WORDS];
+        for (i = 0; i < 4; i++) {
+            memset(blk[i], 0, sizeof(blk[i]));
+            memcpy(blk[i], data[i] + off, n);
+        }
+        for (i = 0; i < 8; i++) w[i] = _mm256_setr_epi64x((int64_t) blk[0][i], (int64_t) blk[1][i], (int64_t) blk[2][i], (int64_t) blk[3][i]);
+        t0 += n;
+        if (off + n == len) t1 |= SKEIN_T1_FLAG_FINAL;
+        skein512_block_x4(X, w, t0, t1);
+        t1 &= ~SKEIN_T1_FLAG_FIRST;
+    }
+    /* output block is counter 0 */
+    for (i = 0; i < 8; i++) w[i] = _mm256_setzero_si256();
+    skein512_block_x4(X, w, sizeof(u64b_t), SKEIN_T1_FLAG_FIRST | SKEIN_T1_BLK_TYPE_OUT_FINAL);
+    for (i = 0; i < 4; i++) {
+        u64b_t lanes[4];
+        _mm256_storeu_si256((__m256i *) lanes, X[i]);
+        for (size_t j = 0; j < 4; j++) memcpy(hashval[j] + 8 * i, &lanes[j], 8);
+    }
+}
+#endif
+
+void xmr_skein_multi(const SkeinBitSequence *const *data, SkeinBitSequence *const *hashval, size_t n)
+{
+    size_t i = 0;
+#if defined(HAVE_AVX2)
+    for (; i + 1 < n; i += 4) {
+        /* missing lanes repeat the last message and their hashes are dropped */
+        const SkeinBitSequence *lane_data[4];
+        SkeinBitSequence *lane_hash[4], dummy[4][32];
+        for (size_t j = 0; j < 4; j++) {
+            lane_data[j] = i + j < n ? data[i + j]    : data[n - 1];
+            lane_hash[j] = i + j < n ? hashval[i + j] : dummy[j];
+        }
+        xmr_skein_x4(lane_data, lane_hash);
+    }
+#endif
+    for (; i < n; i++) xmr_skein(data[i], hashval[i]);
+}
+/* MOMINER PATCH END */
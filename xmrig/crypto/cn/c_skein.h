@@ -46,4 +46,8 @@ SkeinHashReturn skein_hash(int hashbitlen,   const SkeinBitSequence *data,
 
 void xmr_skein(const SkeinBitSequence *data, SkeinBitSequence *hashval);
 
+/* MOMINER PATCH BEGIN: multi-buffer xmr_skein of CryptoNight hash ways. */
+void xmr_skein_multi(const SkeinBitSequence *const *data, SkeinBitSequence *const *hashval, size_t n);
+/* MOMINER PATCH END */
+
 #endif  /* ifndef _SKEIN_H_ */
@@ -24,6 +24,9 @@
  */
 
 #include <cstring>
+// MOMINER PATCH BEGIN: std::initializer_list for v4_compile_code_lanes.
+#include <initializer_list>
+// MOMINER PATCH END
 #include "crypto/cn/CryptoNight_monero.h"
 
 typedef void(*void_func)();
@@ -129,6 +132,47 @@ void v4_compile_code_double(const V4_Instruction* code, int code_size, void* mac
     xmrig::VirtualMemory::flushInstructionCache(machine_code, p - p0);
 }
 
+// MOMINER PATCH BEGIN: CnR random math as a standalone ms_abi function for 3-5 way hashes.
+// void f(uint32_t* const* r, size_t count): runs random math on uint32_t[9] registers of count hashes.
+// Instruction templates use rbx, rsi, rdi, rbp, rsp, r15, rax, rdx, r9 as r0-r8 and rcx as rotation count,
+// so r8 walks r array, r10 points to current registers, r11 keeps rsp and r12 is r array end.
+static inline void add_bytes(uint8_t* &p, std::initializer_list<uint8_t> bytes)
+{
+    for (const uint8_t b : bytes) {
+        *(p++) = b;
+    }
+}
+
+void v4_compile_code_lanes(const V4_Instruction* code, int code_size, void* machine_code, xmrig::Assembly ASM)
+{
+    uint8_t* p0 = reinterpret_cast<uint8_t*>(machine_code);
+    uint8_t* p = p0;
+
+    // push rbx; push rbp; push rsi; push rdi; push r12; push r15
+    add_bytes(p, { 0x53, 0x55, 0x56, 0x57, 0x41, 0x54, 0x41, 0x57 });
+    // mov r8, rcx; lea r12, [rcx+rdx*8]; mov r11, rsp
+    add_bytes(p, { 0x49, 0x89, 0xC8, 0x4C, 0x8D, 0x24, 0xD1, 0x49, 0x89, 0xE3 });
+
+    uint8_t* loop = p;
+    // mov r10, [r8]
+    add_bytes(p, { 0x4D, 0x8B, 0x10 });
+    // mov ebx/esi/edi/ebp/esp/r15d/eax/edx/r9d, [r10 + 4 * i]
+    add_bytes(p, { 0x41, 0x8B, 0x5A, 0x00, 0x41, 0x8B, 0x72, 0x04, 0x41, 0x8B, 0x7A, 0x08, 0x41, 0x8B, 0x6A, 0x0C, 0x41, 0x8B, 0x62, 0x10,
+                   0x45, 0x8B, 0x7A, 0x14, 0x41, 0x8B, 0x42, 0x18, 0x41, 0x8B, 0x52, 0x1C, 0x45, 0x8B, 0x4A, 0x20 });
+    add_random_math(p, code, code_size, instructions, instructions_mov, false, ASM);
+    // mov [r10 + 4 * i], ebx/esi/edi/ebp (only r0-r3 are written by random math)
+    add_bytes(p, { 0x41, 0x89, 0x5A, 0x00, 0x41, 0x89, 0x72, 0x04, 0x41, 0x89, 0x7A, 0x08, 0x41, 0x89, 0x6A, 0x0C });
+    // add r8, 8; cmp r8, r12; jb loop
+    add_bytes(p, { 0x49, 0x83, 0xC0, 0x08, 0x4D, 0x39, 0xE0, 0x0F, 0x82 });
+    *(int32_t*)p = static_cast<int32_t>(loop - (p + 4));
+    p += 4;
+    // mov rsp, r11; pop r15; pop r12; pop rdi; pop rsi; pop rbp; pop rbx; ret
+    add_bytes(p, { 0x4C, 0x89, 0xDC, 0x41, 0x5F, 0x41, 0x5C, 0x5F, 0x5E, 0x5D, 0x5B, 0xC3 });
+
+    xmrig::VirtualMemory::flushInstructionCache(machine_code, p - p0);
+}
+// MOMINER PATCH END
+
 void v4_soft_aes_compile_code(const V4_Instruction* code, int code_size, void* machine_code, xmrig::Assembly ASM)
 {
     uint8_t* p0 = reinterpret_cast<uint8_t*>(machine_code);
@@ -32,6 +32,17 @@
 
 #include <cinttypes>
 #include <mutex>
+// MOMINER PATCH BEGIN: sysfs and set_mempolicy based NUMA binding without hwloc.
+#ifdef __linux__
+#   include <cctype>
+#   include <cstdlib>
+#   include <cstring>
+#   include <string>
+#   include <dirent.h>
+#   include <sys/syscall.h>
+#   include <unistd.h>
+#endif
+// MOMINER PATCH END
 
 
 namespace xmrig {
@@ -114,11 +125,52 @@ xmrig::HugePagesInfo xmrig::VirtualMemory::hugePages() const
 
 
 #ifndef XMRIG_FEATURE_HWLOC
+// MOMINER PATCH BEGIN: mominer is built without hwloc, so on Linux the node of the affinity CPU is taken from sysfs and set as preferred memory policy of the calling thread (negative affinity restores the default policy).
+#ifdef __linux__
+uint32_t xmrig::VirtualMemory::bindToNUMANode(int64_t affinity)
+{
+    constexpr int MPOL_DEFAULT_   = 0;
+    constexpr int MPOL_PREFERRED_ = 1;
+
+    if (affinity < 0) {
+        syscall(SYS_set_mempolicy, MPOL_DEFAULT_, nullptr, 0);
+        return 0;
+    }
+
+    DIR *dir = opendir(("/sys/devices/system/cpu/cpu" + std::to_string(affinity)).c_str());
+    if (!dir) {
+        return 0;
+    }
+
+    int node = -1;
+    while (const dirent *entry = readdir(dir)) {
+        if (strncmp(entry->d_name, "node", 4) == 0 && isdigit(entry->d_name[4])) {
+            node = atoi(entry->d_name + 4);
+            break;
+        }
+    }
+    closedir(dir);
+
+    if (node < 0 || node >= 1024) {
+        return 0;
+    }
+
+    unsigned long mask[1024 / (8 * sizeof(unsigned long))] = {};
+    mask[node / (8 * sizeof(unsigned long))] = 1UL << (node % (8 * sizeof(unsigned long)));
+    if (syscall(SYS_set_mempolicy, MPOL_PREFERRED_, mask, 1024) != 0) {
+        return 0;
+    }
+
+    return static_cast<uint32_t>(node);
+}
+#else
 uint32_t xmrig::VirtualMemory::bindToNUMANode(int64_t)
 {
     return 0;
 }
 #endif
+// MOMINER PATCH END
+#endif
 
 
 void xmrig::VirtualMemory::destroy()
@@ -43,9 +43,15 @@
 #endif
 
 
-#ifdef XMRIG_OS_LINUX
+// MOMINER PATCH BEGIN: binding.gyp does not define XMRIG_OS_LINUX, so 1GB pages and THP madvise were compiled out on Linux (LinuxMemory hugetlb reservation is not vendored, pages should be reserved by the user).
+#if defined(__linux__) && !defined(XMRIG_OS_LINUX)
+#   define XMRIG_OS_LINUX
+#   define MOMINER_NO_LINUX_MEMORY
+#endif
+#if defined(XMRIG_OS_LINUX) && !defined(MOMINER_NO_LINUX_MEMORY)
 #   include "crypto/common/LinuxMemory.h"
 #endif
+// MOMINER PATCH END
 
 
 #ifndef MAP_HUGE_SHIFT
@@ -232,9 +238,11 @@ void xmrig::VirtualMemory::osInit(size_t hugePageSize)
 
 bool xmrig::VirtualMemory::allocateLargePagesMemory()
 {
-#   ifdef XMRIG_OS_LINUX
+    // MOMINER PATCH BEGIN: no LinuxMemory hugetlb reservation in mominer builds.
+#   if defined(XMRIG_OS_LINUX) && !defined(MOMINER_NO_LINUX_MEMORY)
     LinuxMemory::reserve(m_size, m_node, hugePageSize());
 #   endif
+    // MOMINER PATCH END
 
     m_scratchpad = static_cast<uint8_t*>(allocateLargePagesMemory(m_size));
     if (m_scratchpad) {
@@ -255,9 +263,11 @@ bool xmrig::VirtualMemory::allocateLargePagesMemory()
 
 bool xmrig::VirtualMemory::allocateOneGbPagesMemory()
 {
-#   ifdef XMRIG_OS_LINUX
+    // MOMINER PATCH BEGIN: no LinuxMemory hugetlb reservation in mominer builds.
+#   if defined(XMRIG_OS_LINUX) && !defined(MOMINER_NO_LINUX_MEMORY)
     LinuxMemory::reserve(m_size, m_node, kOneGiB);
 #   endif
+    // MOMINER PATCH END
 
     m_scratchpad = static_cast<uint8_t*>(allocateOneGbPagesMemory(m_size));
     if (m_scratchpad) {
@@ -288,9 +298,13 @@ bool xmrig::VirtualMemory::adviseLargePages(void *p, size_t size)
 
 void xmrig::VirtualMemory::freeLargePagesMemory()
 {
+    // MOMINER PATCH BEGIN: munmap of hugetlb mapping needs length aligned to its page size, so 1GB pages are freed by their aligned capacity (mominer frees and reallocates rx datasets).
+    const size_t size = isOneGbPages() ? m_capacity : m_size;
+
     if (m_flags.test(FLAG_LOCK)) {
-        munlock(m_scratchpad, m_size);
+        munlock(m_scratchpad, size);
     }
 
-    freeLargePagesMemory(m_scratchpad, m_size);
+    freeLargePagesMemory(m_scratchpad, size);
+    // MOMINER PATCH END
 }
@@ -56,6 +56,20 @@
 #   if HWLOC_API_VERSION < 0x20000
 #       define HWLOC_OBJ_L3CACHE HWLOC_OBJ_CACHE
 #   endif
+// MOMINER PATCH BEGIN: without hwloc helper threads are bound with plain thread affinity and tune results are cached per cpu.
+#else
+#   include <algorithm>
+#   include <array>
+#   include <condition_variable>
+#   include <fstream>
+#   include <map>
+#   include <mutex>
+#   include <set>
+#   ifndef _WIN32
+#       include <pthread.h>
+#       include <sched.h>
+#   endif
+// MOMINER PATCH END
 #endif
 
 #if defined(XMRIG_ARM)
@@ -98,6 +112,34 @@ CORE_HASH(14, whirlpool  );
 using core_hash_func = void (*)(const uint8_t* data, size_t size, uint8_t* output);
 static const core_hash_func core_hash[15] = { h0, h1, h2, h3, h4, h5, h6, h7, h8, h9, h10, h11, h12, h13, h14 };
 
+// MOMINER PATCH BEGIN: lanes of core hashes with multi-buffer code (nullptr where there is none) are hashed together.
+using core_hash_multi_func = void (*)(unsigned char* const* out, const unsigned char* const* in, size_t len, size_t n);
+static const core_hash_multi_func core_hash_multi[15] = {
+    nullptr, nullptr, sph_groestl512_multi, nullptr, nullptr, nullptr, nullptr, nullptr,
+    sph_shavite512_multi, sph_simd512_multi, sph_echo512_multi, sph_hamsi512_multi, nullptr, nullptr, sph_whirlpool_multi
+};
+
+bool xmrig::ghostrider::core_multi_enabled = false;
+
+void xmrig::ghostrider::core_hash_lanes(uint32_t index, const uint8_t* data, size_t size, uint8_t* output, size_t lanes)
+{
+    if (core_multi_enabled && core_hash_multi[index]) {
+        const uint8_t* in[8];
+        uint8_t* out[8];
+        for (size_t j = 0; j < lanes; ++j) {
+            in[j]  = data + j * size;
+            out[j] = output + j * 64;
+        }
+        core_hash_multi[index](out, in, size, lanes);
+        return;
+    }
+
+    for (size_t j = 0; j < lanes; ++j) {
+        core_hash[index](data + j * size, size, output + j * 64);
+    }
+}
+// MOMINER PATCH END
+
 namespace xmrig
 {
 
@@ -161,7 +203,9 @@ namespace ghostrider
 {
 
 
-#ifdef XMRIG_FEATURE_HWLOC
+// MOMINER PATCH BEGIN: helper threads and tuning also run without hwloc on x86 (see CpuSet below).
+#if defined(XMRIG_FEATURE_HWLOC) || (!defined(XMRIG_ARM) && !defined(XMRIG_RISCV))
+// MOMINER PATCH END
 
 
 static struct AlgoTune
@@ -169,14 +213,95 @@ static struct AlgoTune
     double hashrate = 0.0;
     uint32_t step = 1;
     uint32_t threads = 1;
-} tuneDefault[6], tune8MB[6];
+// MOMINER PATCH BEGIN: 8 MB tune table without hwloc is cached per cpu with the default one (see benchmark(cpu_index, helper_cpu_index)).
+} tuneDefault[6];
+#ifdef XMRIG_FEATURE_HWLOC
+static AlgoTune tune8MB[6];
+#endif
+// MOMINER PATCH END
+
+
+// MOMINER PATCH BEGIN: cpus of helper threads are hwloc bitmaps or plain cpu lists bound with thread affinity.
+#ifdef XMRIG_FEATURE_HWLOC
+using CpuSet = hwloc_bitmap_t;
+#else
+using CpuSet = std::vector<int64_t>;
+
+
+// tune table that hash_octa calls of this thread use (selected by benchmark(cpu_index, helper_cpu_index))
+static thread_local const AlgoTune* threadTune = tuneDefault;
+
+
+// returns cpus of sysfs cpu list file like "0-3,8-11" (empty if it can't be read)
+static CpuSet read_cpu_list(const std::string& path)
+{
+    CpuSet cpus;
+    std::ifstream file(path);
+    std::string list;
+    if (!std::getline(file, list)) {
+        return cpus;
+    }
+
+    for (const char* p = list.c_str(); *p; ) {
+        char* end;
+        const int64_t first = strtoll(p, &end, 10);
+        const int64_t last  = (*end == '-') ? strtoll(end + 1, &end, 10) : first;
+        if (end == p) {
+            break;
+        }
+        for (int64_t cpu = first; cpu <= last; ++cpu) {
+            cpus.push_back(cpu);
+        }
+        p = (*end == ',') ? end + 1 : end;
+    }
+
+    return cpus;
+}
+
+
+static std::string cpu_sysfs_dir(int64_t cpu_index)
+{
+    return "/sys/devices/system/cpu/cpu" + std::to_string(cpu_index);
+}
+
+
+// pins the calling thread to cpus (it is left as is if cpus are empty)
+static void bind_thread(const CpuSet& cpus)
+{
+    if (cpus.empty()) {
+        return;
+    }
+
+#   ifdef _WIN32
+    DWORD_PTR mask = 0;
+    for (int64_t cpu : cpus) {
+        if (cpu < static_cast<int64_t>(sizeof(DWORD_PTR) * 8)) {
+            mask |= static_cast<DWORD_PTR>(1) << cpu;
+        }
+    }
+    SetThreadAffinityMask(GetCurrentThread(), mask);
+#   else
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    for (int64_t cpu : cpus) {
+        if (cpu < CPU_SETSIZE) {
+            CPU_SET(cpu, &set);
+        }
+    }
+    pthread_setaffinity_np(pthread_self(), sizeof(set), &set);
+#   endif
+}
+#endif
+// MOMINER PATCH END
 
 
 struct HelperThread
 {
     XMRIG_DISABLE_COPY_MOVE_DEFAULT(HelperThread)
 
-    HelperThread(hwloc_bitmap_t cpu_set, int priority, bool is8MB) : m_cpuSet(cpu_set), m_priority(priority), m_is8MB(is8MB)
+    // MOMINER PATCH BEGIN: cpu set is a plain cpu list without hwloc.
+    HelperThread(CpuSet cpu_set, int priority, bool is8MB) : m_cpuSet(cpu_set), m_priority(priority), m_is8MB(is8MB)
+    // MOMINER PATCH END
     {
         uv_mutex_init(&m_mutex);
         uv_cond_init(&m_cond);
@@ -200,7 +325,11 @@ struct HelperThread
         uv_mutex_destroy(&m_mutex);
         uv_cond_destroy(&m_cond);
 
+        // MOMINER PATCH BEGIN: cpu list without hwloc is freed with the thread.
+#       ifdef XMRIG_FEATURE_HWLOC
         hwloc_bitmap_free(m_cpuSet);
+#       endif
+        // MOMINER PATCH END
     }
 
     struct TaskBase
@@ -233,7 +362,11 @@ struct HelperThread
     inline void launch_task(T&& task)
     {
         uv_mutex_lock(&m_mutex);
-        new (&m_tasks[m_numTasks++]) Task<T>(std::forward<T>(task));
+        // MOMINER PATCH BEGIN: C++20 deprecates ++ of volatile task counter.
+        const uint32_t i = m_numTasks;
+        new (&m_tasks[i]) Task<T>(std::forward<T>(task));
+        m_numTasks = i + 1;
+        // MOMINER PATCH END
         uv_cond_signal(&m_cond);
         uv_mutex_unlock(&m_mutex);
     }
@@ -247,6 +380,8 @@ struct HelperThread
 
     void run()
     {
+        // MOMINER PATCH BEGIN: without hwloc helper thread is only pinned to its cpus (priority is not changed).
+#       ifdef XMRIG_FEATURE_HWLOC
         if (hwloc_bitmap_weight(m_cpuSet) > 0) {
             hwloc_topology_t topology = Cpu::info()->topology();
             if (hwloc_set_cpubind(topology, m_cpuSet, HWLOC_CPUBIND_THREAD | HWLOC_CPUBIND_STRICT) < 0) {
@@ -255,6 +390,10 @@ struct HelperThread
         }
 
         Platform::setThreadPriority(m_priority);
+#       else
+        bind_thread(m_cpuSet);
+#       endif
+        // MOMINER PATCH END
 
         uv_mutex_lock(&m_mutex);
         m_ready = true;
@@ -282,7 +421,9 @@ struct HelperThread
     volatile uint32_t m_numTasks = 0;
     volatile bool m_ready = false;
     volatile bool m_finished = false;
-    hwloc_bitmap_t m_cpuSet = {};
+    // MOMINER PATCH BEGIN: cpu set is a plain cpu list without hwloc.
+    CpuSet m_cpuSet = {};
+    // MOMINER PATCH END
     int m_priority = -1;
     bool m_is8MB = false;
 
@@ -290,108 +431,82 @@ struct HelperThread
 };
 
 
-void benchmark()
+// MOMINER PATCH BEGIN: tuning passes on the calling thread cpu are shared with per cpu tuning without hwloc (2 threads
+// configs are only measured if helper_cpu is not negative).
+static void benchmark_cpu(int64_t helper_cpu, size_t max_scratchpad_size, AlgoTune* tune_default, AlgoTune* tune_8mb)
 {
-#if !defined(XMRIG_ARM) && !defined(XMRIG_RISCV)
-    static std::atomic<int> done{ 0 };
-    if (done.exchange(1)) {
-        return;
-    }
+    constexpr uint32_t N = 1U << 21;
 
-    std::thread t([]() {
-        // Try to avoid CPU core 0 because many system threads use it and can interfere
-        uint32_t thread_index1 = (Cpu::info()->threads() > 2) ? 2 : 0;
-
-        hwloc_topology_t topology = Cpu::info()->topology();
-        hwloc_obj_t pu = hwloc_get_pu_obj_by_os_index(topology, thread_index1);
-        hwloc_obj_t pu2 = nullptr;
-        hwloc_get_closest_objs(topology, pu, &pu2, 1);
-        uint32_t thread_index2 = pu2 ? pu2->os_index : thread_index1;
-
-        if (thread_index2 < thread_index1) {
-            std::swap(thread_index1, thread_index2);
-        }
-
-        Platform::setThreadAffinity(thread_index1);
-        Platform::setThreadPriority(3);
+#   ifdef XMRIG_FEATURE_HWLOC
+    VirtualMemory::init(0, N);
+#   endif
+    VirtualMemory* memory = new VirtualMemory(N * 8, true, false, false);
 
-        constexpr uint32_t N = 1U << 21;
+    LOG_VERBOSE("Running GhostRider benchmark (max scratchpad size %zu MB, huge pages %s)", max_scratchpad_size >> 20, memory->isHugePages() ? "on" : "off");
 
-        VirtualMemory::init(0, N);
-        VirtualMemory* memory = new VirtualMemory(N * 8, true, false, false);
+    cryptonight_ctx* ctx[8];
+    CnCtx::create(ctx, memory->scratchpad(), N, 8);
 
-        // 2 MB cache per core by default
-        size_t max_scratchpad_size = 1U << 21;
+    const CnHash::AlgoVariant* av = Cpu::info()->hasAES() ? av_hw_aes : av_soft_aes;
 
-        if ((Cpu::info()->L3() >> 22) > Cpu::info()->cores()) {
-            // At least 1 core can run with 8 MB cache
-            max_scratchpad_size = 1U << 23;
-        }
-        else if ((Cpu::info()->L3() >> 22) >= Cpu::info()->cores()) {
-            // All cores can run with 4 MB cache
-            max_scratchpad_size = 1U << 22;
-        }
+    uint8_t buf[80] = {};
+    uint8_t hash[32 * 8];
 
-        LOG_VERBOSE("Running GhostRider benchmark on logical CPUs %u and %u (max scratchpad size %zu MB, huge pages %s)", thread_index1, thread_index2, max_scratchpad_size >> 20, memory->isHugePages() ? "on" : "off");
+    LOG_VERBOSE("%24s |  N  | Hashrate", "Algorithm");
+    LOG_VERBOSE("-------------------------|-----|-------------");
 
-        cryptonight_ctx* ctx[8];
-        CnCtx::create(ctx, memory->scratchpad(), N, 8);
+    for (uint32_t algo = 0; algo < 6; ++algo) {
+        for (uint64_t step : { 1, 2, 4}) {
+            const size_t cur_scratchpad_size = cn_sizes[algo] * step;
+            if (cur_scratchpad_size > max_scratchpad_size) {
+                continue;
+            }
 
-        const CnHash::AlgoVariant* av = Cpu::info()->hasAES() ? av_hw_aes : av_soft_aes;
+            auto f = CnHash::fn(cn_hash[algo], av[step], Assembly::AUTO);
 
-        uint8_t buf[80];
-        uint8_t hash[32 * 8];
+            double start_time = Chrono::highResolutionMSecs();
 
-        LOG_VERBOSE("%24s |  N  | Hashrate", "Algorithm");
-        LOG_VERBOSE("-------------------------|-----|-------------");
+            double min_dt = 1e10;
+            for (uint32_t iter = 0;; ++iter) {
+                double t1 = Chrono::highResolutionMSecs();
 
-        for (uint32_t algo = 0; algo < 6; ++algo) {
-            for (uint64_t step : { 1, 2, 4}) {
-                const size_t cur_scratchpad_size = cn_sizes[algo] * step;
-                if (cur_scratchpad_size > max_scratchpad_size) {
-                    continue;
+                // Stop after 15 milliseconds, but only if at least 10 iterations were done
+                if ((iter >= 10) && (t1 - start_time >= 15.0)) {
+                    break;
                 }
 
-                auto f = CnHash::fn(cn_hash[algo], av[step], Assembly::AUTO);
-
-                double start_time = Chrono::highResolutionMSecs();
-
-                double min_dt = 1e10;
-                for (uint32_t iter = 0;; ++iter) {
-                    double t1 = Chrono::highResolutionMSecs();
-
-                    // Stop after 15 milliseconds, but only if at least 10 iterations were done
-                    if ((iter >= 10) && (t1 - start_time >= 15.0)) {
-                        break;
-                    }
-
-                    f(buf, sizeof(buf), hash, ctx, 0);
+                f(buf, sizeof(buf), hash, ctx, 0);
 
-                    const double dt = Chrono::highResolutionMSecs() - t1;
-                    if (dt < min_dt) {
-                        min_dt = dt;
-                    }
+                const double dt = Chrono::highResolutionMSecs() - t1;
+                if (dt < min_dt) {
+                    min_dt = dt;
                 }
+            }
 
-                const double hashrate = step * 1e3 / min_dt;
-                LOG_VERBOSE("%24s | %" PRIu64 "x1 | %.2f h/s", cn_names[algo], step, hashrate);
+            const double hashrate = step * 1e3 / min_dt;
+            LOG_VERBOSE("%24s | %" PRIu64 "x1 | %.2f h/s", cn_names[algo], step, hashrate);
 
-                if (hashrate > tune8MB[algo].hashrate) {
-                    tune8MB[algo].hashrate = hashrate;
-                    tune8MB[algo].step = static_cast<uint32_t>(step);
-                    tune8MB[algo].threads = 1;
-                }
+            if (hashrate > tune_8mb[algo].hashrate) {
+                tune_8mb[algo].hashrate = hashrate;
+                tune_8mb[algo].step = static_cast<uint32_t>(step);
+                tune_8mb[algo].threads = 1;
+            }
 
-                if ((cur_scratchpad_size < (1U << 23)) && (hashrate > tuneDefault[algo].hashrate)) {
-                    tuneDefault[algo].hashrate = hashrate;
-                    tuneDefault[algo].step = static_cast<uint32_t>(step);
-                    tuneDefault[algo].threads = 1;
-                }
+            if ((cur_scratchpad_size < (1U << 23)) && (hashrate > tune_default[algo].hashrate)) {
+                tune_default[algo].hashrate = hashrate;
+                tune_default[algo].step = static_cast<uint32_t>(step);
+                tune_default[algo].threads = 1;
             }
         }
+    }
 
+    if (helper_cpu >= 0) {
+#       ifdef XMRIG_FEATURE_HWLOC
         hwloc_bitmap_t helper_set = hwloc_bitmap_alloc();
-        hwloc_bitmap_set(helper_set, thread_index2);
+        hwloc_bitmap_set(helper_set, static_cast<unsigned>(helper_cpu));
+#       else
+        CpuSet helper_set{ helper_cpu };
+#       endif
         HelperThread* helper = new HelperThread(helper_set, 3, false);
 
         for (uint32_t algo = 0; algo < 6; ++algo) {
@@ -427,24 +542,73 @@ void benchmark()
                 const double hashrate = step * 2e3 / min_dt * 1.0075;
                 LOG_VERBOSE("%24s | %" PRIu64 "x2 | %.2f h/s", cn_names[algo], step, hashrate);
 
-                if (hashrate > tune8MB[algo].hashrate) {
-                    tune8MB[algo].hashrate = hashrate;
-                    tune8MB[algo].step = static_cast<uint32_t>(step);
-                    tune8MB[algo].threads = 2;
+                if (hashrate > tune_8mb[algo].hashrate) {
+                    tune_8mb[algo].hashrate = hashrate;
+                    tune_8mb[algo].step = static_cast<uint32_t>(step);
+                    tune_8mb[algo].threads = 2;
                 }
 
-                if ((cur_scratchpad_size < (1U << 23)) && (hashrate > tuneDefault[algo].hashrate)) {
-                    tuneDefault[algo].hashrate = hashrate;
-                    tuneDefault[algo].step = static_cast<uint32_t>(step);
-                    tuneDefault[algo].threads = 2;
+                if ((cur_scratchpad_size < (1U << 23)) && (hashrate > tune_default[algo].hashrate)) {
+                    tune_default[algo].hashrate = hashrate;
+                    tune_default[algo].step = static_cast<uint32_t>(step);
+                    tune_default[algo].threads = 2;
                 }
             }
         }
 
         delete helper;
+    }
 
-        CnCtx::release(ctx, 8);
-        delete memory;
+    CnCtx::release(ctx, 8);
+    delete memory;
+}
+
+
+// per cpu tuning without hwloc is below create_helper_thread
+#ifdef XMRIG_FEATURE_HWLOC
+// MOMINER PATCH END
+void benchmark()
+{
+#if !defined(XMRIG_ARM) && !defined(XMRIG_RISCV)
+    static std::atomic<int> done{ 0 };
+    if (done.exchange(1)) {
+        return;
+    }
+
+    std::thread t([]() {
+        // Try to avoid CPU core 0 because many system threads use it and can interfere
+        uint32_t thread_index1 = (Cpu::info()->threads() > 2) ? 2 : 0;
+
+        hwloc_topology_t topology = Cpu::info()->topology();
+        hwloc_obj_t pu = hwloc_get_pu_obj_by_os_index(topology, thread_index1);
+        hwloc_obj_t pu2 = nullptr;
+        hwloc_get_closest_objs(topology, pu, &pu2, 1);
+        uint32_t thread_index2 = pu2 ? pu2->os_index : thread_index1;
+
+        if (thread_index2 < thread_index1) {
+            std::swap(thread_index1, thread_index2);
+        }
+
+        Platform::setThreadAffinity(thread_index1);
+        Platform::setThreadPriority(3);
+
+        // 2 MB cache per core by default
+        size_t max_scratchpad_size = 1U << 21;
+
+        if ((Cpu::info()->L3() >> 22) > Cpu::info()->cores()) {
+            // At least 1 core can run with 8 MB cache
+            max_scratchpad_size = 1U << 23;
+        }
+        else if ((Cpu::info()->L3() >> 22) >= Cpu::info()->cores()) {
+            // All cores can run with 4 MB cache
+            max_scratchpad_size = 1U << 22;
+        }
+
+        LOG_VERBOSE("Running GhostRider benchmark on logical CPUs %u and %u", thread_index1, thread_index2);
+
+        // MOMINER PATCH BEGIN: tuning passes are in benchmark_cpu.
+        benchmark_cpu(thread_index2, max_scratchpad_size, tuneDefault, tune8MB);
+        // MOMINER PATCH END
     });
 
     t.join();
@@ -554,264 +718,282 @@ HelperThread* create_helper_thread(int64_t cpu_index, int priority, const std::v
 
     return nullptr;
 }
+// MOMINER PATCH BEGIN: per cpu tuning and helper threads on free SMT siblings without hwloc.
+#else
 
 
-void destroy_helper_thread(HelperThread* t)
+// returns scratchpad size that fits into L3 cache share of cpu_index core (2 MB if it is unknown)
+static size_t get_max_scratchpad_size(int64_t cpu_index)
 {
-    delete t;
+    // 2 MB cache per core by default
+    size_t max_scratchpad_size = 1U << 21;
+
+    const std::string dir = cpu_sysfs_dir(cpu_index < 0 ? 0 : cpu_index);
+    for (int index = 0; index < 8; ++index) {
+        const std::string cache_dir = dir + "/cache/index" + std::to_string(index);
+        std::ifstream level_file(cache_dir + "/level"), size_file(cache_dir + "/size");
+        int level = 0;
+        if (!(level_file >> level)) {
+            break;
+        }
+        size_t size = 0;
+        std::string unit;
+        if (level != 3 || !(size_file >> size)) {
+            continue;
+        }
+        size_file >> unit;
+        size <<= (unit == "M") ? 20 : (unit == "K") ? 10 : 0;
+
+        const size_t smt   = std::max<size_t>(1, read_cpu_list(dir + "/topology/thread_siblings_list").size());
+        const size_t cores = read_cpu_list(cache_dir + "/shared_cpu_list").size() / smt;
+
+        if ((size >> 22) > cores) {
+            // At least 1 core can run with 8 MB cache
+            max_scratchpad_size = 1U << 23;
+        }
+        else if ((size >> 22) >= cores) {
+            // All cores can run with 4 MB cache
+            max_scratchpad_size = 1U << 22;
+        }
+        break;
+    }
+
+    return max_scratchpad_size;
 }
 
 
-void hash_octa(const uint8_t* data, size_t size, uint8_t* output, cryptonight_ctx** ctx, HelperThread* helper, bool verbose)
+// default and 8 MB tune tables of one cpu (8 MB one is used if L3 cache share of the cpu core fits 8 MB scratchpads)
+struct CpuTune
 {
-    enum { N = 8 };
-
-    uint8_t* ctx_memory[N];
-    for (size_t i = 0; i < N; ++i) {
-        ctx_memory[i] = ctx[i]->memory;
-    }
+    std::array<AlgoTune, 6> tune, tune_8mb;
+};
 
-    // PrevBlockHash (GhostRider's seed) is stored in bytes [4; 36)
-    uint32_t core_indices[15];
-    select_indices(core_indices, data + 4);
 
-    uint32_t cn_indices[6];
-    select_indices(cn_indices, data + 4);
+void benchmark(int64_t cpu_index, int64_t helper_cpu_index)
+{
+    static std::mutex mutex;
+    static std::condition_variable tuned;
+    static std::map<std::pair<int64_t, int64_t>, CpuTune> tunes;
+    // keys measured by some thread now: other threads wait for its result instead of disturbing its timings
+    static std::set<std::pair<int64_t, int64_t>> tuning;
+
+    const size_t max_scratchpad_size = get_max_scratchpad_size(cpu_index);
+    const auto select = [max_scratchpad_size](const CpuTune& cpu_tune) {
+        threadTune = (max_scratchpad_size >= (1U << 23) ? cpu_tune.tune_8mb : cpu_tune.tune).data();
+    };
 
-    if (verbose) {
-        static uint32_t prev_indices[3];
-        if (memcmp(cn_indices, prev_indices, sizeof(prev_indices)) != 0) {
-            memcpy(prev_indices, cn_indices, sizeof(prev_indices));
-            for (int i = 0; i < 3; ++i) {
-                LOG_INFO("%s GhostRider algo %d: %s", Tags::cpu(), i + 1, cn_names[cn_indices[i]]);
-            }
+    const auto key = std::make_pair(cpu_index, helper_cpu_index);
+    {
+        std::unique_lock<std::mutex> lock(mutex);
+        tuned.wait(lock, [&key]() { return tuning.count(key) == 0; });
+        auto i = tunes.find(key);
+        if (i != tunes.end()) {
+            select(i->second);
+            return;
         }
+        tuning.insert(key);
     }
 
-    const CnHash::AlgoVariant* av = Cpu::info()->hasAES() ? av_hw_aes : av_soft_aes;
-    const AlgoTune* tune = (helper && helper->m_is8MB) ? tune8MB : tuneDefault;
+    CpuTune cpu_tune;
+    std::thread t([cpu_index, helper_cpu_index, max_scratchpad_size, &cpu_tune]() {
+        bind_thread(cpu_index < 0 ? CpuSet() : CpuSet{ cpu_index });
+        benchmark_cpu(helper_cpu_index, max_scratchpad_size, cpu_tune.tune.data(), cpu_tune.tune_8mb.data());
+    });
+    t.join();
 
-    uint8_t tmp[64 * N];
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        select(tunes.emplace(key, cpu_tune).first->second);
+        tuning.erase(key);
+    }
+    tuned.notify_all();
+}
 
-    if (helper && (tune[cn_indices[0]].threads == 2) && (tune[cn_indices[1]].threads == 2) && (tune[cn_indices[2]].threads == 2)) {
-        constexpr size_t n = N / 2;
 
-        helper->launch_task([av, data, size, &ctx_memory, ctx, &cn_indices, &core_indices, &tmp, output, tune]() {
-#           ifdef _MSC_VER
-            constexpr size_t n = N / 2;
-#           endif
+void benchmark()
+{
+    benchmark(-1, -1);
+}
 
-            const uint8_t* input = data;
-            size_t input_size = size;
 
-            for (size_t part = 0; part < 3; ++part) {
-                const AlgoTune& t = tune[cn_indices[part]];
+int64_t find_helper_cpu(int64_t cpu_index, const std::vector<int64_t>& affinities)
+{
+    if (cpu_index < 0) {
+        return -1;
+    }
 
-                // Allocate scratchpads
-                {
-                    uint8_t* p = ctx_memory[4];
+    for (int64_t cpu : read_cpu_list(cpu_sysfs_dir(cpu_index) + "/topology/thread_siblings_list")) {
+        if (cpu != cpu_index && std::find(affinities.begin(), affinities.end(), cpu) == affinities.end()) {
+            return cpu;
+        }
+    }
 
-                    for (size_t i = n, k = 4; i < N; ++i) {
-                        if ((i % t.step) == 0) {
-                            k = 4;
-                            p = ctx_memory[4];
-                        }
-                        else if (p - ctx_memory[k] >= (1 << 21)) {
-                            ++k;
-                            p = ctx_memory[k];
-                        }
-                        ctx[i]->memory = p;
-                        p += cn_sizes[cn_indices[part]];
-                    }
-                }
+    return -1;
+}
 
-                for (size_t i = 0; i < 5; ++i) {
-                    for (size_t j = n; j < N; ++j) {
-                        core_hash[core_indices[part * 5 + i]](input + j * input_size, input_size, tmp + j * 64);
-                    }
-                    input = tmp;
-                    input_size = 64;
-                }
 
-                auto f = CnHash::fn(cn_hash[cn_indices[part]], av[t.step], Assembly::AUTO);
-                for (size_t j = n; j < N; j += t.step) {
-                    f(tmp + j * 64, 64, output + j * 32, ctx + n, 0);
-                }
+HelperThread* create_helper_thread(int64_t cpu_index, int priority, const std::vector<int64_t>& affinities)
+{
+    const int64_t helper_cpu = find_helper_cpu(cpu_index, affinities);
 
-                for (size_t j = n; j < N; ++j) {
-                    memcpy(tmp + j * 64, output + j * 32, 32);
-                    memset(tmp + j * 64 + 32, 0, 32);
-                }
-            }
-        });
+    return (helper_cpu >= 0) ? new HelperThread(CpuSet{ helper_cpu }, priority, false) : nullptr;
+}
 
-        const uint8_t* input = data;
-        size_t input_size = size;
 
-        for (size_t part = 0; part < 3; ++part) {
-            const AlgoTune& t = tune[cn_indices[part]];
+std::string tune_info()
+{
+    std::string info;
+    for (int algo = 0; algo < 6; ++algo) {
+        if (algo) info += ':';
+        info += std::to_string(threadTune[algo].step);
+        info += 'x';
+        info += std::to_string(threadTune[algo].threads);
+    }
 
-            // Allocate scratchpads
-            {
-                uint8_t* p = ctx_memory[0];
+    return info;
+}
 
-                for (size_t i = 0, k = 0; i < n; ++i) {
-                    if ((i % t.step) == 0) {
-                        k = 0;
-                        p = ctx_memory[0];
-                    }
-                    else if (p - ctx_memory[k] >= (1 << 21)) {
-                        ++k;
-                        p = ctx_memory[k];
-                    }
-                    ctx[i]->memory = p;
-                    p += cn_sizes[cn_indices[part]];
-                }
-            }
 
-            for (size_t i = 0; i < 5; ++i) {
-                for (size_t j = 0; j < n; ++j) {
-                    core_hash[core_indices[part * 5 + i]](input + j * input_size, input_size, tmp + j * 64);
-                }
-                input = tmp;
-                input_size = 64;
-            }
+#endif
+// MOMINER PATCH END
 
-            auto f = CnHash::fn(cn_hash[cn_indices[part]], av[t.step], Assembly::AUTO);
-            for (size_t j = 0; j < n; j += t.step) {
-                f(tmp + j * 64, 64, output + j * 32, ctx, 0);
-            }
 
-            for (size_t j = 0; j < n; ++j) {
-                memcpy(tmp + j * 64, output + j * 32, 32);
-                memset(tmp + j * 64 + 32, 0, 32);
-            }
-        }
+void destroy_helper_thread(HelperThread* t)
+{
+    delete t;
+}
 
-        helper->wait();
-    }
-    else {
-        for (size_t part = 0; part < 3; ++part) {
-            const AlgoTune& t = tune[cn_indices[part]];
-
-            // Allocate scratchpads
-            {
-                uint8_t* p = ctx_memory[0];
-                const size_t n = N / t.threads;
-
-                // Thread 1
-                for (size_t i = 0, k = 0; i < n; ++i) {
-                    if ((i % t.step) == 0) {
-                        k = 0;
-                        p = ctx_memory[0];
-                    }
-                    else if (p - ctx_memory[k] >= (1 << 21)) {
-                        ++k;
-                        p = ctx_memory[k];
-                    }
-                    ctx[i]->memory = p;
-                    p += cn_sizes[cn_indices[part]];
-                }
 
-                // Thread 2
-                for (size_t i = n, k = 4; i < N; ++i) {
-                    if ((i % t.step) == 0) {
-                        k = 4;
-                        p = ctx_memory[4];
-                    }
-                    else if (p - ctx_memory[k] >= (1 << 21)) {
-                        ++k;
-                        p = ctx_memory[k];
-                    }
-                    ctx[i]->memory = p;
-                    p += cn_sizes[cn_indices[part]];
-                }
-            }
+// MOMINER PATCH BEGIN: hash_octa is generalized to 1, 2, 4 or 8 lanes hashed with job rotation selected by the caller
+// (helper thread hashes upper half of lanes, cn steps are capped by lanes of each thread).
+void hash_lanes(const uint8_t* data, size_t size, uint8_t* output, cryptonight_ctx** ctx, size_t lanes, const Rotation& rotation, HelperThread* helper)
+{
+    enum { N = 8 };
 
-            size_t n = N;
+    uint8_t* ctx_memory[N];
+    for (size_t i = 0; i < lanes; ++i) {
+        ctx_memory[i] = ctx[i]->memory;
+    }
 
-            if (helper && (t.threads == 2)) {
-                n = N / 2;
+    const uint32_t* core_indices = rotation.core_indices;
+    const uint32_t* cn_indices   = rotation.cn_indices;
 
-                helper->launch_task([data, size, n, &cn_indices, &core_indices, part, &tmp, av, &t, output, ctx]() {
-                    const uint8_t* input = data;
-                    size_t input_size = size;
+    const CnHash::AlgoVariant* av = Cpu::info()->hasAES() ? av_hw_aes : av_soft_aes;
+#   ifdef XMRIG_FEATURE_HWLOC
+    const AlgoTune* tune = (helper && helper->m_is8MB) ? tune8MB : tuneDefault;
+#   else
+    const AlgoTune* tune = threadTune;
+#   endif
 
-                    for (size_t i = 0; i < 5; ++i) {
-                        for (size_t j = n; j < N; ++j) {
-                            core_hash[core_indices[part * 5 + i]](input + j * input_size, input_size, tmp + j * 64);
-                        }
-                        input = tmp;
-                        input_size = 64;
-                    }
+    uint8_t tmp[64 * N];
 
-                    auto f = CnHash::fn(cn_hash[cn_indices[part]], av[t.step], Assembly::AUTO);
-                    for (size_t j = n; j < N; j += t.step) {
-                        f(tmp + j * 64, 64, output + j * 32, ctx + n, 0);
-                    }
+    // runs part (5 core hashes and cn hash) on [first, last) lanes, cn scratchpads of lanes hashed by
+    // one step are placed in ctx memory of [first, last) lanes
+    auto hash_part = [data, size, av, tune, core_indices, cn_indices, &ctx_memory, &tmp, output, ctx](size_t part, size_t first, size_t last) {
+        // the first part hashes job inputs and the next ones hash 64 byte results of the previous part
+        const uint8_t* input = part ? tmp : data;
+        size_t input_size = part ? 64 : size;
 
-                    for (size_t j = n; j < N; ++j) {
-                        memcpy(tmp + j * 64, output + j * 32, 32);
-                        memset(tmp + j * 64 + 32, 0, 32);
-                    }
-                });
-            }
+        const AlgoTune& t = tune[cn_indices[part]];
+        const size_t step = std::min<size_t>(t.step, last - first);
 
-            for (size_t i = 0; i < 5; ++i) {
-                for (size_t j = 0; j < n; ++j) {
-                    core_hash[core_indices[part * 5 + i]](data + j * size, size, tmp + j * 64);
+        {
+            uint8_t* p = ctx_memory[first];
+
+            for (size_t i = first, k = first; i < last; ++i) {
+                if (((i - first) % step) == 0) {
+                    k = first;
+                    p = ctx_memory[first];
+                }
+                else if (p - ctx_memory[k] >= (1 << 21)) {
+                    ++k;
+                    p = ctx_memory[k];
                 }
-                data = tmp;
-                size = 64;
+                ctx[i]->memory = p;
+                p += cn_sizes[cn_indices[part]];
             }
+        }
 
-            auto f = CnHash::fn(cn_hash[cn_indices[part]], av[t.step], Assembly::AUTO);
-            for (size_t j = 0; j < n; j += t.step) {
-                f(tmp + j * 64, 64, output + j * 32, ctx, 0);
-            }
+        for (size_t i = 0; i < 5; ++i) {
+            core_hash_lanes(core_indices[part * 5 + i], input + first * input_size, input_size, tmp + first * 64, last - first);
+            input = tmp;
+            input_size = 64;
+        }
+
+        auto f = CnHash::fn(cn_hash[cn_indices[part]], av[step], Assembly::AUTO);
+        for (size_t j = first; j < last; j += step) {
+            f(tmp + j * 64, 64, output + j * 32, ctx + first, 0);
+        }
+
+        for (size_t j = first; j < last; ++j) {
+            memcpy(tmp + j * 64, output + j * 32, 32);
+            memset(tmp + j * 64 + 32, 0, 32);
+        }
+    };
 
-            for (size_t j = 0; j < n; ++j) {
-                memcpy(tmp + j * 64, output + j * 32, 32);
-                memset(tmp + j * 64 + 32, 0, 32);
+    // lanes [0, half) are hashed by this thread and [half, lanes) by helper thread
+    const size_t half = lanes / 2;
+
+    if (helper && half && (tune[cn_indices[0]].threads == 2) && (tune[cn_indices[1]].threads == 2) && (tune[cn_indices[2]].threads == 2)) {
+        helper->launch_task([half, lanes, &hash_part]() {
+            for (size_t part = 0; part < 3; ++part) {
+                hash_part(part, half, lanes);
             }
+        });
+
+        for (size_t part = 0; part < 3; ++part) {
+            hash_part(part, 0, half);
+        }
 
-            if (helper && (t.threads == 2)) {
+        helper->wait();
+    }
+    else {
+        for (size_t part = 0; part < 3; ++part) {
+            if (helper && half && (tune[cn_indices[part]].threads == 2)) {
+                helper->launch_task([part, half, lanes, &hash_part]() { hash_part(part, half, lanes); });
+                hash_part(part, 0, half);
                 helper->wait();
             }
+            else {
+                hash_part(part, 0, lanes);
+            }
         }
     }
 
-    for (size_t i = 0; i < N; ++i) {
+    for (size_t i = 0; i < lanes; ++i) {
         ctx[i]->memory = ctx_memory[i];
     }
 }
+// MOMINER PATCH END
 
 
+// MOMINER PATCH BEGIN: stubs are only used on ARM/RISC-V without hwloc.
 #else // XMRIG_FEATURE_HWLOC
+// MOMINER PATCH END
 
 
 void benchmark() {}
 HelperThread* create_helper_thread(int64_t, int, const std::vector<int64_t>&) { return nullptr; }
 void destroy_helper_thread(HelperThread*) {}
+// MOMINER PATCH BEGIN: per cpu tuning stubs (fixed steps below are used).
+void benchmark(int64_t, int64_t) {}
+int64_t find_helper_cpu(int64_t, const std::vector<int64_t>&) { return -1; }
+std::string tune_info() { return "fixed"; }
+// MOMINER PATCH END
 
 
-void hash_octa(const uint8_t* data, size_t size, uint8_t* output, cryptonight_ctx** ctx, HelperThread*, bool verbose)
+// MOMINER PATCH BEGIN: hash_octa is generalized to 1, 2, 4 or 8 lanes hashed with job rotation selected by the caller.
+void hash_lanes(const uint8_t* data, size_t size, uint8_t* output, cryptonight_ctx** ctx, size_t lanes, const Rotation& rotation, HelperThread*)
 {
     constexpr uint32_t N = 8;
 
     uint8_t* ctx_memory[N];
-    for (size_t i = 0; i < N; ++i) {
+    for (size_t i = 0; i < lanes; ++i) {
         ctx_memory[i] = ctx[i]->memory;
     }
 
-    // PrevBlockHash (GhostRider's seed) is stored in bytes [4; 36)
-    const uint8_t* seed = data + 4;
-
-    uint32_t core_indices[15];
-    select_indices(core_indices, seed);
-
-    uint32_t cn_indices[6];
-    select_indices(cn_indices, seed);
+    const uint32_t* core_indices = rotation.core_indices;
+    const uint32_t* cn_indices   = rotation.cn_indices;
 
 #if defined(XMRIG_ARM) || defined(XMRIG_RISCV)
     uint32_t step[6] = { 1, 1, 1, 1, 1, 1 };
@@ -819,14 +1001,8 @@ void hash_octa(const uint8_t* data, size_t size, uint8_t* output, cryptonight_ct
     uint32_t step[6] = { 4, 4, 1, 2, 4, 4 };
 #endif
 
-    if (verbose) {
-        static uint32_t prev_indices[3];
-        if (memcmp(cn_indices, prev_indices, sizeof(prev_indices)) != 0) {
-            memcpy(prev_indices, cn_indices, sizeof(prev_indices));
-            for (int i = 0; i < 3; ++i) {
-                LOG_INFO("%s GhostRider algo %d: %s", Tags::cpu(), i + 1, cn_names[cn_indices[i]]);
-            }
-        }
+    for (uint32_t& s : step) {
+        s = std::min<uint32_t>(s, static_cast<uint32_t>(lanes));
     }
 
     const CnHash::AlgoVariant* av = Cpu::info()->hasAES() ? av_hw_aes : av_soft_aes;
@@ -839,7 +1015,7 @@ void hash_octa(const uint8_t* data, size_t size, uint8_t* output, cryptonight_ct
         {
             uint8_t* p = ctx_memory[0];
 
-            for (size_t i = 0, k = 0; i < N; ++i) {
+            for (size_t i = 0, k = 0; i < lanes; ++i) {
                 if ((i % step[cn_indices[part]]) == 0) {
                     k = 0;
                     p = ctx_memory[0];
@@ -854,33 +1030,61 @@ void hash_octa(const uint8_t* data, size_t size, uint8_t* output, cryptonight_ct
         }
 
         for (size_t i = 0; i < 5; ++i) {
-            for (size_t j = 0; j < N; ++j) {
-                core_hash[core_indices[part * 5 + i]](data + j * size, size, tmp + j * 64);
-            }
+            core_hash_lanes(core_indices[part * 5 + i], data, size, tmp, lanes);
             data = tmp;
             size = 64;
         }
 
         auto f = CnHash::fn(cn_hash[cn_indices[part]], av[step[cn_indices[part]]], Assembly::AUTO);
-        for (size_t j = 0; j < N; j += step[cn_indices[part]]) {
+        for (size_t j = 0; j < lanes; j += step[cn_indices[part]]) {
             f(tmp + j * 64, 64, output + j * 32, ctx, 0);
         }
 
-        for (size_t j = 0; j < N; ++j) {
+        for (size_t j = 0; j < lanes; ++j) {
             memcpy(tmp + j * 64, output + j * 32, 32);
             memset(tmp + j * 64 + 32, 0, 32);
         }
     }
 
-    for (size_t i = 0; i < N; ++i) {
+    for (size_t i = 0; i < lanes; ++i) {
         ctx[i]->memory = ctx_memory[i];
     }
 }
+// MOMINER PATCH END
 
 
 #endif // XMRIG_FEATURE_HWLOC
 
 
+// MOMINER PATCH BEGIN: job rotation is selected apart from hashing so callers can reuse it for all nonces of a job.
+void select_rotation(const uint8_t* data, Rotation& rotation)
+{
+    // PrevBlockHash (GhostRider's seed) is stored in bytes [4; 36)
+    select_indices(rotation.core_indices, data + 4);
+    select_indices(rotation.cn_indices, data + 4);
+}
+
+
+void hash_octa(const uint8_t* data, size_t size, uint8_t* output, cryptonight_ctx** ctx, HelperThread* helper, bool verbose)
+{
+    Rotation rotation;
+    select_rotation(data, rotation);
+
+    if (verbose) {
+        static uint32_t prev_indices[3];
+        if (memcmp(rotation.cn_indices, prev_indices, sizeof(prev_indices)) != 0) {
+            memcpy(prev_indices, rotation.cn_indices, sizeof(prev_indices));
+            for (int i = 0; i < 3; ++i) {
+                LOG_INFO("%s GhostRider algo %d: %s", Tags::cpu(), i + 1, cn_names[rotation.cn_indices[i]]);
+            }
+        }
+    }
+
+    hash_lanes(data, size, output, ctx, 8, rotation, helper);
+}
+// MOMINER PATCH END
+
+
 } // namespace ghostrider
 
 
@@ -22,6 +22,9 @@
 
 #include <cstddef>
 #include <cstdint>
+// MOMINER PATCH BEGIN: tune_info result.
+#include <string>
+// MOMINER PATCH END
 #include <vector>
 
 
@@ -43,6 +46,37 @@ HelperThread* create_helper_thread(int64_t cpu_index, int priority, const std::v
 void destroy_helper_thread(HelperThread* t);
 void hash_octa(const uint8_t* data, size_t size, uint8_t* output, cryptonight_ctx** ctx, HelperThread* helper, bool verbose = true);
 
+// MOMINER PATCH BEGIN: per cpu tuning and helper threads without hwloc.
+// tunes GhostRider cn algos on cpu_index with helper thread on helper_cpu_index (-1 for none) once per cpu pair and
+// selects results (8 MB scratchpad ones if L3 cache share of cpu_index fits them) for hash_octa calls of the calling thread
+void benchmark(int64_t cpu_index, int64_t helper_cpu_index);
+// returns free SMT sibling cpu of cpu_index that is not in affinities (-1 if there is none)
+int64_t find_helper_cpu(int64_t cpu_index, const std::vector<int64_t>& affinities);
+// returns "<step>x<threads>" tune list of GhostRider cn algos selected for the calling thread
+std::string tune_info();
+// MOMINER PATCH END
+
+// MOMINER PATCH BEGIN: 1, 2, 4 or 8 lanes with job rotation that is selected once per job.
+// core hash and cn algo order of a job (it only depends on PrevBlockHash of job blob)
+struct Rotation
+{
+    uint32_t core_indices[15];
+    uint32_t cn_indices[6];
+};
+
+void select_rotation(const uint8_t* data, Rotation& rotation);
+// hashes lanes (1, 2, 4 or 8) inputs of size bytes with rotation of their job
+void hash_lanes(const uint8_t* data, size_t size, uint8_t* output, cryptonight_ctx** ctx, size_t lanes, const Rotation& rotation, HelperThread* helper);
+// MOMINER PATCH END
+
+// MOMINER PATCH BEGIN: multi-buffer core hashes of lanes.
+// core hashes of lanes use multi-buffer code where there is one (set by gr_core job option)
+extern bool core_multi_enabled;
+// hashes lanes (1..8) inputs of size bytes at data + i * size with core hash index (0..14) to 64 byte outputs at
+// output + i * 64 (output may be data if size is 64)
+void core_hash_lanes(uint32_t index, const uint8_t* data, size_t size, uint8_t* output, size_t lanes);
+// MOMINER PATCH END
+
 
 } // namespace ghostrider
 
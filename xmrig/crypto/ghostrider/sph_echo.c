@@ -1027,6 +1027,136 @@ sph_echo512_addbits_and_close(void *cc, unsigned ub, unsigned n, void *dst)
 {
 	echo_big_close(cc, ub, n, dst, 16);
 }
+/* MOMINER PATCH BEGIN: multi-buffer echo512 of GhostRider lanes (4 single block messages of the same length per VAES-512 pass). */
+#if defined(HAVE_VAES) && defined(HAVE_AVX512F)
+#include <immintrin.h>
+
+/* 2 * x in GF(2^8) of all bytes */
+static inline __m512i
+echo_x4_xtime(__m512i x)
+{
+	const __m512i hi = _mm512_and_si512(_mm512_srli_epi32(x, 7), _mm512_set1_epi8(0x01));
+	const __m512i lo = _mm512_slli_epi32(_mm512_and_si512(x, _mm512_set1_epi8(0x7F)), 1);
+	return _mm512_xor_si512(lo, _mm512_xor_si512(
+		_mm512_xor_si512(hi, _mm512_slli_epi32(hi, 1)),
+		_mm512_xor_si512(_mm512_slli_epi32(hi, 3), _mm512_slli_epi32(hi, 4))));
+}
+
+#define ECHO_X4_MIX_COLUMN(ia, ib, ic, id)   do { \
+		const __m512i a = W[ia], b = W[ib], c = W[ic], d = W[id]; \
+		const __m512i ab = _mm512_xor_si512(a, b); \
+		const __m512i bc = _mm512_xor_si512(b, c); \
+		const __m512i cd = _mm512_xor_si512(c, d); \
+		const __m512i abx = echo_x4_xtime(ab); \
+		const __m512i bcx = echo_x4_xtime(bc); \
+		const __m512i cdx = echo_x4_xtime(cd); \
+		W[ia] = _mm512_xor_si512(abx, _mm512_xor_si512(bc, d)); \
+		W[ib] = _mm512_xor_si512(bcx, _mm512_xor_si512(a, cd)); \
+		W[ic] = _mm512_xor_si512(cdx, _mm512_xor_si512(ab, d)); \
+		W[id] = _mm512_xor_si512(_mm512_xor_si512(abx, bcx), \
+			_mm512_xor_si512(cdx, _mm512_xor_si512(ab, c))); \
+	} while (0)
+
+#define ECHO_X4_ROTATE(a, b, c, d)   do { \
+		const __m512i t = W[a]; \
+		W[a] = W[b]; \
+		W[b] = W[c]; \
+		W[c] = W[d]; \
+		W[d] = t; \
+	} while (0)
+
+#define ECHO_X4_SWAP(a, b)   do { \
+		const __m512i t = W[a]; \
+		W[a] = W[b]; \
+		W[b] = t; \
+	} while (0)
+
+/* 128-bit lane l of each W word is the state of message l */
+static void
+echo512_x4(unsigned char *const *out, const unsigned char *const *in, size_t len)
+{
+	unsigned char buf[4][128];
+	__m512i W[16], M[8];
+	sph_u64 k = (sph_u64)len << 3;
+	unsigned l, u, r;
+
+	for (l = 0; l < 4; l ++) {
+		memcpy(buf[l], in[l], len);
+		buf[l][len] = 0x80;
+		memset(buf[l] + len + 1, 0, 128 - len - 1);
+		sph_enc16le(buf[l] + 110, 512);
+		sph_enc64le(buf[l] + 112, k);
+	}
+	for (u = 0; u < 8; u ++) {
+		M[u] = _mm512_inserti32x4(_mm512_castsi128_si512(
+			_mm_loadu_si128((const __m128i *)(buf[0] + 16 * u))),
+			_mm_loadu_si128((const __m128i *)(buf[1] + 16 * u)), 1);
+		M[u] = _mm512_inserti32x4(M[u], _mm_loadu_si128((const __m128i *)(buf[2] + 16 * u)), 2);
+		M[u] = _mm512_inserti32x4(M[u], _mm_loadu_si128((const __m128i *)(buf[3] + 16 * u)), 3);
+		W[u] = _mm512_broadcast_i32x4(_mm_set_epi64x(0, 512));
+		W[u + 8] = M[u];
+	}
+
+	for (r = 0; r < 10; r ++) {
+		for (u = 0; u < 16; u ++) {
+			const __m512i key = _mm512_broadcast_i32x4(_mm_set_epi64x(0, (long long)k ++));
+			W[u] = _mm512_aesenc_epi128(_mm512_aesenc_epi128(W[u], key), _mm512_setzero_si512());
+		}
+		ECHO_X4_ROTATE(1, 5, 9, 13);
+		ECHO_X4_SWAP(2, 10);
+		ECHO_X4_SWAP(6, 14);
+		ECHO_X4_ROTATE(15, 11, 7, 3);
+		ECHO_X4_MIX_COLUMN(0, 1, 2, 3);
+		ECHO_X4_MIX_COLUMN(4, 5, 6, 7);
+		ECHO_X4_MIX_COLUMN(8, 9, 10, 11);
+		ECHO_X4_MIX_COLUMN(12, 13, 14, 15);
+	}
+
+	/* only the first 4 words of the chaining value are output */
+	for (u = 0; u < 4; u ++) {
+		const __m512i v = _mm512_xor_si512(
+			_mm512_xor_si512(_mm512_broadcast_i32x4(_mm_set_epi64x(0, 512)), M[u]),
+			_mm512_xor_si512(W[u], W[u + 8]));
+		_mm_storeu_si128((__m128i *)(out[0] + 16 * u), _mm512_extracti32x4_epi32(v, 0));
+		_mm_storeu_si128((__m128i *)(out[1] + 16 * u), _mm512_extracti32x4_epi32(v, 1));
+		_mm_storeu_si128((__m128i *)(out[2] + 16 * u), _mm512_extracti32x4_epi32(v, 2));
+		_mm_storeu_si128((__m128i *)(out[3] + 16 * u), _mm512_extracti32x4_epi32(v, 3));
+	}
+}
+
+#undef ECHO_X4_MIX_COLUMN
+#undef ECHO_X4_ROTATE
+#undef ECHO_X4_SWAP
+
+#endif
+
+/* see sph_echo.h */
+void
+sph_echo512_multi(unsigned char *const *out, const unsigned char *const *in, size_t len, size_t n)
+{
+	size_t i = 0;
+#if defined(HAVE_VAES) && defined(HAVE_AVX512F)
+	/* 4 lane pass is faster than scalar code even for 1 message */
+	for (; len < 110 && i < n; i += 4) {
+		/* missing lanes repeat the last message and their hashes are dropped */
+		const unsigned char *lane_in[4];
+		unsigned char *lane_out[4], dummy[4][64];
+		size_t j;
+		for (j = 0; j < 4; ++j) {
+			lane_in[j]  = i + j < n ? in[i + j]  : in[n - 1];
+			lane_out[j] = i + j < n ? out[i + j] : dummy[j];
+		}
+		echo512_x4(lane_out, lane_in, len);
+	}
+#endif
+	for (; i < n; ++i) {
+		sph_echo512_context cc;
+		sph_echo512_init(&cc);
+		sph_echo512(&cc, in[i], len);
+		sph_echo512_close(&cc, out[i]);
+	}
+}
+/* MOMINER PATCH END */
 #ifdef __cplusplus
 }
 #endif
@@ -313,6 +313,15 @@ void sph_echo512_close(void *cc, void *dst);
 void sph_echo512_addbits_and_close(
 	void *cc, unsigned ub, unsigned n, void *dst);
 
+/* MOMINER PATCH BEGIN: multi-buffer echo512 of GhostRider lanes. */
+/**
+ * Compute ECHO-512 of <code>n</code> messages of <code>len</code> bytes
+ * each (1 to 8 messages). Output buffer i may be input buffer i.
+ */
+void sph_echo512_multi(unsigned char *const *out,
+	const unsigned char *const *in, size_t len, size_t n);
+/* MOMINER PATCH END */
+
 #ifdef __cplusplus
 }
 #endif
@@ -3115,6 +3115,157 @@ sph_groestl512_addbits_and_close(void *cc, unsigned ub, unsigned n, void *dst)
 	groestl_big_close(cc, ub, n, dst, 64);
 }
 
+/* MOMINER PATCH BEGIN: multi-buffer groestl512 of GhostRider lanes (4 single block messages of the same length per VAES-512 pass). */
+#if defined(HAVE_VAES) && defined(HAVE_AVX512F) && defined(__AVX512BW__)
+#include <immintrin.h>
+
+/* 2 * x in GF(2^8) of all bytes */
+static inline __m512i
+groestl_x4_xtime(__m512i x)
+{
+	return _mm512_xor_si512(_mm512_add_epi8(x, x),
+		_mm512_maskz_set1_epi8(_mm512_movepi8_mask(x), 0x1B));
+}
+
+#define GROESTL_X4_XOR3(a, b, c)   _mm512_ternarylogic_epi64((a), (b), (c), 0x96)
+
+/*
+ * P1024 (q = 0) or Q1024 (q = 1) of 4 states. x[i] is row i (16 column
+ * bytes) of one state in each 128-bit lane.
+ */
+static void
+groestl_x4_perm(__m512i x[8], int q)
+{
+	static const unsigned char sigma[2][8] = {
+		{ 0, 1, 2, 3, 4, 5, 6, 11 }, { 1, 3, 5, 11, 0, 2, 4, 6 }
+	};
+	/* AESENCLAST does ShiftRows before SubBytes, so bytes are picked with
+	   inverse ShiftRows and row shift of ShiftBytes before it */
+	const __m512i inv_shift_rows = _mm512_broadcast_i32x4(_mm_setr_epi8(
+		0, 13, 10, 7, 4, 1, 14, 11, 8, 5, 2, 15, 12, 9, 6, 3));
+	const __m512i columns = _mm512_broadcast_i32x4(_mm_setr_epi8(
+		0x00, 0x10, 0x20, 0x30, 0x40, 0x50, 0x60, 0x70,
+		(char)0x80, (char)0x90, (char)0xA0, (char)0xB0,
+		(char)0xC0, (char)0xD0, (char)0xE0, (char)0xF0));
+	const __m512i ones = _mm512_set1_epi8((char)0xFF);
+	__m512i shuf[8], y[8], x2[8], x4[8];
+	int i, r;
+
+	for (i = 0; i < 8; i ++) {
+		shuf[i] = _mm512_and_si512(_mm512_add_epi8(inv_shift_rows,
+			_mm512_set1_epi8((char)sigma[q][i])), _mm512_set1_epi8(15));
+	}
+	for (r = 0; r < 14; r ++) {
+		const __m512i rc = _mm512_xor_si512(columns, _mm512_set1_epi8((char)r));
+
+		if (q) {
+			for (i = 0; i < 7; i ++)
+				x[i] = _mm512_xor_si512(x[i], ones);
+			x[7] = GROESTL_X4_XOR3(x[7], rc, ones);
+		} else {
+			x[0] = _mm512_xor_si512(x[0], rc);
+		}
+		for (i = 0; i < 8; i ++) {
+			y[i] = _mm512_aesenclast_epi128(_mm512_shuffle_epi8(x[i], shuf[i]),
+				_mm512_setzero_si512());
+			x2[i] = groestl_x4_xtime(y[i]);
+			x4[i] = groestl_x4_xtime(x2[i]);
+		}
+		/* MixBytes: circulant (2, 2, 3, 4, 5, 3, 5, 7) on each column */
+		for (i = 0; i < 8; i ++) {
+			const __m512i t0 = GROESTL_X4_XOR3(x2[i], x2[(i + 1) & 7], x2[(i + 2) & 7]);
+			const __m512i t1 = GROESTL_X4_XOR3(y[(i + 2) & 7], x4[(i + 3) & 7], x4[(i + 4) & 7]);
+			const __m512i t2 = GROESTL_X4_XOR3(y[(i + 4) & 7], x2[(i + 5) & 7], y[(i + 5) & 7]);
+			const __m512i t3 = GROESTL_X4_XOR3(x4[(i + 6) & 7], y[(i + 6) & 7], x4[(i + 7) & 7]);
+			const __m512i t4 = GROESTL_X4_XOR3(x2[(i + 7) & 7], y[(i + 7) & 7], t0);
+			x[i] = GROESTL_X4_XOR3(t1, t2, _mm512_xor_si512(t3, t4));
+		}
+	}
+}
+
+#undef GROESTL_X4_XOR3
+
+static void
+groestl512_x4(unsigned char *const *out, const unsigned char *const *in, size_t len)
+{
+	/* rows of padded blocks (byte 8 * column + row of the block is row
+	   byte 16 * row + column) */
+	unsigned char rows[4][128];
+	__m512i h[8], m[8], p[8];
+	unsigned l, u;
+
+	for (l = 0; l < 4; l ++) {
+		unsigned char block[128];
+
+		memcpy(block, in[l], len);
+		block[len] = 0x80;
+		memset(block + len + 1, 0, 127 - len);
+		block[127] = 1;
+		for (u = 0; u < 128; u ++)
+			rows[l][16 * (u & 7) + (u >> 3)] = block[u];
+	}
+	for (u = 0; u < 8; u ++) {
+		m[u] = _mm512_inserti32x4(_mm512_castsi128_si512(
+			_mm_loadu_si128((const __m128i *)(rows[0] + 16 * u))),
+			_mm_loadu_si128((const __m128i *)(rows[1] + 16 * u)), 1);
+		m[u] = _mm512_inserti32x4(m[u], _mm_loadu_si128((const __m128i *)(rows[2] + 16 * u)), 2);
+		m[u] = _mm512_inserti32x4(m[u], _mm_loadu_si128((const __m128i *)(rows[3] + 16 * u)), 3);
+		/* IV is 512 as a big endian number in the last 2 state bytes */
+		h[u] = u == 6 ? _mm512_broadcast_i32x4(_mm_setr_epi8(0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 2))
+			: _mm512_setzero_si512();
+		p[u] = _mm512_xor_si512(h[u], m[u]);
+	}
+
+	/* h = P(h ^ m) ^ Q(m) ^ h */
+	groestl_x4_perm(p, 0);
+	groestl_x4_perm(m, 1);
+	for (u = 0; u < 8; u ++) {
+		h[u] = _mm512_ternarylogic_epi64(h[u], p[u], m[u], 0x96);
+		p[u] = h[u];
+	}
+
+	/* output is the last 64 bytes (columns 8..15) of P(h) ^ h */
+	groestl_x4_perm(p, 0);
+	for (u = 0; u < 8; u ++)
+		_mm512_storeu_si512((__m512i *)rows + u, _mm512_xor_si512(h[u], p[u]));
+	for (l = 0; l < 4; l ++) {
+		const unsigned char *row = (const unsigned char *)rows + 16 * l;
+
+		for (u = 0; u < 64; u ++)
+			out[l][u] = row[64 * (u & 7) + 8 + (u >> 3)];
+	}
+}
+
+#endif
+
+/* see sph_groestl.h */
+void
+sph_groestl512_multi(unsigned char *const *out, const unsigned char *const *in, size_t len, size_t n)
+{
+	size_t i = 0;
+#if defined(HAVE_VAES) && defined(HAVE_AVX512F) && defined(__AVX512BW__)
+	/* 4 lane pass is only faster than scalar code for 2+ messages */
+	for (; len < 120 && i + 1 < n; i += 4) {
+		/* missing lanes repeat the last message and their hashes are dropped */
+		const unsigned char *lane_in[4];
+		unsigned char *lane_out[4], dummy[4][64];
+		size_t j;
+		for (j = 0; j < 4; ++j) {
+			lane_in[j]  = i + j < n ? in[i + j]  : in[n - 1];
+			lane_out[j] = i + j < n ? out[i + j] : dummy[j];
+		}
+		groestl512_x4(lane_out, lane_in, len);
+	}
+#endif
+	for (; i < n; ++i) {
+		sph_groestl512_context cc;
+		sph_groestl512_init(&cc);
+		sph_groestl512(&cc, in[i], len);
+		sph_groestl512_close(&cc, out[i]);
+	}
+}
+/* MOMINER PATCH END */
+
 #ifdef __cplusplus
 }
 
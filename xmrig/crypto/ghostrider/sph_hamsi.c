@@ -862,6 +862,217 @@ sph_hamsi512_addbits_and_close(void *cc, unsigned ub, unsigned n, void *dst)
 //	hamsi_big_init(cc, IV512);
 }
 
+/* MOMINER PATCH BEGIN: multi-buffer hamsi512 of GhostRider lanes (8 messages of the same length per AVX2 pass). */
+#if defined(HAVE_AVX2) && SPH_HAMSI_EXPAND_BIG == 8
+#include <immintrin.h>
+
+#define HAMSI_X8_ROTL(x, n)   _mm256_or_si256(_mm256_slli_epi32((x), (n)), _mm256_srli_epi32((x), 32 - (n)))
+
+#define HAMSI_X8_SBOX(a, b, c, d)   do { \
+		__m256i t = S[a]; \
+		S[a] = _mm256_and_si256(S[a], S[c]); \
+		S[a] = _mm256_xor_si256(S[a], S[d]); \
+		S[c] = _mm256_xor_si256(S[c], S[b]); \
+		S[c] = _mm256_xor_si256(S[c], S[a]); \
+		S[d] = _mm256_or_si256(S[d], t); \
+		S[d] = _mm256_xor_si256(S[d], S[b]); \
+		t = _mm256_xor_si256(t, S[c]); \
+		S[b] = S[d]; \
+		S[d] = _mm256_or_si256(S[d], t); \
+		S[d] = _mm256_xor_si256(S[d], S[a]); \
+		S[a] = _mm256_and_si256(S[a], S[b]); \
+		t = _mm256_xor_si256(t, S[a]); \
+		S[b] = _mm256_xor_si256(S[b], S[d]); \
+		S[b] = _mm256_xor_si256(S[b], t); \
+		S[a] = S[c]; \
+		S[c] = S[b]; \
+		S[b] = S[d]; \
+		S[d] = _mm256_xor_si256(t, ones); \
+	} while (0)
+
+#define HAMSI_X8_L(a, b, c, d)   do { \
+		S[a] = HAMSI_X8_ROTL(S[a], 13); \
+		S[c] = HAMSI_X8_ROTL(S[c], 3); \
+		S[b] = _mm256_xor_si256(S[b], _mm256_xor_si256(S[a], S[c])); \
+		S[d] = _mm256_xor_si256(S[d], _mm256_xor_si256(S[c], _mm256_slli_epi32(S[a], 3))); \
+		S[b] = HAMSI_X8_ROTL(S[b], 1); \
+		S[d] = HAMSI_X8_ROTL(S[d], 7); \
+		S[a] = _mm256_xor_si256(S[a], _mm256_xor_si256(S[b], S[d])); \
+		S[c] = _mm256_xor_si256(S[c], _mm256_xor_si256(S[d], _mm256_slli_epi32(S[b], 7))); \
+		S[a] = HAMSI_X8_ROTL(S[a], 5); \
+		S[c] = HAMSI_X8_ROTL(S[c], 22); \
+	} while (0)
+
+/* 8x8 transpose of 32-bit words */
+static inline void
+hamsi_x8_transpose(__m256i r[8])
+{
+	__m256i t[8], u[8];
+	int i;
+
+	for (i = 0; i < 4; i ++) {
+		t[2 * i]     = _mm256_unpacklo_epi32(r[2 * i], r[2 * i + 1]);
+		t[2 * i + 1] = _mm256_unpackhi_epi32(r[2 * i], r[2 * i + 1]);
+	}
+	for (i = 0; i < 2; i ++) {
+		u[4 * i]     = _mm256_unpacklo_epi64(t[4 * i], t[4 * i + 2]);
+		u[4 * i + 1] = _mm256_unpackhi_epi64(t[4 * i], t[4 * i + 2]);
+		u[4 * i + 2] = _mm256_unpacklo_epi64(t[4 * i + 1], t[4 * i + 3]);
+		u[4 * i + 3] = _mm256_unpackhi_epi64(t[4 * i + 1], t[4 * i + 3]);
+	}
+	for (i = 0; i < 4; i ++) {
+		r[i]     = _mm256_permute2x128_si256(u[i], u[i + 4], 0x20);
+		r[i + 4] = _mm256_permute2x128_si256(u[i], u[i + 4], 0x31);
+	}
+}
+
+/*
+ * Lane l of each 32-bit word vector is for message l. State words are
+ * kept in the s00..s1F order of ROUND_BIG (message words are expanded
+ * into s00, s01, s04, s05, s0A, s0B, s0E, s0F, s10, s11, s14, s15, s1A,
+ * s1B, s1E, s1F and chaining words c0..cF fill the rest).
+ */
+static void
+hamsi512_x8(unsigned char *const *out, const unsigned char *const *in, size_t len)
+{
+	static const unsigned char m_pos[16] = {
+		0x00, 0x01, 0x04, 0x05, 0x0A, 0x0B, 0x0E, 0x0F,
+		0x10, 0x11, 0x14, 0x15, 0x1A, 0x1B, 0x1E, 0x1F
+	};
+	static const unsigned char c_pos[16] = {
+		0x02, 0x03, 0x06, 0x07, 0x08, 0x09, 0x0C, 0x0D,
+		0x12, 0x13, 0x16, 0x17, 0x18, 0x19, 0x1C, 0x1D
+	};
+	static const sph_u32 (*const tables[8])[16] = {
+		T512_0, T512_8, T512_16, T512_24, T512_32, T512_40, T512_48, T512_56
+	};
+	/* message and padding blocks followed by the bit count block */
+	unsigned char buf[8][136];
+	const size_t blocks = (len >> 3) + 2;
+	const __m256i ones = _mm256_set1_epi32(-1);
+	__m256i h[16], S[32];
+	size_t b;
+	unsigned l, u, r;
+
+	for (l = 0; l < 8; l ++) {
+		memcpy(buf[l], in[l], len);
+		buf[l][len] = 0x80;
+		memset(buf[l] + len + 1, 0, ((blocks - 1) << 3) - len - 1);
+		sph_enc64be(buf[l] + ((blocks - 1) << 3), (sph_u64)len << 3);
+	}
+	for (u = 0; u < 16; u ++)
+		h[u] = _mm256_set1_epi32((int)IV512[u]);
+
+	for (b = 0; b < blocks; b ++) {
+		const int final = b == blocks - 1;
+		__m256i lo[8], hi[8];
+
+		/* expansion of the block of each lane is the xor of byte table rows */
+		for (l = 0; l < 8; l ++) {
+			const unsigned char *p = buf[l] + (b << 3);
+			lo[l] = _mm256_setzero_si256();
+			hi[l] = _mm256_setzero_si256();
+			for (u = 0; u < 8; u ++) {
+				const sph_u32 *row = tables[u][p[u]];
+				lo[l] = _mm256_xor_si256(lo[l], _mm256_loadu_si256((const __m256i *)row));
+				hi[l] = _mm256_xor_si256(hi[l], _mm256_loadu_si256((const __m256i *)(row + 8)));
+			}
+		}
+		hamsi_x8_transpose(lo);
+		hamsi_x8_transpose(hi);
+		for (u = 0; u < 8; u ++) {
+			S[m_pos[u]] = lo[u];
+			S[m_pos[u + 8]] = hi[u];
+		}
+		for (u = 0; u < 16; u ++)
+			S[c_pos[u]] = h[u];
+
+		for (r = 0; r < (final ? 12u : 6u); r ++) {
+			const sph_u32 *alpha = final ? alpha_f : alpha_n;
+			for (u = 0; u < 32; u ++)
+				S[u] = _mm256_xor_si256(S[u], _mm256_set1_epi32((int)(alpha[u] ^ (u == 1 ? r : 0))));
+			HAMSI_X8_SBOX(0x00, 0x08, 0x10, 0x18);
+			HAMSI_X8_SBOX(0x01, 0x09, 0x11, 0x19);
+			HAMSI_X8_SBOX(0x02, 0x0A, 0x12, 0x1A);
+			HAMSI_X8_SBOX(0x03, 0x0B, 0x13, 0x1B);
+			HAMSI_X8_SBOX(0x04, 0x0C, 0x14, 0x1C);
+			HAMSI_X8_SBOX(0x05, 0x0D, 0x15, 0x1D);
+			HAMSI_X8_SBOX(0x06, 0x0E, 0x16, 0x1E);
+			HAMSI_X8_SBOX(0x07, 0x0F, 0x17, 0x1F);
+			HAMSI_X8_L(0x00, 0x09, 0x12, 0x1B);
+			HAMSI_X8_L(0x01, 0x0A, 0x13, 0x1C);
+			HAMSI_X8_L(0x02, 0x0B, 0x14, 0x1D);
+			HAMSI_X8_L(0x03, 0x0C, 0x15, 0x1E);
+			HAMSI_X8_L(0x04, 0x0D, 0x16, 0x1F);
+			HAMSI_X8_L(0x05, 0x0E, 0x17, 0x18);
+			HAMSI_X8_L(0x06, 0x0F, 0x10, 0x19);
+			HAMSI_X8_L(0x07, 0x08, 0x11, 0x1A);
+			HAMSI_X8_L(0x00, 0x02, 0x05, 0x07);
+			HAMSI_X8_L(0x10, 0x13, 0x15, 0x16);
+			HAMSI_X8_L(0x09, 0x0B, 0x0C, 0x0E);
+			HAMSI_X8_L(0x19, 0x1A, 0x1C, 0x1F);
+		}
+
+		for (u = 0; u < 8; u ++) {
+			h[u] = _mm256_xor_si256(h[u], S[u]);
+			h[u + 8] = _mm256_xor_si256(h[u + 8], S[u + 0x10]);
+		}
+	}
+
+	/* output words are big endian */
+	{
+		const __m256i bswap = _mm256_setr_epi8(
+			3, 2, 1, 0, 7, 6, 5, 4, 11, 10, 9, 8, 15, 14, 13, 12,
+			3, 2, 1, 0, 7, 6, 5, 4, 11, 10, 9, 8, 15, 14, 13, 12);
+		__m256i lo[8], hi[8];
+
+		for (u = 0; u < 8; u ++) {
+			lo[u] = _mm256_shuffle_epi8(h[u], bswap);
+			hi[u] = _mm256_shuffle_epi8(h[u + 8], bswap);
+		}
+		hamsi_x8_transpose(lo);
+		hamsi_x8_transpose(hi);
+		for (l = 0; l < 8; l ++) {
+			_mm256_storeu_si256((__m256i *)out[l], lo[l]);
+			_mm256_storeu_si256((__m256i *)(out[l] + 32), hi[l]);
+		}
+	}
+}
+
+#undef HAMSI_X8_ROTL
+#undef HAMSI_X8_SBOX
+#undef HAMSI_X8_L
+
+#endif
+
+/* see sph_hamsi.h */
+void
+sph_hamsi512_multi(unsigned char *const *out, const unsigned char *const *in, size_t len, size_t n)
+{
+	size_t i = 0;
+#if defined(HAVE_AVX2) && SPH_HAMSI_EXPAND_BIG == 8
+	/* 8 lane pass is only faster than scalar code for 3+ messages */
+	for (; len < 120 && i + 2 < n; i += 8) {
+		/* missing lanes repeat the last message and their hashes are dropped */
+		const unsigned char *lane_in[8];
+		unsigned char *lane_out[8], dummy[8][64];
+		size_t j;
+		for (j = 0; j < 8; ++j) {
+			lane_in[j]  = i + j < n ? in[i + j]  : in[n - 1];
+			lane_out[j] = i + j < n ? out[i + j] : dummy[j];
+		}
+		hamsi512_x8(lane_out, lane_in, len);
+	}
+#endif
+	for (; i < n; ++i) {
+		sph_hamsi512_context cc;
+		sph_hamsi512_init(&cc);
+		sph_hamsi512(&cc, in[i], len);
+		sph_hamsi512_close(&cc, out[i]);
+	}
+}
+/* MOMINER PATCH END */
+
 #ifdef __cplusplus
 }
 #endif
@@ -314,6 +314,15 @@ void sph_hamsi512_addbits_and_close(
 
 
 
+/* MOMINER PATCH BEGIN: multi-buffer hamsi512 of GhostRider lanes. */
+/**
+ * Compute Hamsi-512 of <code>n</code> messages of <code>len</code> bytes
+ * each (1 to 8 messages). Output buffer i may be input buffer i.
+ */
+void sph_hamsi512_multi(unsigned char *const *out,
+	const unsigned char *const *in, size_t len, size_t n);
+/* MOMINER PATCH END */
+
 #ifdef __cplusplus
 }
 #endif
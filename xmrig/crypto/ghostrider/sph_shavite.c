@@ -1759,6 +1759,128 @@ sph_shavite512_addbits_and_close(void *cc, unsigned ub, unsigned n, void *dst)
 	shavite_big_init(cc, IV512);
 }
 
+/* MOMINER PATCH BEGIN: multi-buffer shavite512 of GhostRider lanes (4 single block messages of the same length per VAES-512 pass). */
+#if defined(HAVE_VAES) && defined(HAVE_AVX512F)
+#include <immintrin.h>
+
+/* 128-bit lane l of each key and state word is for message l */
+static void
+shavite512_x4(unsigned char *const *out, const unsigned char *const *in, size_t len)
+{
+	unsigned char buf[4][128];
+	__m512i rk[112], h[4], p[4];
+	const __m512i zero = _mm512_setzero_si512();
+	const sph_u32 c0 = (sph_u32)len << 3;
+	/* counter words xored into key words 8, 41, 79 and 110 */
+	const __m512i cnt8   = _mm512_broadcast_i32x4(_mm_setr_epi32((int)c0, 0, 0, -1));
+	const __m512i cnt41  = _mm512_broadcast_i32x4(_mm_setr_epi32(0, 0, 0, (int)~c0));
+	const __m512i cnt79  = _mm512_broadcast_i32x4(_mm_setr_epi32(0, 0, (int)c0, -1));
+	const __m512i cnt110 = _mm512_broadcast_i32x4(_mm_setr_epi32(0, (int)c0, 0, -1));
+	unsigned l, u, r;
+
+	for (l = 0; l < 4; l ++) {
+		memcpy(buf[l], in[l], len);
+		buf[l][len] = 0x80;
+		memset(buf[l] + len + 1, 0, 128 - len - 1);
+		sph_enc32le(buf[l] + 110, c0);
+		buf[l][126] = 0;
+		buf[l][127] = 2;
+	}
+	for (u = 0; u < 8; u ++) {
+		rk[u] = _mm512_inserti32x4(_mm512_castsi128_si512(
+			_mm_loadu_si128((const __m128i *)(buf[0] + 16 * u))),
+			_mm_loadu_si128((const __m128i *)(buf[1] + 16 * u)), 1);
+		rk[u] = _mm512_inserti32x4(rk[u], _mm_loadu_si128((const __m128i *)(buf[2] + 16 * u)), 2);
+		rk[u] = _mm512_inserti32x4(rk[u], _mm_loadu_si128((const __m128i *)(buf[3] + 16 * u)), 3);
+	}
+
+	/* 8 nonlinear key words follow every 8 linear ones (see c512) */
+	for (u = 8; u < 112; ) {
+		for (r = 0; r < 8; r ++, u ++) {
+			rk[u] = _mm512_xor_si512(_mm512_aesenc_epi128(
+				_mm512_shuffle_epi32(rk[u - 8], _MM_PERM_ADCB), zero), rk[u - 1]);
+			if (u == 8)
+				rk[u] = _mm512_xor_si512(rk[u], cnt8);
+			else if (u == 41)
+				rk[u] = _mm512_xor_si512(rk[u], cnt41);
+			else if (u == 79)
+				rk[u] = _mm512_xor_si512(rk[u], cnt79);
+			else if (u == 110)
+				rk[u] = _mm512_xor_si512(rk[u], cnt110);
+		}
+		for (r = 0; r < 8 && u < 112; r ++, u ++) {
+			/* dwords 1..3 of word u - 2 and dword 0 of word u - 1 */
+			const __m512i t = _mm512_shuffle_epi32(
+				_mm512_mask_blend_epi32(0x1111, rk[u - 2], rk[u - 1]), _MM_PERM_ADCB);
+			rk[u] = _mm512_xor_si512(rk[u - 8], t);
+		}
+	}
+
+	for (u = 0; u < 4; u ++) {
+		h[u] = _mm512_broadcast_i32x4(_mm_loadu_si128((const __m128i *)(IV512 + 4 * u)));
+		p[u] = h[u];
+	}
+	for (r = 0, u = 0; r < 14; r ++, u += 8) {
+		__m512i x, t;
+
+		x = _mm512_xor_si512(p[1], rk[u]);
+		x = _mm512_aesenc_epi128(x, rk[u + 1]);
+		x = _mm512_aesenc_epi128(x, rk[u + 2]);
+		x = _mm512_aesenc_epi128(x, rk[u + 3]);
+		p[0] = _mm512_xor_si512(p[0], _mm512_aesenc_epi128(x, zero));
+
+		x = _mm512_xor_si512(p[3], rk[u + 4]);
+		x = _mm512_aesenc_epi128(x, rk[u + 5]);
+		x = _mm512_aesenc_epi128(x, rk[u + 6]);
+		x = _mm512_aesenc_epi128(x, rk[u + 7]);
+		p[2] = _mm512_xor_si512(p[2], _mm512_aesenc_epi128(x, zero));
+
+		t = p[3];
+		p[3] = p[2];
+		p[2] = p[1];
+		p[1] = p[0];
+		p[0] = t;
+	}
+
+	for (u = 0; u < 4; u ++) {
+		const __m512i v = _mm512_xor_si512(h[u], p[u]);
+		_mm_storeu_si128((__m128i *)(out[0] + 16 * u), _mm512_extracti32x4_epi32(v, 0));
+		_mm_storeu_si128((__m128i *)(out[1] + 16 * u), _mm512_extracti32x4_epi32(v, 1));
+		_mm_storeu_si128((__m128i *)(out[2] + 16 * u), _mm512_extracti32x4_epi32(v, 2));
+		_mm_storeu_si128((__m128i *)(out[3] + 16 * u), _mm512_extracti32x4_epi32(v, 3));
+	}
+}
+
+#endif
+
+/* see sph_shavite.h */
+void
+sph_shavite512_multi(unsigned char *const *out, const unsigned char *const *in, size_t len, size_t n)
+{
+	size_t i = 0;
+#if defined(HAVE_VAES) && defined(HAVE_AVX512F)
+	/* 4 lane pass is faster than scalar code even for 1 message */
+	for (; len < 110 && i < n; i += 4) {
+		/* missing lanes repeat the last message and their hashes are dropped */
+		const unsigned char *lane_in[4];
+		unsigned char *lane_out[4], dummy[4][64];
+		size_t j;
+		for (j = 0; j < 4; ++j) {
+			lane_in[j]  = i + j < n ? in[i + j]  : in[n - 1];
+			lane_out[j] = i + j < n ? out[i + j] : dummy[j];
+		}
+		shavite512_x4(lane_out, lane_in, len);
+	}
+#endif
+	for (; i < n; ++i) {
+		sph_shavite512_context cc;
+		sph_shavite512_init(&cc);
+		sph_shavite512(&cc, in[i], len);
+		sph_shavite512_close(&cc, out[i]);
+	}
+}
+/* MOMINER PATCH END */
+
 #ifdef __cplusplus
 }
 #endif
\ No newline at end of file
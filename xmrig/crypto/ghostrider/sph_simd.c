@@ -1794,6 +1794,257 @@ sph_simd512_addbits_and_close(void *cc, unsigned ub, unsigned n, void *dst)
 	finalize_big(cc, ub, n, dst, 16);
 	sph_simd512_init(cc);
 }
+/* MOMINER PATCH BEGIN: multi-buffer simd512 of GhostRider lanes (8 messages of the same length per AVX2 pass). */
+#if defined(HAVE_AVX2)
+#include <immintrin.h>
+
+/* lane l of each 32-bit vector is for message l; operations mirror the FFT*, W_BIG and STEP_BIG macros */
+
+#define SIMD_X8_REDS1(x)   _mm256_sub_epi32(_mm256_and_si256((x), _mm256_set1_epi32(0xFF)), _mm256_srai_epi32((x), 8))
+#define SIMD_X8_REDS2(x)   _mm256_add_epi32(_mm256_and_si256((x), _mm256_set1_epi32(0xFFFF)), _mm256_srai_epi32((x), 16))
+#define SIMD_X8_ROL(x, n)  _mm256_or_si256(_mm256_slli_epi32((x), (n)), _mm256_srli_epi32((x), 32 - (n)))
+
+static void
+simd_x8_fft8(const __m256i *x, size_t xs, __m256i d[8])
+{
+	const __m256i x0 = x[0], x1 = x[xs], x2 = x[2 * xs], x3 = x[3 * xs];
+	const __m256i a0 = _mm256_add_epi32(x0, x2);
+	const __m256i a1 = _mm256_add_epi32(x0, _mm256_slli_epi32(x2, 4));
+	const __m256i a2 = _mm256_sub_epi32(x0, x2);
+	const __m256i a3 = _mm256_sub_epi32(x0, _mm256_slli_epi32(x2, 4));
+	const __m256i b0 = _mm256_add_epi32(x1, x3);
+	const __m256i b1 = SIMD_X8_REDS1(_mm256_add_epi32(_mm256_slli_epi32(x1, 2), _mm256_slli_epi32(x3, 6)));
+	const __m256i b2 = _mm256_sub_epi32(_mm256_slli_epi32(x1, 4), _mm256_slli_epi32(x3, 4));
+	const __m256i b3 = SIMD_X8_REDS1(_mm256_add_epi32(_mm256_slli_epi32(x1, 6), _mm256_slli_epi32(x3, 2)));
+
+	d[0] = _mm256_add_epi32(a0, b0);
+	d[1] = _mm256_add_epi32(a1, b1);
+	d[2] = _mm256_add_epi32(a2, b2);
+	d[3] = _mm256_add_epi32(a3, b3);
+	d[4] = _mm256_sub_epi32(a0, b0);
+	d[5] = _mm256_sub_epi32(a1, b1);
+	d[6] = _mm256_sub_epi32(a2, b2);
+	d[7] = _mm256_sub_epi32(a3, b3);
+}
+
+static void
+simd_x8_fft16(const __m256i *x, size_t xs, __m256i *q)
+{
+	__m256i d1[8], d2[8];
+	int k;
+
+	simd_x8_fft8(x, xs << 1, d1);
+	simd_x8_fft8(x + xs, xs << 1, d2);
+	for (k = 0; k < 8; k ++) {
+		const __m256i t = _mm256_sllv_epi32(d2[k], _mm256_set1_epi32(k));
+		q[k] = _mm256_add_epi32(d1[k], t);
+		q[k + 8] = _mm256_sub_epi32(d1[k], t);
+	}
+}
+
+static void
+simd_x8_fft_loop(__m256i *q, size_t hk, size_t as)
+{
+	size_t u;
+
+	for (u = 0; u < hk; u ++) {
+		const __m256i m = q[u], n = q[u + hk];
+		const __m256i t = u ? SIMD_X8_REDS2(_mm256_mullo_epi32(n, _mm256_set1_epi32(alpha_tab[u * as]))) : n;
+		q[u] = _mm256_add_epi32(m, t);
+		q[u + hk] = _mm256_sub_epi32(m, t);
+	}
+}
+
+static void
+simd_x8_fft32(const __m256i *x, size_t xs, __m256i *q)
+{
+	simd_x8_fft16(x, xs << 1, q);
+	simd_x8_fft16(x + xs, xs << 1, q + 16);
+	simd_x8_fft_loop(q, 16, 8);
+}
+
+static void
+simd_x8_fft64(const __m256i *x, size_t xs, __m256i *q)
+{
+	simd_x8_fft32(x, xs << 1, q);
+	simd_x8_fft32(x + xs, xs << 1, q + 32);
+	simd_x8_fft_loop(q, 32, 4);
+}
+
+static void
+simd_x8_transpose(__m256i r[8])
+{
+	__m256i t[8], u[8];
+	int i;
+
+	for (i = 0; i < 4; i ++) {
+		t[2 * i]     = _mm256_unpacklo_epi32(r[2 * i], r[2 * i + 1]);
+		t[2 * i + 1] = _mm256_unpackhi_epi32(r[2 * i], r[2 * i + 1]);
+	}
+	for (i = 0; i < 2; i ++) {
+		u[4 * i]     = _mm256_unpacklo_epi64(t[4 * i], t[4 * i + 2]);
+		u[4 * i + 1] = _mm256_unpackhi_epi64(t[4 * i], t[4 * i + 2]);
+		u[4 * i + 2] = _mm256_unpacklo_epi64(t[4 * i + 1], t[4 * i + 3]);
+		u[4 * i + 3] = _mm256_unpackhi_epi64(t[4 * i + 1], t[4 * i + 3]);
+	}
+	for (i = 0; i < 4; i ++) {
+		r[i]     = _mm256_permute2x128_si256(u[i], u[i + 4], 0x20);
+		r[i + 4] = _mm256_permute2x128_si256(u[i], u[i + 4], 0x31);
+	}
+}
+
+/* state words are A0..A7, B0..B7, C0..C7 and D0..D7 of compress_big */
+static void
+simd_x8_step(__m256i st[32], const __m256i w[8], int maj, int r, int s, const unsigned char pp[8])
+{
+	__m256i tA[8];
+	int n;
+
+	for (n = 0; n < 8; n ++)
+		tA[n] = SIMD_X8_ROL(st[n], r);
+	for (n = 0; n < 8; n ++) {
+		const __m256i a = st[n], b = st[8 + n], c = st[16 + n];
+		const __m256i f = maj
+			? _mm256_or_si256(_mm256_and_si256(a, b), _mm256_and_si256(_mm256_or_si256(a, b), c))
+			: _mm256_xor_si256(_mm256_and_si256(_mm256_xor_si256(b, c), a), c);
+		const __m256i tt = _mm256_add_epi32(_mm256_add_epi32(st[24 + n], w[n]), f);
+		st[n] = _mm256_add_epi32(SIMD_X8_ROL(tt, s), tA[pp[n]]);
+		st[24 + n] = c;
+		st[16 + n] = b;
+		st[8 + n] = tA[n];
+	}
+}
+
+/* buf holds the 128 byte block of each message */
+static void
+simd_x8_compress(__m256i st[32], const unsigned char buf[8][128], int last)
+{
+	static const unsigned char pp8[7][8] = {
+		{ 1, 0, 3, 2, 5, 4, 7, 6 }, { 6, 7, 4, 5, 2, 3, 0, 1 },
+		{ 2, 3, 0, 1, 6, 7, 4, 5 }, { 3, 2, 1, 0, 7, 6, 5, 4 },
+		{ 5, 4, 7, 6, 1, 0, 3, 2 }, { 7, 6, 5, 4, 3, 2, 1, 0 },
+		{ 4, 5, 6, 7, 0, 1, 2, 3 }
+	};
+	/* sb of WB_<round>_<step> and the round rotation counts */
+	static const unsigned char wb_sb[4][8] = {
+		{  4,  6,  0,  2,  7,  5,  3,  1 }, { 15, 11, 12,  8,  9, 13, 10, 14 },
+		{ 17, 18, 23, 20, 22, 21, 16, 19 }, { 30, 24, 25, 31, 27, 29, 28, 26 }
+	};
+	static const unsigned char rot[4][4] = {
+		{ 3, 23, 17, 27 }, { 28, 19, 22, 7 }, { 29, 9, 15, 5 }, { 4, 13, 10, 25 }
+	};
+	static const short wb_off[4][2] = { { 0, 1 }, { 0, 1 }, { -256, -128 }, { -383, -255 } };
+	static const short wb_mul[4] = { 185, 185, 233, 233 };
+	const unsigned short *yoff = last ? yoff_b_f : yoff_b_n;
+	const __m256i idx = _mm256_setr_epi32(0, 32, 64, 96, 128, 160, 192, 224);
+	__m256i x[128], q[256], saved[32];
+	int i, j, k;
+
+	for (i = 0; i < 32; i ++) {
+		const __m256i v = _mm256_i32gather_epi32((const int *)buf + i, idx, 4);
+		st[i] = _mm256_xor_si256((saved[i] = st[i]), v);
+		for (k = 0; k < 4; k ++)
+			x[4 * i + k] = _mm256_and_si256(_mm256_srli_epi32(v, 8 * k), _mm256_set1_epi32(0xFF));
+	}
+
+	simd_x8_fft64(x + 0, 4, q);
+	simd_x8_fft64(x + 2, 4, q + 64);
+	simd_x8_fft_loop(q, 64, 2);
+	simd_x8_fft64(x + 1, 4, q + 128);
+	simd_x8_fft64(x + 3, 4, q + 192);
+	simd_x8_fft_loop(q + 128, 64, 2);
+	simd_x8_fft_loop(q, 128, 1);
+	for (i = 0; i < 256; i ++) {
+		__m256i tq = _mm256_add_epi32(q[i], _mm256_set1_epi32(yoff[i]));
+		tq = SIMD_X8_REDS2(tq);
+		tq = SIMD_X8_REDS1(tq);
+		tq = SIMD_X8_REDS1(tq);
+		q[i] = _mm256_sub_epi32(tq, _mm256_and_si256(
+			_mm256_cmpgt_epi32(tq, _mm256_set1_epi32(128)), _mm256_set1_epi32(257)));
+	}
+
+	for (i = 0; i < 4; i ++) {
+		const __m256i mm = _mm256_set1_epi32(wb_mul[i]);
+		for (k = 0; k < 8; k ++) {
+			const __m256i *qq = q + 16 * wb_sb[i][k];
+			__m256i w[8];
+			for (j = 0; j < 8; j ++) {
+				w[j] = _mm256_add_epi32(
+					_mm256_and_si256(_mm256_mullo_epi32(qq[2 * j + wb_off[i][0]], mm), _mm256_set1_epi32(0xFFFF)),
+					_mm256_slli_epi32(_mm256_mullo_epi32(qq[2 * j + wb_off[i][1]], mm), 16));
+			}
+			simd_x8_step(st, w, k >= 4, rot[i][k & 3], rot[i][(k + 1) & 3], pp8[(k + i) % 7]);
+		}
+	}
+	simd_x8_step(st, saved +  0, 0,  4, 13, pp8[4]);
+	simd_x8_step(st, saved +  8, 0, 13, 10, pp8[5]);
+	simd_x8_step(st, saved + 16, 0, 10, 25, pp8[6]);
+	simd_x8_step(st, saved + 24, 0, 25,  4, pp8[0]);
+}
+
+#undef SIMD_X8_REDS1
+#undef SIMD_X8_REDS2
+#undef SIMD_X8_ROL
+
+static void
+simd512_x8(unsigned char *const *out, const unsigned char *const *in, size_t len)
+{
+	unsigned char buf[8][128];
+	__m256i st[32];
+	unsigned l, u;
+
+	for (u = 0; u < 32; u ++)
+		st[u] = _mm256_set1_epi32((int)IV512[u]);
+
+	/* message block is only zero padded, the bit count is in the last block */
+	for (l = 0; l < 8; l ++) {
+		memcpy(buf[l], in[l], len);
+		memset(buf[l] + len, 0, 128 - len);
+	}
+	simd_x8_compress(st, (const unsigned char (*)[128])buf, 0);
+	for (l = 0; l < 8; l ++) {
+		memset(buf[l], 0, 128);
+		sph_enc32le(buf[l], (u32)len << 3);
+	}
+	simd_x8_compress(st, (const unsigned char (*)[128])buf, 1);
+
+	simd_x8_transpose(st);
+	simd_x8_transpose(st + 8);
+	for (l = 0; l < 8; l ++) {
+		_mm256_storeu_si256((__m256i *)out[l], st[l]);
+		_mm256_storeu_si256((__m256i *)(out[l] + 32), st[8 + l]);
+	}
+}
+
+#endif
+
+/* see sph_simd.h */
+void
+sph_simd512_multi(unsigned char *const *out, const unsigned char *const *in, size_t len, size_t n)
+{
+	size_t i = 0;
+#if defined(HAVE_AVX2)
+	/* 8 lane pass is only faster than scalar code for 4+ messages */
+	for (; len > 0 && len <= 128 && i + 3 < n; i += 8) {
+		/* missing lanes repeat the last message and their hashes are dropped */
+		const unsigned char *lane_in[8];
+		unsigned char *lane_out[8], dummy[8][64];
+		size_t j;
+		for (j = 0; j < 8; ++j) {
+			lane_in[j]  = i + j < n ? in[i + j]  : in[n - 1];
+			lane_out[j] = i + j < n ? out[i + j] : dummy[j];
+		}
+		simd512_x8(lane_out, lane_in, len);
+	}
+#endif
+	for (; i < n; ++i) {
+		sph_simd512_context cc;
+		sph_simd512_init(&cc);
+		sph_simd512(&cc, in[i], len);
+		sph_simd512_close(&cc, out[i]);
+	}
+}
+/* MOMINER PATCH END */
 #ifdef __cplusplus
 }
 #endif
\ No newline at end of file
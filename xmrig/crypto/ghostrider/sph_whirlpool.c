@@ -3476,6 +3476,134 @@ MAKE_CLOSE(whirlpool)
 MAKE_CLOSE(whirlpool0)
 MAKE_CLOSE(whirlpool1)
 
+/* MOMINER PATCH BEGIN: multi-buffer whirlpool of GhostRider lanes (each 64 byte state is one AVX-512 vector and up to 8 of them are hashed together). */
+#if defined(HAVE_AVX512F) && defined(__AVX512BW__) && defined(__AVX512VBMI__)
+#include <immintrin.h>
+
+/* S-box (byte 0 of plain_T0) */
+static const unsigned char whirlpool_x8_sbox[256] = {
+	0x18, 0x23, 0xC6, 0xE8, 0x87, 0xB8, 0x01, 0x4F, 0x36, 0xA6, 0xD2, 0xF5, 0x79, 0x6F, 0x91, 0x52,
+	0x60, 0xBC, 0x9B, 0x8E, 0xA3, 0x0C, 0x7B, 0x35, 0x1D, 0xE0, 0xD7, 0xC2, 0x2E, 0x4B, 0xFE, 0x57,
+	0x15, 0x77, 0x37, 0xE5, 0x9F, 0xF0, 0x4A, 0xDA, 0x58, 0xC9, 0x29, 0x0A, 0xB1, 0xA0, 0x6B, 0x85,
+	0xBD, 0x5D, 0x10, 0xF4, 0xCB, 0x3E, 0x05, 0x67, 0xE4, 0x27, 0x41, 0x8B, 0xA7, 0x7D, 0x95, 0xD8,
+	0xFB, 0xEE, 0x7C, 0x66, 0xDD, 0x17, 0x47, 0x9E, 0xCA, 0x2D, 0xBF, 0x07, 0xAD, 0x5A, 0x83, 0x33,
+	0x63, 0x02, 0xAA, 0x71, 0xC8, 0x19, 0x49, 0xD9, 0xF2, 0xE3, 0x5B, 0x88, 0x9A, 0x26, 0x32, 0xB0,
+	0xE9, 0x0F, 0xD5, 0x80, 0xBE, 0xCD, 0x34, 0x48, 0xFF, 0x7A, 0x90, 0x5F, 0x20, 0x68, 0x1A, 0xAE,
+	0xB4, 0x54, 0x93, 0x22, 0x64, 0xF1, 0x73, 0x12, 0x40, 0x08, 0xC3, 0xEC, 0xDB, 0xA1, 0x8D, 0x3D,
+	0x97, 0x00, 0xCF, 0x2B, 0x76, 0x82, 0xD6, 0x1B, 0xB5, 0xAF, 0x6A, 0x50, 0x45, 0xF3, 0x30, 0xEF,
+	0x3F, 0x55, 0xA2, 0xEA, 0x65, 0xBA, 0x2F, 0xC0, 0xDE, 0x1C, 0xFD, 0x4D, 0x92, 0x75, 0x06, 0x8A,
+	0xB2, 0xE6, 0x0E, 0x1F, 0x62, 0xD4, 0xA8, 0x96, 0xF9, 0xC5, 0x25, 0x59, 0x84, 0x72, 0x39, 0x4C,
+	0x5E, 0x78, 0x38, 0x8C, 0xD1, 0xA5, 0xE2, 0x61, 0xB3, 0x21, 0x9C, 0x1E, 0x43, 0xC7, 0xFC, 0x04,
+	0x51, 0x99, 0x6D, 0x0D, 0xFA, 0xDF, 0x7E, 0x24, 0x3B, 0xAB, 0xCE, 0x11, 0x8F, 0x4E, 0xB7, 0xEB,
+	0x3C, 0x81, 0x94, 0xF7, 0xB9, 0x13, 0x2C, 0xD3, 0xE7, 0x6E, 0xC4, 0x03, 0x56, 0x44, 0x7F, 0xA9,
+	0x2A, 0xBB, 0xC1, 0x53, 0xDC, 0x0B, 0x9D, 0x6C, 0x31, 0x74, 0xF6, 0x46, 0xAC, 0x89, 0x14, 0xE1,
+	0x16, 0x3A, 0x69, 0x09, 0x70, 0xB6, 0xD0, 0xED, 0xCC, 0x42, 0x98, 0xA4, 0x28, 0x5C, 0xF8, 0x86
+};
+
+/* 2 * x in GF(2^8) (x^8 + x^4 + x^3 + x^2 + 1) of all bytes */
+static inline __m512i
+whirlpool_x8_xtime(__m512i x)
+{
+	return _mm512_xor_si512(_mm512_add_epi8(x, x),
+		_mm512_maskz_set1_epi8(_mm512_movepi8_mask(x), 0x1D));
+}
+
+/*
+ * One round on a state with row i in bytes 8 * i .. 8 * i + 7: S-box,
+ * column j shifted down by j rows and rows multiplied by the circulant
+ * (1, 1, 4, 1, 8, 5, 2, 9) matrix.
+ */
+static inline __m512i
+whirlpool_x8_round(__m512i x, const __m512i sbox[4], __m512i shift_columns)
+{
+	const __m512i lo = _mm512_permutex2var_epi8(sbox[0], x, sbox[1]);
+	const __m512i hi = _mm512_permutex2var_epi8(sbox[2], x, sbox[3]);
+	const __m512i a = _mm512_permutexvar_epi8(shift_columns,
+		_mm512_mask_blend_epi8(_mm512_movepi8_mask(x), lo, hi));
+	/* row rotated by m bytes is multiplied by coefficient m (Horner on coefficient bits) */
+	const __m512i r1 = _mm512_rol_epi64(a, 8), r2 = _mm512_rol_epi64(a, 16);
+	const __m512i r3 = _mm512_rol_epi64(a, 24), r4 = _mm512_rol_epi64(a, 32);
+	const __m512i r5 = _mm512_rol_epi64(a, 40), r6 = _mm512_rol_epi64(a, 48);
+	const __m512i r7 = _mm512_rol_epi64(a, 56);
+	__m512i t = _mm512_xor_si512(r4, r7);
+	t = _mm512_ternarylogic_epi64(whirlpool_x8_xtime(t), r2, r5, 0x96);
+	t = _mm512_xor_si512(whirlpool_x8_xtime(t), r6);
+	return _mm512_ternarylogic_epi64(whirlpool_x8_xtime(t),
+		_mm512_ternarylogic_epi64(a, r1, r3, 0x96),
+		_mm512_xor_si512(r5, r7), 0x96);
+}
+
+static void
+whirlpool_x8(unsigned char *const *out, const unsigned char *const *in, size_t len, size_t n)
+{
+	/* message, 0x80, zeros and 256-bit big endian bit count */
+	unsigned char buf[8][192];
+	const size_t blocks = (len + 33 + 63) >> 6;
+	__m512i sbox[4], h[8], m[8], k[8], s[8], shift_columns, rc[10];
+	size_t b, l;
+	unsigned i, r;
+
+	for (i = 0; i < 4; i ++)
+		sbox[i] = _mm512_loadu_si512((const void *)(whirlpool_x8_sbox + 64 * i));
+	{
+		unsigned char idx[64];
+		for (i = 0; i < 64; i ++)
+			idx[i] = (unsigned char)(8 * ((((i >> 3) - (i & 7))) & 7) + (i & 7));
+		shift_columns = _mm512_loadu_si512((const void *)idx);
+	}
+	for (r = 0; r < 10; r ++)
+		rc[r] = _mm512_maskz_loadu_epi8(0xFF, (const void *)(whirlpool_x8_sbox + 8 * r));
+
+	for (l = 0; l < n; l ++) {
+		memcpy(buf[l], in[l], len);
+		buf[l][len] = 0x80;
+		memset(buf[l] + len + 1, 0, (blocks << 6) - len - 9);
+		sph_enc64be(buf[l] + (blocks << 6) - 8, (sph_u64)len << 3);
+		h[l] = _mm512_setzero_si512();
+	}
+
+	for (b = 0; b < blocks; b ++) {
+		for (l = 0; l < n; l ++) {
+			m[l] = _mm512_loadu_si512((const void *)(buf[l] + (b << 6)));
+			k[l] = h[l];
+			s[l] = _mm512_xor_si512(m[l], k[l]);
+		}
+		for (r = 0; r < 10; r ++) {
+			for (l = 0; l < n; l ++) {
+				k[l] = _mm512_xor_si512(whirlpool_x8_round(k[l], sbox, shift_columns), rc[r]);
+				s[l] = _mm512_xor_si512(whirlpool_x8_round(s[l], sbox, shift_columns), k[l]);
+			}
+		}
+		for (l = 0; l < n; l ++)
+			h[l] = _mm512_ternarylogic_epi64(h[l], s[l], m[l], 0x96);
+	}
+
+	for (l = 0; l < n; l ++)
+		_mm512_storeu_si512((void *)out[l], h[l]);
+}
+
+#endif
+
+/* see sph_whirlpool.h */
+void
+sph_whirlpool_multi(unsigned char *const *out, const unsigned char *const *in, size_t len, size_t n)
+{
+	size_t i = 0;
+#if defined(HAVE_AVX512F) && defined(__AVX512BW__) && defined(__AVX512VBMI__)
+	if (len < 128) {
+		for (; i < n; i += 8)
+			whirlpool_x8(out + i, in + i, len, n - i < 8 ? n - i : 8);
+	}
+#endif
+	for (; i < n; ++i) {
+		sph_whirlpool_context cc;
+		sph_whirlpool_init(&cc);
+		sph_whirlpool(&cc, in[i], len);
+		sph_whirlpool_close(&cc, out[i]);
+	}
+}
+/* MOMINER PATCH END */
+
 #ifdef __cplusplus
 }
 #endif
@@ -217,6 +217,15 @@ void sph_whirlpool1_close(void *cc, void *dst);
 
 #endif
 
+/* MOMINER PATCH BEGIN: multi-buffer whirlpool of GhostRider lanes. */
+/**
+ * Compute WHIRLPOOL of <code>n</code> messages of <code>len</code> bytes
+ * each (1 to 8 messages). Output buffer i may be input buffer i.
+ */
+void sph_whirlpool_multi(unsigned char *const *out,
+	const unsigned char *const *in, size_t len, size_t n);
+/* MOMINER PATCH END */
+
 #ifdef __cplusplus
 }
 #endif
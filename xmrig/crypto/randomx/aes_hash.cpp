@@ -29,6 +29,9 @@ OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 #include <thread>
 #include <vector>
 #include <array>
+// MOMINER PATCH BEGIN: std::min for randomx_set_vaes_mode.
+#include <algorithm>
+// MOMINER PATCH END
 
 #include "crypto/randomx/aes_hash.hpp"
 #include "base/tools/Chrono.h"
@@ -282,9 +285,180 @@ template void fillAes4Rx4<true>(void *state, size_t outputSize, void *buffer);
 template void fillAes4Rx4<false>(void *state, size_t outputSize, void *buffer);
 
 #ifdef XMRIG_VAES
-void hashAndFillAes1Rx4_VAES512(void *scratchpad, size_t scratchpadSize, void *hash, void* fill_state);
+// MOMINER PATCH BEGIN: VAES versions of hard AES hashAndFillAes1Rx4 (upstream only declares the VAES-512 one).
+// AES lanes do not mix, so VAES-256 one keeps enc (0, 2) and dec (1, 3) states in separate registers and
+// VAES-512 one runs enc and dec over whole 64 byte lines and keeps only lanes of its own states.
+void hashAndFillAes1Rx4_VAES256(void *scratchpad, size_t scratchpadSize, void *hash, void* fill_state)
+{
+	PROFILE_SCOPE(RandomX_AES);
+
+	uint8_t* scratchpadPtr = (uint8_t*)scratchpad;
+	const uint8_t* scratchpadEnd = scratchpadPtr + scratchpadSize;
+
+	__m256i hash_enc = _mm256_set_m128i(rx_set_int_vec_i128(AES_HASH_1R_STATE2), rx_set_int_vec_i128(AES_HASH_1R_STATE0));
+	__m256i hash_dec = _mm256_set_m128i(rx_set_int_vec_i128(AES_HASH_1R_STATE3), rx_set_int_vec_i128(AES_HASH_1R_STATE1));
+
+	const __m256i key_dec = _mm256_set_m128i(rx_set_int_vec_i128(AES_GEN_1R_KEY2), rx_set_int_vec_i128(AES_GEN_1R_KEY0));
+	const __m256i key_enc = _mm256_set_m128i(rx_set_int_vec_i128(AES_GEN_1R_KEY3), rx_set_int_vec_i128(AES_GEN_1R_KEY1));
+
+	__m128i* fill = (__m128i*)fill_state;
+	__m256i fill_dec = _mm256_loadu2_m128i(fill + 2, fill + 0);
+	__m256i fill_enc = _mm256_loadu2_m128i(fill + 3, fill + 1);
+
+	constexpr int PREFETCH_DISTANCE = 7168;
+	const char* prefetchPtr = ((const char*)scratchpad) + PREFETCH_DISTANCE;
+	scratchpadEnd -= PREFETCH_DISTANCE;
+
+	for (int i = 0; i < 2; ++i) {
+		while (scratchpadPtr < scratchpadEnd) {
+#define HASH_FILL_VAES256(k) { \
+			__m128i* p = (__m128i*)scratchpadPtr + k * 4; \
+			hash_enc = _mm256_aesenc_epi128(hash_enc, _mm256_loadu2_m128i(p + 2, p + 0)); \
+			hash_dec = _mm256_aesdec_epi128(hash_dec, _mm256_loadu2_m128i(p + 3, p + 1)); \
+			fill_dec = _mm256_aesdec_epi128(fill_dec, key_dec); \
+			fill_enc = _mm256_aesenc_epi128(fill_enc, key_enc); \
+			_mm256_storeu2_m128i(p + 2, p + 0, fill_dec); \
+			_mm256_storeu2_m128i(p + 3, p + 1, fill_enc); \
+		}
+			HASH_FILL_VAES256(0);
+			HASH_FILL_VAES256(1);
+#undef HASH_FILL_VAES256
+
+			rx_prefetch_t0(prefetchPtr);
+			rx_prefetch_t0(prefetchPtr + 64);
+
+			scratchpadPtr += 128;
+			prefetchPtr += 128;
+		}
+		prefetchPtr = (const char*) scratchpad;
+		scratchpadEnd += PREFETCH_DISTANCE;
+	}
+
+	_mm256_storeu2_m128i(fill + 2, fill + 0, fill_dec);
+	_mm256_storeu2_m128i(fill + 3, fill + 1, fill_enc);
+
+	//two extra rounds to achieve full diffusion
+	const __m256i xkey0 = _mm256_broadcastsi128_si256(rx_set_int_vec_i128(AES_HASH_1R_XKEY0));
+	const __m256i xkey1 = _mm256_broadcastsi128_si256(rx_set_int_vec_i128(AES_HASH_1R_XKEY1));
+
+	hash_enc = _mm256_aesenc_epi128(hash_enc, xkey0);
+	hash_dec = _mm256_aesdec_epi128(hash_dec, xkey0);
+	hash_enc = _mm256_aesenc_epi128(hash_enc, xkey1);
+	hash_dec = _mm256_aesdec_epi128(hash_dec, xkey1);
+
+	//output hash
+	_mm256_storeu2_m128i((__m128i*)hash + 2, (__m128i*)hash + 0, hash_enc);
+	_mm256_storeu2_m128i((__m128i*)hash + 3, (__m128i*)hash + 1, hash_dec);
+
+	_mm256_zeroupper();
+}
+
+#if defined(__AVX512F__) || defined(_MSC_VER)
+#   define XMRIG_VAES512
+void hashAndFillAes1Rx4_VAES512(void *scratchpad, size_t scratchpadSize, void *hash, void* fill_state)
+{
+	PROFILE_SCOPE(RandomX_AES);
+
+	uint8_t* scratchpadPtr = (uint8_t*)scratchpad;
+	const uint8_t* scratchpadEnd = scratchpadPtr + scratchpadSize;
+
+	constexpr __mmask8 dec_lanes = 0xCC; // qwords of 128-bit lanes 1 and 3
+
+	// zero masked inserts and broadcasts with full masks compile to the same instructions as unmasked ones, but
+	// unmasked ones pass an undefined source operand that GCC reports as uninitialized
+	const __m512i hash_init = _mm512_maskz_inserti64x4(0xFF, _mm512_castsi256_si512(
+		_mm256_set_m128i(rx_set_int_vec_i128(AES_HASH_1R_STATE1), rx_set_int_vec_i128(AES_HASH_1R_STATE0))),
+		_mm256_set_m128i(rx_set_int_vec_i128(AES_HASH_1R_STATE3), rx_set_int_vec_i128(AES_HASH_1R_STATE2)), 1);
+	__m512i hash_enc = hash_init;
+	__m512i hash_dec = hash_init;
+
+	// fill states 0 and 2 are dec ones, 1 and 3 are enc ones
+	const __m512i key = _mm512_maskz_inserti64x4(0xFF, _mm512_castsi256_si512(
+		_mm256_set_m128i(rx_set_int_vec_i128(AES_GEN_1R_KEY1), rx_set_int_vec_i128(AES_GEN_1R_KEY0))),
+		_mm256_set_m128i(rx_set_int_vec_i128(AES_GEN_1R_KEY3), rx_set_int_vec_i128(AES_GEN_1R_KEY2)), 1);
+	__m512i fill_dec = _mm512_loadu_si512(fill_state);
+	__m512i fill_enc = fill_dec;
+
+	constexpr int PREFETCH_DISTANCE = 7168;
+	const char* prefetchPtr = ((const char*)scratchpad) + PREFETCH_DISTANCE;
+	scratchpadEnd -= PREFETCH_DISTANCE;
+
+	for (int i = 0; i < 2; ++i) {
+		while (scratchpadPtr < scratchpadEnd) {
+#define HASH_FILL_VAES512(k) { \
+			const __m512i data = _mm512_loadu_si512(scratchpadPtr + k * 64); \
+			hash_enc = _mm512_aesenc_epi128(hash_enc, data); \
+			hash_dec = _mm512_aesdec_epi128(hash_dec, data); \
+			fill_dec = _mm512_aesdec_epi128(fill_dec, key); \
+			fill_enc = _mm512_aesenc_epi128(fill_enc, key); \
+			_mm512_storeu_si512(scratchpadPtr + k * 64, _mm512_mask_blend_epi64(dec_lanes, fill_dec, fill_enc)); \
+		}
+			HASH_FILL_VAES512(0);
+			HASH_FILL_VAES512(1);
+#undef HASH_FILL_VAES512
+
+			rx_prefetch_t0(prefetchPtr);
+			rx_prefetch_t0(prefetchPtr + 64);
+
+			scratchpadPtr += 128;
+			prefetchPtr += 128;
+		}
+		prefetchPtr = (const char*) scratchpad;
+		scratchpadEnd += PREFETCH_DISTANCE;
+	}
+
+	_mm512_storeu_si512(fill_state, _mm512_mask_blend_epi64(dec_lanes, fill_dec, fill_enc));
+
+	//two extra rounds to achieve full diffusion
+	const __m512i xkey0 = _mm512_maskz_broadcast_i32x4(0xFFFF, rx_set_int_vec_i128(AES_HASH_1R_XKEY0));
+	const __m512i xkey1 = _mm512_maskz_broadcast_i32x4(0xFFFF, rx_set_int_vec_i128(AES_HASH_1R_XKEY1));
+
+	hash_enc = _mm512_aesenc_epi128(hash_enc, xkey0);
+	hash_dec = _mm512_aesdec_epi128(hash_dec, xkey0);
+	hash_enc = _mm512_aesenc_epi128(hash_enc, xkey1);
+	hash_dec = _mm512_aesdec_epi128(hash_dec, xkey1);
+
+	//output hash
+	_mm512_storeu_si512(hash, _mm512_mask_blend_epi64(dec_lanes, hash_enc, hash_dec));
+
+	_mm256_zeroupper();
+}
 #endif
 
+// widest VAES code CPU supports (0: none, 1: VAES-256, 2: VAES-512)
+static int getVaesSupport()
+{
+	const auto info = xmrig::Cpu::info();
+#	ifdef XMRIG_VAES512
+	return !info->hasVAES() ? 0 : info->has(xmrig::ICpuInfo::FLAG_AVX512F) ? 2 : 1;
+#	else
+	return info->hasVAES() ? 1 : 0;
+#	endif
+}
+
+// VAES code of hard AES hashAndFillAes1Rx4 (-1 until it is selected)
+static int vaesMode = -1;
+
+static int getVaesMode()
+{
+	// VAES-256 does no more AES rounds per cycle than four AES-NI streams, so only VAES-512 is picked by default
+	if (vaesMode < 0) {
+		vaesMode = getVaesSupport() == 2 ? 2 : 0;
+	}
+	return vaesMode;
+}
+// MOMINER PATCH END
+#endif
+
+// MOMINER PATCH BEGIN: VAES code of hard AES hashAndFillAes1Rx4 can be limited (or disabled) at runtime.
+void randomx_set_vaes_mode(int mode)
+{
+#ifdef XMRIG_VAES
+	vaesMode = mode < 0 ? -1 : std::min(mode, getVaesSupport());
+#endif
+}
+// MOMINER PATCH END
+
 template<int softAes, int unroll>
 void hashAndFillAes1Rx4(void *scratchpad, size_t scratchpadSize, void *hash, void* fill_state)
 {
@@ -303,10 +477,20 @@ void hashAndFillAes1Rx4(void *scratchpad, size_t scratchpadSize, void *hash, voi
 #endif
 
 #ifdef XMRIG_VAES
-	if (xmrig::Cpu::info()->arch() == xmrig::ICpuInfo::ARCH_ZEN5) {
-		hashAndFillAes1Rx4_VAES512(scratchpad, scratchpadSize, hash, fill_state);
-		return;
+	// MOMINER PATCH BEGIN: VAES code is selected by CPU flags (or randomx_set_vaes_mode), not only on Zen 5.
+	if (!softAes) {
+		switch (getVaesMode()) {
+#		ifdef XMRIG_VAES512
+		case 2:
+			hashAndFillAes1Rx4_VAES512(scratchpad, scratchpadSize, hash, fill_state);
+			return;
+#		endif
+		case 1:
+			hashAndFillAes1Rx4_VAES256(scratchpad, scratchpadSize, hash, fill_state);
+			return;
+		}
 	}
+	// MOMINER PATCH END
 #endif
 
 	uint8_t* scratchpadPtr = (uint8_t*)scratchpad;
@@ -43,6 +43,11 @@ OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 #include "crypto/randomx/virtual_memory.hpp"
 #include "crypto/randomx/soft_aes.h"
 #include "crypto/rx/Profiler.h"
+// MOMINER PATCH BEGIN: AVX-512 dataset init reads randomx_cache directly.
+#include "crypto/randomx/dataset.hpp"
+#include "crypto/randomx/blake2/endian.h"
+#include <algorithm>
+// MOMINER PATCH END
 
 #ifdef XMRIG_FIX_RYZEN
 #   include "crypto/rx/RxFix.h"
@@ -119,6 +124,7 @@ namespace randomx {
 	#define codeReadDataset ADDR(randomx_program_read_dataset)
 	#define codeReadDatasetV2 ADDR(randomx_program_read_dataset_v2)
 	#define codeReadDatasetLightSshInit ADDR(randomx_program_read_dataset_sshash_init)
+	#define codeReadDatasetLightSshInitV2 ADDR(randomx_program_read_dataset_sshash_init_v2)
 	#define codeReadDatasetLightSshFin ADDR(randomx_program_read_dataset_sshash_fin)
 	#define codeDatasetInit ADDR(randomx_dataset_init)
 	#define codeDatasetInitAVX2Prologue ADDR(randomx_dataset_init_avx2_prologue)
@@ -142,7 +148,8 @@ namespace randomx {
 	#define loopLoadXOPSize (codeProgramStart - codeLoopLoadXOP)
 	#define readDatasetSize (codeReadDatasetV2 - codeReadDataset)
 	#define readDatasetV2Size (codeReadDatasetLightSshInit - codeReadDatasetV2)
-	#define readDatasetLightInitSize (codeReadDatasetLightSshFin - codeReadDatasetLightSshInit)
+	#define readDatasetLightInitSize (codeReadDatasetLightSshInitV2 - codeReadDatasetLightSshInit)
+	#define readDatasetLightInitV2Size (codeReadDatasetLightSshFin - codeReadDatasetLightSshInitV2)
 	#define readDatasetLightFinSize (codeLoopStore - codeReadDatasetLightSshFin)
 	#define loopStoreSize (codeLoopStoreHardAES - codeLoopStore)
 	#define loopStoreHardAESSize (codeLoopStoreSoftAES - codeLoopStoreHardAES)
@@ -289,9 +296,15 @@ namespace randomx {
 			initDatasetAVX2 = false;
 		}
 
+		// MOMINER PATCH BEGIN: AVX-512 dataset init replaces AVX2 one where it is enabled, unless AVX2 one is forced by value 2.
+		initDatasetAVX512 = initDatasetAVX2 && optimizedDatasetInit != 2 && xmrig::Cpu::info()->has(xmrig::ICpuInfo::FLAG_AVX512F);
+		// MOMINER PATCH END
+
 		hasXOP = xmrig::Cpu::info()->hasXOP();
 
-		allocatedSize = initDatasetAVX2 ? (CodeSize * 4) : (CodeSize * 2);
+		// MOMINER PATCH BEGIN: AVX-512 superscalar functions are longer than AVX2 dataset init code.
+		allocatedSize = initDatasetAVX512 ? (CodeSize * 8) : initDatasetAVX2 ? (CodeSize * 4) : (CodeSize * 2);
+		// MOMINER PATCH END
 		allocatedCode = static_cast<uint8_t*>(allocExecutableMemory(allocatedSize,
 #			ifdef XMRIG_SECURE_JIT
 			false
@@ -363,7 +376,14 @@ namespace randomx {
 
 	void JitCompilerX86::generateProgramLight(Program& prog, ProgramConfiguration& pcfg, uint32_t datasetOffset) {
 		generateProgramPrologue(prog, pcfg);
-		emit(codeReadDatasetLightSshInit, readDatasetLightInitSize, code, codePos);
+		// MOMINER PATCH BEGIN: RandomX v2 modifies "ma" before the swap in light mode too (see generateProgram).
+		if (RandomX_CurrentConfig.Tweak_V2_PREFETCH) {
+			emit(codeReadDatasetLightSshInitV2, readDatasetLightInitV2Size, code, codePos);
+		}
+		else {
+			emit(codeReadDatasetLightSshInit, readDatasetLightInitSize, code, codePos);
+		}
+		// MOMINER PATCH END
 		*(uint32_t*)(code + codePos) = 0xc381;
 		codePos += 2;
 		emit32(datasetOffset / CacheLineSize, code, codePos);
@@ -376,6 +396,14 @@ namespace randomx {
 	template<size_t N>
 	void JitCompilerX86::generateSuperscalarHash(SuperscalarProgram(&programs)[N]) {
 		uint8_t* p = code;
+		// MOMINER PATCH BEGIN: AVX-512 dataset init falls back to AVX2 one if its code does not fit.
+		if (initDatasetAVX512) {
+			if (generateSuperscalarHashAVX512(programs, RandomX_CurrentConfig.CacheAccesses)) {
+				return;
+			}
+			initDatasetAVX512 = false;
+		}
+		// MOMINER PATCH END
 		if (initDatasetAVX2) {
 			codePos = 0;
 			emit(codeDatasetInitAVX2Prologue, datasetInitAVX2PrologueSize, code, codePos);
@@ -431,9 +459,239 @@ namespace randomx {
 	template
 	void JitCompilerX86::generateSuperscalarHash(SuperscalarProgram(&programs)[RANDOMX_CACHE_MAX_ACCESSES]);
 
+	// MOMINER PATCH BEGIN: AVX-512 dataset init (8 items per pass). Each superscalar program is jitted into a
+	// function that keeps r0-r7 of 8 items in zmm16-zmm23 (zmm24-zmm30 are temporaries, zmm31 is 0xFFFFFFFF
+	// mask), so no callee saved registers of any calling convention are used. Cache mixing and item stores are
+	// done by initDatasetAVX512Items.
+	namespace avx512 {
+		enum : uint32_t { MAP_0F = 1, MAP_0F38 = 2, PP_66 = 1, PP_F3 = 2 };
+		enum : uint32_t { R0 = 16, T0 = 24, T1, T2, T3, T4, T5, MASK32 = 31 };
+
+#		ifdef _WIN32
+		constexpr uint32_t argReg = 1; // rcx
+#		else
+		constexpr uint32_t argReg = 7; // rdi
+#		endif
+
+		// EVEX.512 instruction with register operands (reg and rm can be zmm0-zmm31, rm can also be a GPR)
+		static void emitRR(uint8_t* code, uint32_t& codePos, uint32_t map, uint32_t pp, uint32_t opcode, uint32_t reg, uint32_t vvvv, uint32_t rm) {
+			code[codePos++] = 0x62;
+			code[codePos++] = ((~reg & 8) << 4) | ((~rm & 16) << 2) | ((~rm & 8) << 2) | (~reg & 16) | map;
+			code[codePos++] = 0x80 | ((~vvvv & 15) << 3) | 4 | pp; // W1
+			code[codePos++] = 0x40 | ((~vvvv & 16) >> 1);
+			code[codePos++] = opcode;
+			code[codePos++] = 0xC0 | ((reg & 7) << 3) | (rm & 7);
+		}
+
+		// vpaddq, vpsubq, vpxorq, vpandq, vpmuludq: dst = a op b
+		static void op(uint8_t* code, uint32_t& codePos, uint32_t opcode, uint32_t dst, uint32_t a, uint32_t b) {
+			emitRR(code, codePos, MAP_0F, PP_66, opcode, dst, a, b);
+		}
+		enum : uint32_t { ADD = 0xD4, SUB = 0xFB, XOR = 0xEF, AND = 0xDB, MULU32 = 0xF4 };
+
+		// vpsllq (6), vpsrlq (2) with opcode 0x73, vpsraq (4), vprorq (0) with opcode 0x72: dst = src op imm
+		static void shift(uint8_t* code, uint32_t& codePos, uint32_t opcode, uint32_t ext, uint32_t dst, uint32_t src, uint32_t imm) {
+			emitRR(code, codePos, MAP_0F, PP_66, opcode, ext, dst, src);
+			code[codePos++] = imm;
+		}
+		static void shl(uint8_t* code, uint32_t& codePos, uint32_t dst, uint32_t src, uint32_t imm) { shift(code, codePos, 0x73, 6, dst, src, imm); }
+		static void shr(uint8_t* code, uint32_t& codePos, uint32_t dst, uint32_t src, uint32_t imm) { shift(code, codePos, 0x73, 2, dst, src, imm); }
+		static void sar(uint8_t* code, uint32_t& codePos, uint32_t dst, uint32_t src, uint32_t imm) { shift(code, codePos, 0x72, 4, dst, src, imm); }
+		static void ror(uint8_t* code, uint32_t& codePos, uint32_t dst, uint32_t src, uint32_t imm) { shift(code, codePos, 0x72, 0, dst, src, imm); }
+
+		// dst = broadcast of 64-bit imm (through rax)
+		static void broadcast(uint8_t* code, uint32_t& codePos, uint32_t dst, uint64_t imm) {
+			code[codePos++] = 0x48;
+			code[codePos++] = 0xB8;
+			memcpy(code + codePos, &imm, sizeof(imm));
+			codePos += sizeof(imm);
+			emitRR(code, codePos, MAP_0F38, PP_66, 0x7C, dst, 0, 0);
+		}
+
+		// vmovdqu64 zmm, [argReg + index * 64] (load) or vmovdqu64 [argReg + index * 64], zmm (store)
+		static void move(uint8_t* code, uint32_t& codePos, bool isStore, uint32_t reg, uint32_t index) {
+			code[codePos++] = 0x62;
+			code[codePos++] = ((~reg & 8) << 4) | 0x60 | (~reg & 16) | MAP_0F;
+			code[codePos++] = 0x80 | 0x78 | 4 | PP_F3;
+			code[codePos++] = 0x48;
+			code[codePos++] = isStore ? 0x7F : 0x6F;
+			code[codePos++] = (index ? 0x40 : 0x00) | ((reg & 7) << 3) | argReg;
+			if (index) {
+				code[codePos++] = index; // disp8 is scaled by 64
+			}
+		}
+
+		// dst *= src (low 64 bits from three 32x32 multiplications), src is not changed
+		static void mul(uint8_t* code, uint32_t& codePos, uint32_t dst, uint32_t src) {
+			shr(code, codePos, T0, dst, 32);
+			shr(code, codePos, T1, src, 32);
+			op(code, codePos, MULU32, T0, T0, src);
+			op(code, codePos, MULU32, T1, T1, dst);
+			op(code, codePos, ADD, T0, T0, T1);
+			shl(code, codePos, T0, T0, 32);
+			op(code, codePos, MULU32, dst, dst, src);
+			op(code, codePos, ADD, dst, dst, T0);
+		}
+
+		// dst = high 64 bits of dst * src (signed if isSigned), dst and src can be the same register
+		static void mulh(uint8_t* code, uint32_t& codePos, uint32_t dst, uint32_t src, bool isSigned) {
+			shr(code, codePos, T0, dst, 32);
+			shr(code, codePos, T1, src, 32);
+			op(code, codePos, MULU32, T2, dst, src); // lo * lo
+			op(code, codePos, MULU32, T3, dst, T1);  // lo * hi
+			op(code, codePos, MULU32, T4, T0, src);  // hi * lo
+			op(code, codePos, MULU32, T5, T0, T1);   // hi * hi
+			shr(code, codePos, T2, T2, 32);
+			op(code, codePos, ADD, T4, T4, T2);
+			op(code, codePos, AND, T2, T4, MASK32);
+			op(code, codePos, ADD, T2, T2, T3);
+			shr(code, codePos, T4, T4, 32);
+			shr(code, codePos, T2, T2, 32);
+			op(code, codePos, ADD, T5, T5, T4);
+			if (isSigned) {
+				op(code, codePos, ADD, T5, T5, T2);
+				sar(code, codePos, T0, dst, 63);
+				op(code, codePos, AND, T0, T0, src);
+				sar(code, codePos, T1, src, 63);
+				op(code, codePos, AND, T1, T1, dst);
+				op(code, codePos, SUB, T5, T5, T0);
+				op(code, codePos, SUB, dst, T5, T1);
+			}
+			else {
+				op(code, codePos, ADD, dst, T5, T2);
+			}
+		}
+
+		// longest code of one superscalar instruction (ISMULH_R)
+		constexpr uint32_t MaxInstructionSize = 22 * 7;
+	}
+
+	bool JitCompilerX86::generateSuperscalarHashAVX512(SuperscalarProgram* programs, size_t count) {
+		using namespace avx512;
+		const uint32_t codeLimit = static_cast<uint32_t>(allocatedCode + allocatedSize - code);
+		codePos = 0;
+		for (size_t j = 0; j < count; ++j) {
+			SuperscalarProgram& prog = programs[j];
+			if (codePos + 32 * 8 + prog.getSize() * MaxInstructionSize > codeLimit) {
+				return false;
+			}
+			superscalarFuncsAVX512[j] = reinterpret_cast<SuperscalarFuncAVX512*>(code + codePos);
+			for (uint32_t k = 0; k < 8; ++k) {
+				move(code, codePos, false, R0 + k, k);
+			}
+			broadcast(code, codePos, MASK32, 0xFFFFFFFFULL);
+			for (uint32_t i = 0, n = prog.getSize(); i < n; ++i) {
+				Instruction& instr = prog(i);
+				const uint32_t dst = R0 + instr.dst, src = R0 + instr.src;
+				switch ((SuperscalarInstructionType)instr.opcode)
+				{
+				case SuperscalarInstructionType::ISUB_R:
+					op(code, codePos, SUB, dst, dst, src);
+					break;
+				case SuperscalarInstructionType::IXOR_R:
+					op(code, codePos, XOR, dst, dst, src);
+					break;
+				case SuperscalarInstructionType::IADD_RS:
+					if (instr.getModShift()) {
+						shl(code, codePos, T0, src, instr.getModShift());
+						op(code, codePos, ADD, dst, dst, T0);
+					}
+					else {
+						op(code, codePos, ADD, dst, dst, src);
+					}
+					break;
+				case SuperscalarInstructionType::IMUL_R:
+					mul(code, codePos, dst, src);
+					break;
+				case SuperscalarInstructionType::IROR_C:
+					ror(code, codePos, dst, dst, instr.getImm32() & 63);
+					break;
+				case SuperscalarInstructionType::IADD_C7:
+				case SuperscalarInstructionType::IADD_C8:
+				case SuperscalarInstructionType::IADD_C9:
+					broadcast(code, codePos, T2, signExtend2sCompl(instr.getImm32()));
+					op(code, codePos, ADD, dst, dst, T2);
+					break;
+				case SuperscalarInstructionType::IXOR_C7:
+				case SuperscalarInstructionType::IXOR_C8:
+				case SuperscalarInstructionType::IXOR_C9:
+					broadcast(code, codePos, T2, signExtend2sCompl(instr.getImm32()));
+					op(code, codePos, XOR, dst, dst, T2);
+					break;
+				case SuperscalarInstructionType::IMULH_R:
+					mulh(code, codePos, dst, src, false);
+					break;
+				case SuperscalarInstructionType::ISMULH_R:
+					mulh(code, codePos, dst, src, true);
+					break;
+				case SuperscalarInstructionType::IMUL_RCP:
+					broadcast(code, codePos, T2, randomx_reciprocal_fast(instr.getImm32()));
+					mul(code, codePos, dst, T2);
+					break;
+				default:
+					UNREACHABLE;
+				}
+			}
+			for (uint32_t k = 0; k < 8; ++k) {
+				move(code, codePos, true, R0 + k, k);
+			}
+			static const uint8_t epilogue[] = { 0xC5, 0xF8, 0x77, 0xC3 }; // vzeroupper; ret
+			emit(epilogue, code, codePos);
+			codePos = (codePos + 63) & ~63u;
+		}
+		return true;
+	}
+
+	void JitCompilerX86::initDatasetAVX512Items(randomx_cache* cache, uint8_t* dataset, uint32_t startItem, uint32_t endItem) {
+		constexpr uint64_t superscalarMul0 = 6364136223846793005ULL;
+		static const uint64_t superscalarAdd[8] = {
+			0, 9298411001130361340ULL, 12065312585734608966ULL, 9306329213124626780ULL,
+			5281919268842080866ULL, 10536153434571861004ULL, 3398623926847679864ULL, 9549104520008361294ULL
+		};
+		const uint32_t mask = (RandomX_CurrentConfig.ArgonMemory * ArgonBlockSize) / CacheLineSize - 1;
+		const uint32_t accesses = RandomX_CurrentConfig.CacheAccesses;
+		SuperscalarFuncAVX512* const* funcs = cache->jit->superscalarFuncsAVX512;
+
+		alignas(64) uint64_t r[8][8]; // r[register][item]
+		uint64_t registerValue[8];
+		const uint8_t* mixBlock[8];
+		for (uint32_t itemNumber = startItem; itemNumber < endItem; itemNumber += 8) {
+			for (uint32_t i = 0; i < 8; ++i) {
+				const uint64_t r0 = (itemNumber + i + 1ULL) * superscalarMul0;
+				for (uint32_t k = 0; k < 8; ++k) {
+					r[k][i] = r0 ^ superscalarAdd[k];
+				}
+				registerValue[i] = itemNumber + i;
+			}
+			for (uint32_t j = 0; j < accesses; ++j) {
+				for (uint32_t i = 0; i < 8; ++i) {
+					mixBlock[i] = cache->memory + (registerValue[i] & mask) * CacheLineSize;
+					rx_prefetch_nta(mixBlock[i]);
+				}
+				funcs[j](r);
+				const uint32_t addressRegister = cache->programs[j].getAddressRegister();
+				for (uint32_t i = 0; i < 8; ++i) {
+					for (uint32_t k = 0; k < 8; ++k) {
+						r[k][i] ^= load64_native(mixBlock[i] + 8 * k);
+					}
+					registerValue[i] = r[addressRegister][i];
+				}
+			}
+			const uint32_t n = std::min(endItem - itemNumber, 8u);
+			for (uint32_t i = 0; i < n; ++i, dataset += CacheLineSize) {
+				for (uint32_t k = 0; k < 8; ++k) {
+					store64(dataset + 8 * k, r[k][i]);
+				}
+			}
+		}
+	}
+	// MOMINER PATCH END
+
 	void JitCompilerX86::generateDatasetInitCode() {
 		// AVX2 code is generated in generateSuperscalarHash()
-		if (!initDatasetAVX2) {
+		// MOMINER PATCH BEGIN: and AVX-512 one too.
+		if (!initDatasetAVX2 && !initDatasetAVX512) {
+		// MOMINER PATCH END
 			memcpy(code, codeDatasetInit, datasetInitSize);
 		}
 	}
@@ -71,9 +71,21 @@ namespace randomx {
 			enableExecution();
 #			endif
 
+			// MOMINER PATCH BEGIN: AVX-512 dataset init runs jitted superscalar programs from C++ code.
+			if (initDatasetAVX512) {
+				return &initDatasetAVX512Items;
+			}
+			// MOMINER PATCH END
+
 			return (DatasetInitFunc*)code;
 		}
 
+		// MOMINER PATCH BEGIN: name of the dataset init code this compiler generates.
+		const char* getDatasetInitName() const {
+			return initDatasetAVX512 ? "avx512" : initDatasetAVX2 ? "avx2" : "scalar";
+		}
+		// MOMINER PATCH END
+
 		uint8_t* getCode() {
 			return code;
 		}
@@ -102,6 +114,14 @@ namespace randomx {
 		bool hasAVX2;
 		bool initDatasetAVX2;
 		bool hasXOP;
+		// MOMINER PATCH BEGIN: AVX-512 dataset init computes 8 items per pass with one jitted function per superscalar program.
+		bool initDatasetAVX512 = false;
+		typedef void(SuperscalarFuncAVX512)(uint64_t (*registers)[8]);
+		SuperscalarFuncAVX512* superscalarFuncsAVX512[RANDOMX_CACHE_MAX_ACCESSES] = {};
+
+		bool generateSuperscalarHashAVX512(SuperscalarProgram* programs, size_t count);
+		static void initDatasetAVX512Items(randomx_cache* cache, uint8_t* dataset, uint32_t startItem, uint32_t endItem);
+		// MOMINER PATCH END
 
 		uint8_t* allocatedCode = nullptr;
 		size_t allocatedSize = 0;
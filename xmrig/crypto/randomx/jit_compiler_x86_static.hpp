@@ -42,6 +42,9 @@ extern "C" {
 	void randomx_program_read_dataset();
 	void randomx_program_read_dataset_v2();
 	void randomx_program_read_dataset_sshash_init();
+	// MOMINER PATCH BEGIN: light mode dataset read of RandomX v2.
+	void randomx_program_read_dataset_sshash_init_v2();
+	// MOMINER PATCH END
 	void randomx_program_read_dataset_sshash_fin();
 	void randomx_program_loop_store();
 	void randomx_program_loop_store_hard_aes();
@@ -46,14 +46,14 @@ OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 #include "backend/cpu/Cpu.h"
 #include "crypto/common/VirtualMemory.h"
 #include <mutex>
+// MOMINER PATCH BEGIN: std::max over vm class sizes for vm pool slots.
+#include <algorithm>
+// MOMINER PATCH END
 
 #include <cassert>
-// MOMINER PATCH BEGIN: rx/2 commitment hashing should size its temporary buffer from the actual input, not from XMRig stratum Job constants.
-#include <vector>
-// MOMINER PATCH END
 
 #include "crypto/rx/Profiler.h"
-// MOMINER PATCH BEGIN: mominer avoids the full XMRig stratum Job dependency; commitment hashing sizes its buffer from inputSize below instead of Job::kMaxBlobSize.
+// MOMINER PATCH BEGIN: mominer avoids the full XMRig stratum Job dependency; commitment hashing streams input and hash into blake2b below instead of using a Job::kMaxBlobSize buffer.
 // #include "base/net/stratum/Job.h"
 // MOMINER PATCH END
 
@@ -398,6 +398,50 @@ alignas(64) RandomX_ConfigurationBase RandomX_CurrentConfig;
 
 static std::mutex vm_pool_mutex;
 
+// MOMINER PATCH BEGIN: mominer recreates vms on every dataset/batch switch, so vm pool memory is split into fixed size slots that are reused after randomx_destroy_vm instead of wrapping around over live vms.
+namespace {
+	constexpr size_t VM_POOL_SIZE = 2 * 1024 * 1024;
+	constexpr size_t VM_SLOT_SIZE = (std::max({
+		sizeof(randomx::InterpretedLightVmDefault), sizeof(randomx::InterpretedVmDefault),
+		sizeof(randomx::CompiledLightVmDefault),    sizeof(randomx::CompiledVmDefault),
+		sizeof(randomx::InterpretedLightVmHardAes), sizeof(randomx::InterpretedVmHardAes),
+		sizeof(randomx::CompiledLightVmHardAes),    sizeof(randomx::CompiledVmHardAes)
+	}) + 63) & ~static_cast<size_t>(63);
+	static_assert(VM_SLOT_SIZE <= VM_POOL_SIZE, "RandomX VM does not fit into VM pool");
+
+	struct VmPool {
+		uint8_t* mem;
+		uint32_t node;
+		std::vector<bool> used;
+	};
+	std::vector<VmPool> vm_pools;
+
+	void* vm_pool_get(uint32_t node) {
+		for (auto& pool : vm_pools) {
+			if (pool.node != node) continue;
+			for (size_t i = 0; i != pool.used.size(); ++i) {
+				if (!pool.used[i]) { pool.used[i] = true; return pool.mem + i * VM_SLOT_SIZE; }
+			}
+		}
+		uint8_t* mem = (uint8_t*) xmrig::VirtualMemory::allocateLargePagesMemory(VM_POOL_SIZE);
+		if (!mem) mem = (uint8_t*) rx_aligned_alloc(VM_POOL_SIZE, 4096);
+		if (!mem) return nullptr;
+		vm_pools.push_back({ mem, node, std::vector<bool>(VM_POOL_SIZE / VM_SLOT_SIZE, false) });
+		vm_pools.back().used[0] = true;
+		return mem;
+	}
+
+	void vm_pool_release(void* p) {
+		for (auto& pool : vm_pools) {
+			if (p >= pool.mem && p < pool.mem + VM_POOL_SIZE) {
+				pool.used[(static_cast<uint8_t*>(p) - pool.mem) / VM_SLOT_SIZE] = false;
+				return;
+			}
+		}
+	}
+}
+// MOMINER PATCH END
+
 extern "C" {
 
 	randomx_cache *randomx_create_cache(randomx_flags flags, uint8_t *memory) {
@@ -474,6 +518,20 @@ extern "C" {
 		cache->datasetInit(cache, dataset->memory + startItem * randomx::CacheLineSize, startItem, startItem + itemCount);
 	}
 
+	// MOMINER PATCH BEGIN: dataset init path is reported in mominer rx_build stats.
+	const char* randomx_cache_dataset_init_name(randomx_cache* cache) {
+		assert(cache != nullptr);
+		if (cache->jit == nullptr) {
+			return "interpreter";
+		}
+#		if defined(_M_X64) || defined(__x86_64__)
+		return cache->jit->getDatasetInitName();
+#		else
+		return "scalar";
+#		endif
+	}
+	// MOMINER PATCH END
+
 	void *randomx_get_dataset_memory(randomx_dataset *dataset) {
 		assert(dataset != nullptr);
 		return dataset->memory;
@@ -492,66 +550,45 @@ extern "C" {
 
 		std::lock_guard<std::mutex> lock(vm_pool_mutex);
 
-		static uint8_t* vm_pool[64] = {};
-		static size_t vm_pool_offset[64] = {};
-
-		constexpr size_t VM_POOL_SIZE = 2 * 1024 * 1024;
-
-		if (node >= 64) {
-			node = 0;
-		}
-
-		if (!vm_pool[node]) {
-			vm_pool[node] = (uint8_t*) xmrig::VirtualMemory::allocateLargePagesMemory(VM_POOL_SIZE);
-			if (!vm_pool[node]) {
-				vm_pool[node] = (uint8_t*) rx_aligned_alloc(VM_POOL_SIZE, 4096);
-			}
+		// MOMINER PATCH BEGIN: vms take reusable slots of per node vm pools (see vm_pool_get above).
+		void* p = vm_pool_get(node);
+		if (!p) {
+			return nullptr;
 		}
-
-
-		void* p = vm_pool[node] + vm_pool_offset[node];
-		size_t vm_size = 0;
+		// MOMINER PATCH END
 
 		try {
 			switch (flags & (RANDOMX_FLAG_FULL_MEM | RANDOMX_FLAG_JIT | RANDOMX_FLAG_HARD_AES)) {
 				case RANDOMX_FLAG_DEFAULT:
 					vm = new(p) randomx::InterpretedLightVmDefault();
-					vm_size = sizeof(randomx::InterpretedLightVmDefault);
 					break;
 
 				case RANDOMX_FLAG_FULL_MEM:
 					vm = new(p) randomx::InterpretedVmDefault();
-					vm_size = sizeof(randomx::InterpretedVmDefault);
 					break;
 
 				case RANDOMX_FLAG_JIT:
 					vm = new(p) randomx::CompiledLightVmDefault();
-					vm_size = sizeof(randomx::CompiledLightVmDefault);
 					break;
 
 				case RANDOMX_FLAG_FULL_MEM | RANDOMX_FLAG_JIT:
 					vm = new(p) randomx::CompiledVmDefault();
-					vm_size = sizeof(randomx::CompiledVmDefault);
 					break;
 
 				case RANDOMX_FLAG_HARD_AES:
 					vm = new(p) randomx::InterpretedLightVmHardAes();
-					vm_size = sizeof(randomx::InterpretedLightVmHardAes);
 					break;
 
 				case RANDOMX_FLAG_FULL_MEM | RANDOMX_FLAG_HARD_AES:
 					vm = new(p) randomx::InterpretedVmHardAes();
-					vm_size = sizeof(randomx::InterpretedVmHardAes);
 					break;
 
 				case RANDOMX_FLAG_JIT | RANDOMX_FLAG_HARD_AES:
 					vm = new(p) randomx::CompiledLightVmHardAes();
-					vm_size = sizeof(randomx::CompiledLightVmHardAes);
 					break;
 
 				case RANDOMX_FLAG_FULL_MEM | RANDOMX_FLAG_JIT | RANDOMX_FLAG_HARD_AES:
 					vm = new(p) randomx::CompiledVmHardAes();
-					vm_size = sizeof(randomx::CompiledVmHardAes);
 					break;
 
 				default:
@@ -573,12 +610,11 @@ extern "C" {
 			vm = nullptr;
 		}
 
-		if (vm) {
-			vm_pool_offset[node] += vm_size;
-			if (vm_pool_offset[node] + 4096 > VM_POOL_SIZE) {
-				vm_pool_offset[node] = 0;
-			}
+		// MOMINER PATCH BEGIN: failed vm creation gives its slot back.
+		if (!vm) {
+			vm_pool_release(p);
 		}
+		// MOMINER PATCH END
 
 		return vm;
 	}
@@ -597,6 +633,10 @@ extern "C" {
 
 	void randomx_destroy_vm(randomx_vm* vm) {
 		vm->~randomx_vm();
+		// MOMINER PATCH BEGIN: destroyed vm slot can be reused by the next randomx_create_vm.
+		std::lock_guard<std::mutex> lock(vm_pool_mutex);
+		vm_pool_release(vm);
+		// MOMINER PATCH END
 	}
 
 	void randomx_calculate_hash(randomx_vm *machine, const void *input, size_t inputSize, void *output) {
@@ -635,12 +675,66 @@ extern "C" {
 		machine->hashAndFill(output, tempHash);
 	}
 
+	// MOMINER PATCH BEGIN: rx/2 commitment is absorbed into the vm commitment state along with the hash_first/next pipeline, so it needs no per hash buffers.
+	static FORCE_INLINE void commitment_begin(blake2b_state* state, const void* input, size_t inputSize) {
+		rx_blake2b_init(state, RANDOMX_HASH_SIZE);
+		rx_blake2b_update(state, input, inputSize);
+	}
+
+	static FORCE_INLINE void commitment_end(blake2b_state* state, const void* hash_in, void* com_out) {
+		rx_blake2b_update(state, hash_in, RANDOMX_HASH_SIZE);
+		rx_blake2b_final(state, com_out, RANDOMX_HASH_SIZE);
+	}
+
+	void randomx_calculate_hash_first_commitment(randomx_vm* machine, uint64_t (&tempHash)[8], const void* input, size_t inputSize) {
+		randomx_calculate_hash_first(machine, tempHash, input, inputSize);
+		commitment_begin(machine->getCommitmentState(), input, inputSize);
+	}
+
+	void randomx_calculate_hash_next_commitment(randomx_vm* machine, uint64_t (&tempHash)[8], const void* nextInput, size_t nextInputSize, void* output, void* com_out) {
+		randomx_calculate_hash_next(machine, tempHash, nextInput, nextInputSize, output);
+		blake2b_state* state = machine->getCommitmentState();
+		commitment_end(state, output, com_out);
+		commitment_begin(state, nextInput, nextInputSize);
+	}
+	// MOMINER PATCH END
+
+	// MOMINER PATCH BEGIN: one thread can drive two vms that alternate their programs so one vm dataset reads overlap with the other vm compute.
+	void randomx_calculate_hash_next_x2(randomx_vm* const machines[2], uint64_t (* const tempHashes[2])[8], const void* const nextInputs[2], size_t nextInputSize, void* const outputs[2], void* const com_outs[2]) {
+		PROFILE_SCOPE(RandomX_hash);
+
+#		ifdef __SSE2__
+		// rounding mode is carried in mxcsr between programs of the same hash so it is switched along with vms
+		uint32_t csr[2] = { rx_mxcsr_default, rx_mxcsr_default };
+		for (uint32_t chain = 0; chain < RandomX_CurrentConfig.ProgramCount; ++chain) {
+			for (int i = 0; i < 2; ++i) {
+				_mm_setcsr(csr[i]);
+				machines[i]->run(tempHashes[i]);
+				csr[i] = _mm_getcsr();
+				if (chain != RandomX_CurrentConfig.ProgramCount - 1)
+					rx_blake2b_wrapper::run(*tempHashes[i], sizeof(*tempHashes[i]), machines[i]->getRegisterFile(), sizeof(randomx::RegisterFile));
+			}
+		}
+		for (int i = 0; i < 2; ++i) {
+			rx_blake2b_wrapper::run(*tempHashes[i], sizeof(*tempHashes[i]), nextInputs[i], nextInputSize);
+			machines[i]->hashAndFill(outputs[i], *tempHashes[i]);
+		}
+#		else
+		for (int i = 0; i < 2; ++i) randomx_calculate_hash_next(machines[i], *tempHashes[i], nextInputs[i], nextInputSize, outputs[i]);
+#		endif
+		if (com_outs) for (int i = 0; i < 2; ++i) {
+			blake2b_state* state = machines[i]->getCommitmentState();
+			commitment_end(state, outputs[i], com_outs[i]);
+			commitment_begin(state, nextInputs[i], nextInputSize);
+		}
+	}
+	// MOMINER PATCH END
+
 	void randomx_calculate_commitment(const void* input, size_t inputSize, const void* hash_in, void* com_out) {
 		// MOMINER PATCH BEGIN: Avoid the full XMRig Job dependency and prevent fixed-size buffer assumptions in mominer's reduced build.
-		std::vector<uint8_t> buf(inputSize + RANDOMX_HASH_SIZE);
-		memcpy(buf.data(), input, inputSize);
-		memcpy(buf.data() + inputSize, hash_in, RANDOMX_HASH_SIZE);
-		rx_blake2b_wrapper::run(com_out, RANDOMX_HASH_SIZE, buf.data(), buf.size());
+		blake2b_state state;
+		commitment_begin(&state, input, inputSize);
+		commitment_end(&state, hash_in, com_out);
 		// MOMINER PATCH END
 	}
 
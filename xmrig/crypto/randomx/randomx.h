@@ -177,6 +177,9 @@ void randomx_apply_config(const T& config)
 void randomx_set_scratchpad_prefetch_mode(int mode);
 void randomx_set_huge_pages_jit(bool hugePages);
 void randomx_set_optimized_dataset_init(int value);
+// MOMINER PATCH BEGIN: VAES code of hard AES scratchpad hash/fill (-1: widest CPU supports, 0: none, 1: VAES-256, 2: VAES-512).
+void randomx_set_vaes_mode(int mode);
+// MOMINER PATCH END
 
 #if defined(__cplusplus)
 extern "C" {
@@ -336,6 +339,33 @@ RANDOMX_EXPORT void randomx_calculate_hash_next(randomx_vm* machine, uint64_t (&
 */
 RANDOMX_EXPORT void randomx_calculate_commitment(const void* input, size_t inputSize, const void* hash_in, void* com_out);
 
+// MOMINER PATCH BEGIN: allocation free rx/2 commitment fused into the hash_first/next pipeline.
+/**
+ * Same as randomx_calculate_hash_first that also starts the commitment of the input in the vm.
+*/
+RANDOMX_EXPORT void randomx_calculate_hash_first_commitment(randomx_vm* machine, uint64_t (&tempHash)[8], const void* input, size_t inputSize);
+
+/**
+ * Same as randomx_calculate_hash_next that also stores the commitment of the finished hash to com_out
+ * (RANDOMX_HASH_SIZE bytes) and starts the commitment of nextInput in the vm.
+*/
+RANDOMX_EXPORT void randomx_calculate_hash_next_commitment(randomx_vm* machine, uint64_t (&tempHash)[8], const void* nextInput, size_t nextInputSize, void* output, void* com_out);
+
+/**
+ * Same as randomx_calculate_hash_next for two vms with their own scratchpads that alternate their
+ * programs. If com_outs is not NULL it also does randomx_calculate_hash_next_commitment work.
+*/
+RANDOMX_EXPORT void randomx_calculate_hash_next_x2(randomx_vm* const machines[2], uint64_t (* const tempHashes[2])[8], const void* const nextInputs[2], size_t nextInputSize, void* const outputs[2], void* const com_outs[2]);
+// MOMINER PATCH END
+
+// MOMINER PATCH BEGIN: dataset init path is reported in mominer rx_build stats.
+/**
+ * Returns the name of the code randomx_init_dataset runs for the cache: "avx512", "avx2" or
+ * "scalar" for JIT caches (see randomx_set_optimized_dataset_init) and "interpreter" otherwise.
+*/
+RANDOMX_EXPORT const char* randomx_cache_dataset_init_name(randomx_cache* cache);
+// MOMINER PATCH END
+
 #if defined(__cplusplus)
 }
 #endif
@@ -31,6 +31,9 @@ OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 #include <cstdint>
 #include "crypto/randomx/common.hpp"
 #include "crypto/randomx/program.hpp"
+// MOMINER PATCH BEGIN: rx/2 commitment state is kept inside the vm.
+#include "crypto/randomx/blake2/blake2.h"
+// MOMINER PATCH END
 
 /* Global namespace for C binding */
 class randomx_vm
@@ -62,6 +65,12 @@ public:
 		return program;
 	}
 
+	// MOMINER PATCH BEGIN: rx/2 commitment of the hash being computed is absorbed into this preallocated state (see randomx_calculate_hash_next_commitment).
+	blake2b_state* getCommitmentState() {
+		return &commitmentState;
+	}
+	// MOMINER PATCH END
+
 protected:
 	void initialize();
 	alignas(64) randomx::Program program;
@@ -75,6 +84,9 @@ protected:
 	};
 	uint64_t datasetOffset;
 	uint32_t vm_flags;
+	// MOMINER PATCH BEGIN: rx/2 commitment state is kept inside the vm.
+	blake2b_state commitmentState;
+	// MOMINER PATCH END
 };
 
 namespace randomx {